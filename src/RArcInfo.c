@@ -11,6 +11,113 @@ int _AVCBinReadNextArcDir(AVCRawBinFile *psInfo, AVCTableDef *psArcDir);
 AVCBinFile *_AVCBinReadOpenTable(const char *pszInfoPath, const char *pszTableName);
 
 
+/*It closes the file of an external pointer made by file_pointer()*/
+static void close_file_pointer(SEXP ptr)
+{
+	AVCBinFile *file=(AVCBinFile *)R_ExternalPtrAddr(ptr);
+
+	if(file)
+		AVCBinReadClose(file);
+
+	R_ClearExternalPtr(ptr);
+}
+
+/*The same for a raw file*/
+static void close_raw_pointer(SEXP ptr)
+{
+	AVCRawBinFile *file=(AVCRawBinFile *)R_ExternalPtrAddr(ptr);
+
+	if(file)
+		AVCRawBinClose(file);
+
+	R_ClearExternalPtr(ptr);
+}
+
+/*The same for a coverage being converted to E00*/
+static void close_e00_pointer(SEXP ptr)
+{
+	AVCE00ReadPtr e00=(AVCE00ReadPtr)R_ExternalPtrAddr(ptr);
+
+	if(e00)
+		AVCE00ReadClose(e00);
+
+	R_ClearExternalPtr(ptr);
+}
+
+/*
+It returns an empty external pointer whose finalizer (one of the above)
+closes the file put in it with R_SetExternalPtrAddr(), so that the file is
+not left open when an error ends the call. This matters because an error
+can happen while a read-ahead thread still uses the file (see avc_rawbin.c).
+*/
+static SEXP file_pointer(R_CFinalizer_t close)
+{
+	SEXP ptr;
+
+	PROTECT(ptr=R_MakeExternalPtr(NULL, R_NilValue, R_NilValue));
+	R_RegisterCFinalizerEx(ptr, close, TRUE);
+	UNPROTECT(1);
+
+	return ptr;
+}
+
+/*
+It opens a file in the coverage directory. directory can also be a coverage
+handle (see open_coverage()), and then the file is taken from the handle
+and coverage is ignored. Otherwise the file is put in fileptr (see
+file_pointer()), that closes it.
+*/
+static AVCBinFile *open_coverage_file(SEXP directory, SEXP coverage, 
+	SEXP filename, AVCFileType type, SEXP fileptr)
+{
+	char pathtofile[PATH];
+	AVCBinFile *file;
+
+	if(is_coverage_handle(directory))
+		file=coverage_file(directory, CHAR(STRING_ELT(filename,0)), type);
+	else
+	{
+		check_path(CHAR(STRING_ELT(directory,0)), 
+			CHAR(STRING_ELT(coverage,0)));
+		strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
+
+		complete_path(pathtofile, (char *)CHAR(STRING_ELT(coverage,0)), 1);
+
+		file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), type);
+		R_SetExternalPtrAddr(fileptr, file);
+	}
+
+	if(!file)
+		error("Error opening file");
+
+	return file;
+}
+
+/*It opens an INFO table. infodir can also be a coverage handle, and
+otherwise the file is put in fileptr. It returns NULL if the table cannot be
+opened*/
+static AVCBinFile *open_table_file(SEXP infodir, SEXP tablename, SEXP fileptr)
+{
+	char pathtoinfodir[PATH];
+	AVCBinFile *file;
+
+	if(is_coverage_handle(infodir))
+		return coverage_file(infodir, CHAR(STRING_ELT(tablename,0)),
+			AVCFileTABLE);
+
+	check_path(CHAR(STRING_ELT(infodir,0)), "");
+	strcpy(pathtoinfodir, CHAR(STRING_ELT(infodir,0)));
+	complete_path(pathtoinfodir, "", 1);
+
+	file=AVCBinReadOpen(pathtoinfodir, CHAR(STRING_ELT(tablename,0)),
+		AVCFileTABLE);
+	R_SetExternalPtrAddr(fileptr, file);
+
+	return file;
+}
+
+
+
 /*
 It returns the table names and something more:
 - Arc file
@@ -21,22 +128,31 @@ It returns the table names and something more:
 */
 SEXP get_table_names(SEXP directory)
 {
-	SEXP *table, aux;
+	SEXP *table, aux, fileptr;
 	AVCRawBinFile *arcfile;
 	AVCTableDef tabledefaux;
 	char arcdir[PATH], *dirname;
 	int i,n, **idata;
 
-	dirname= (char *) CHAR(STRING_ELT(directory,0));/*FIXME*/
+	if(is_coverage_handle(directory))
+		dirname=(char *)coverage_info_path(directory);
+	else
+		dirname= (char *) CHAR(STRING_ELT(directory,0));/*FIXME*/
+
+	check_path(dirname, "arc.dir");
 	strcpy(arcdir,dirname);
 
 	complete_path(arcdir,"arc.dir", 0);
 
+	PROTECT(fileptr=file_pointer(close_raw_pointer));
+
 	if(!(arcfile=AVCRawBinOpen(arcdir,"r")))
 	{
 		error("Error opening arc.dir");
 	}
 
+	R_SetExternalPtrAddr(fileptr, arcfile);
+
 	n=0;
 	while(!AVCRawBinEOF(arcfile))
 	{
@@ -83,12 +199,14 @@ SEXP get_table_names(SEXP directory)
 		i++;
 	}
 
+	close_raw_pointer(fileptr);
+
 	PROTECT(aux=NEW_LIST(6));
 
 	for(i=0;i<6;i++)
 		SET_VECTOR_ELT(aux,i,table[i]);
 
-	UNPROTECT(7);
+	UNPROTECT(8);
 
 	free(table);
 	free(idata);
@@ -101,16 +219,14 @@ SEXP get_table_names(SEXP directory)
 SEXP get_table_fields(SEXP info_dir, SEXP table_name)
 {
 	int i, *idata;
-	char infodir[PATH];
-	SEXP *table, aux;
+	SEXP *table, aux, fileptr;
 	AVCBinFile *tablefile;
 	AVCTableDef *tabledef;
 	AVCFieldInfo *fields;
 
-	strcpy(infodir,CHAR(STRING_ELT(info_dir,0)));
-	complete_path(infodir,"",1);
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
-tablefile=_AVCBinReadOpenTable( infodir, CHAR(STRING_ELT(table_name,0)) );
+	tablefile=open_table_file(info_dir, table_name, fileptr);
 
 	if(!tablefile)
 		error("The path to the info directory is invalid or the table doesn't exist");
@@ -131,107 +247,477 @@ tablefile=_AVCBinReadOpenTable( infodir, CHAR(STRING_ELT(table_name,0)) );
 		idata[i]=fields[i].nType1;
 	}
 
+	close_file_pointer(fileptr);
+
 	PROTECT(aux=NEW_LIST(2));
 	SET_VECTOR_ELT(aux,0,table[0]);
 	SET_VECTOR_ELT(aux,1,table[1]);
 
-	UNPROTECT(3);
+	UNPROTECT(4);
 
 	free(table);
 
 	return aux;
 }
 
-/*It imports the data from an arc file*/
-SEXP get_arc_data(SEXP directory, SEXP coverage, SEXP filename) 
+/*Number of records allocated when their number is not known in advance*/
+#define INIT_NREC 1024
+
+/*Columns where the records read from a file are stored*/
+typedef struct
 {
-	int i,j,n, **ptable;
-	double *x,*y;
-	char pathtofile[PATH];
-	AVCArc *reg;
-	AVCBinFile *file;
-	SEXP *table, points, aux;
+	int ncol;
+	int len;	/*Length of the columns*/
+	int used;	/*Elements in use (only kept for the geometry columns)*/
+	SEXP *table;
+	PROTECT_INDEX *ipx;
+	void **pdata;	/*Data of the integer and numeric columns*/
+	AVCBinFile *file;	/*File being read*/
+	void *info;	/*Anything else needed to store the records*/
+} rec_store;
+
+/*It sets the pointers to the data of the columns, which change when they are resized*/
+static void set_store_pointers(rec_store *st)
+{
+	int i;
 
+	for(i=0;i<st->ncol;i++)
+	{
+		if(TYPEOF(st->table[i])==INTSXP)
+			st->pdata[i]=INTEGER(st->table[i]);
+		else if(TYPEOF(st->table[i])==REALSXP)
+			st->pdata[i]=REAL(st->table[i]);
+		else
+			st->pdata[i]=NULL;
+	}
+}
 
-	strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
+/*It allocates (and protects) ncol columns of length n*/
+static void alloc_store(rec_store *st, int ncol, const SEXPTYPE *types, int n)
+{
+	int i;
 
-	complete_path(pathtofile, (char *)CHAR(STRING_ELT(coverage,0)), 1);
+	st->ncol=ncol;
+	st->len=n;
+	st->used=0;
+	/*R_alloc(): the memory is released even if an error ends the call*/
+	st->table=(SEXP *)R_alloc(ncol, sizeof(SEXP));
+	st->ipx=(PROTECT_INDEX *)R_alloc(ncol, sizeof(PROTECT_INDEX));
+	st->pdata=(void **)R_alloc(ncol, sizeof(void *));
 
-	if(!(file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), AVCFileARC)))
-		error("Error opening file");
+	for(i=0;i<ncol;i++)
+		PROTECT_WITH_INDEX(st->table[i]=allocVector(types[i],n), &st->ipx[i]);
 
-	n=0;
+	set_store_pointers(st);
+}
+
+/*It changes the length of the columns, keeping their contents*/
+static void resize_store(rec_store *st, int n)
+{
+	int i;
+
+	for(i=0;i<st->ncol;i++)
+		REPROTECT(st->table[i]=lengthgets(st->table[i], n), st->ipx[i]);
+
+	st->len=n;
+	set_store_pointers(st);
+}
+
+/*It makes sure that n more elements can be appended to the columns*/
+static void reserve_store(rec_store *st, int n)
+{
+	if(st->used+n>st->len)
+		resize_store(st, MAX(2*st->len, st->used+n));
+}
+
+/*It returns a list with the columns and unprotects them*/
+static SEXP store_to_list(rec_store *st)
+{
+	int i, ncol=st->ncol;
+	SEXP aux;
+
+	PROTECT(aux=NEW_LIST(ncol));
+
+	for(i=0;i<ncol;i++)
+		SET_VECTOR_ELT(aux, i, st->table[i]);
+
+	UNPROTECT(ncol+1);
+
+	return aux;
+}
 
-	while(AVCBinReadNextArc(file)){n++;}
+/*
+It imports the records of an (already opened) file in a single pass and
+closes the file in fileptr (see open_coverage_file()). store() is called to
+store each record.
+
+If ids is not NULL only those records are read, using the index file.
+Otherwise all the records are read, and the number of records is taken from
+the index, the file size or the table header (see AVCBinReadNumObjects()).
+When it is not known the columns grow as needed.
 
-	Rprintf("Number of ARCS:%d\n",n);
+It returns a list with the columns.
+*/
+static SEXP read_records(AVCBinFile *file, SEXP fileptr, SEXP ids,
+	int ncol, const SEXPTYPE *types, AVCBinReadObjectHandler store, void *info)
+{
+	int i,n;
+	void *reg;
+	rec_store st;
 
+	if(ids!=R_NilValue)
+		n=LENGTH(ids);
+	else if((n=AVCBinReadNumObjects(file))<0)
+		n=INIT_NREC;
 
-	table=calloc(7,sizeof(SEXP));
-	ptable=(int **)calloc(7, sizeof(int *));
-	for(i=0;i<7;i++)
+	st.file=file;
+	st.info=info;
+	alloc_store(&st, ncol, types, n);
+
+	if(ids!=R_NilValue)
 	{
-		PROTECT(table[i]=NEW_INTEGER(n));
-		ptable[i]=(int *)INTEGER(table[i]);
+		if(AVCBinReadObjects(file, n, INTEGER(ids), store, &st)!=n)
+		{
+			close_file_pointer(fileptr);
+			error("Error while reading register");
+		}
 	}
+	else
+	{
+		for(i=0;(reg=AVCBinReadNextObject(file));i++)
+		{
+			if(i==n)
+				resize_store(&st, n=MAX(2*n, INIT_NREC));
 
+			store(reg, i, &st);
+		}
 
-	PROTECT(points=NEW_LIST(n));
+		if(i!=n)
+			resize_store(&st, n=i);
+	}
 
-	if(AVCBinReadRewind(file))
-		error("Rewind");
+	close_file_pointer(fileptr);
 
+	return store_to_list(&st);
+}
+
+/*
+It imports the next chunk (at most nmax records) of an (already opened)
+file, as read_records() does. The file is not closed, so that the next
+chunk can be read later. It returns a list with the columns, of length 0
+if the end of the file was reached before.
+*/
+static SEXP read_chunk(AVCBinFile *file, int nmax, int ncol, 
+	const SEXPTYPE *types, AVCBinReadObjectHandler store, void *info)
+{
+	int i;
+	void *reg;
+	rec_store st;
+
+	st.file=file;
+	st.info=info;
+	alloc_store(&st, ncol, types, nmax);
+
+	for(i=0;i<nmax && (reg=AVCBinReadNextObject(file));i++)
+		store(reg, i, &st);
+
+	if(i!=nmax)
+		resize_store(&st, i);
+
+	return store_to_list(&st);
+}
+
+
+/*
+Compressed (CSR) layout of the geometry: instead of a list for each record,
+the elements of all the records are appended to the columns in geom and
+the last column of data keeps where the elements of each record start.
+The number of elements of each record is in column icount.
+
+It replaces the last column of data by a list with the columns in geom plus
+the offsets (starting at 0) of the records, so that the elements of the
+i-th record are those from offsets[i]+1 to offsets[i+1]. The columns are
+rearranged if the records were not read in the same order they are stored
+(which happens when they are read through the index file).
+
+Both data and the columns in geom must be protected, and geom is released.
+*/
+static SEXP make_csr(SEXP data, int icount, rec_store *geom)
+{
+	int i, j, n, sorted, *start, *count, *offsets;
+	size_t size;
+	char *pcol;
+	SEXP aux, col;
+
+	i=LENGTH(data)-1;
+	n=LENGTH(VECTOR_ELT(data, i));
+	start=INTEGER(VECTOR_ELT(data, i));
+	count=INTEGER(VECTOR_ELT(data, icount));
+
+	resize_store(geom, geom->used);
+
+	PROTECT(aux=NEW_LIST(geom->ncol+1));
+	SET_VECTOR_ELT(aux, geom->ncol, NEW_INTEGER(n+1));
+	offsets=INTEGER(VECTOR_ELT(aux, geom->ncol));
+
+	offsets[0]=0;
+	sorted=1;
 	for(i=0;i<n;i++)
 	{
-		
-		if(!(reg=(AVCArc*)AVCBinReadNextArc(file)))
-			error("Error while reading register");
+		offsets[i+1]=offsets[i]+count[i];
+		if(start[i]!=offsets[i])
+			sorted=0;
+	}
+
+	for(j=0;j<geom->ncol;j++)
+	{
+		if(sorted)
+		{
+			SET_VECTOR_ELT(aux, j, geom->table[j]);
+			continue;
+		}
+
+		col=allocVector(TYPEOF(geom->table[j]), offsets[n]);
+		SET_VECTOR_ELT(aux, j, col);
+
+		if(TYPEOF(col)==REALSXP)
+		{
+			size=sizeof(double);
+			pcol=(char *)REAL(col);
+		}
+		else
+		{
+			size=sizeof(int);
+			pcol=(char *)INTEGER(col);
+		}
+
+		for(i=0;i<n;i++)
+		{
+			memcpy(pcol+size*offsets[i],
+				(char *)geom->pdata[j]+size*start[i],
+				size*count[i]);
+		}
+	}
+
+	SET_VECTOR_ELT(data, LENGTH(data)-1, aux);
+
+	UNPROTECT(1);
 
+	return data;
+}
+
+/*
+It imports all the records of an (already opened) arc or pal file straight
+into the CSR layout (see make_csr()), with nthreads threads (see 
+AVCBinReadObjectColumns()), and closes the file as read_records() does. 
+The first ncol-1 columns have the given types and the geometry has ngeom
+columns. It returns R_NilValue, with the file rewound and still open, if 
+the records cannot be decoded this way, so that they are read one by one.
+*/
+static SEXP read_columns(AVCBinFile *file, SEXP fileptr, int ncol,
+	const SEXPTYPE *types, int ngeom, const SEXPTYPE *geomtypes, int nthreads)
+{
+	int i, n, nelem;
+	void **dest;
+	AVCBinObjectPositions *pos;
+	SEXP aux, geom, col;
+
+	if(!(pos=AVCBinReadObjectPositions(file)))
+		return R_NilValue;
+
+	n=pos->numObjects;
+	nelem=pos->panStart[n];
+	dest=(void **)R_alloc(ncol-1+ngeom, sizeof(void *));
+
+	PROTECT(aux=NEW_LIST(ncol));
+	PROTECT(geom=NEW_LIST(ngeom+1));
+
+	for(i=0;i<ncol-1+ngeom;i++)
+	{
+		if(i<ncol-1)
+			SET_VECTOR_ELT(aux, i, col=allocVector(types[i], n));
+		else
+			SET_VECTOR_ELT(geom, i-ncol+1, 
+				col=allocVector(geomtypes[i-ncol+1], nelem));
+
+		if(TYPEOF(col)==INTSXP)
+			dest[i]=INTEGER(col);
+		else
+			dest[i]=REAL(col);
+	}
+
+	SET_VECTOR_ELT(geom, ngeom, NEW_INTEGER(n+1));
+	memcpy(INTEGER(VECTOR_ELT(geom, ngeom)), pos->panStart, 
+		(n+1)*sizeof(int));
+	SET_VECTOR_ELT(aux, ncol-1, geom);
+
+	i=AVCBinReadObjectColumns(file, pos, dest, nthreads);
+	AVCBinFreeObjectPositions(pos);
+
+	UNPROTECT(2);
 
-		ptable[0][i]=reg->nArcId;
+	if(i!=n)
+	{
+		AVCBinReadRewind(file);
+		return R_NilValue;
+	}
+
+	close_file_pointer(fileptr);
+
+	return aux;
+}
+
+/*Position in the file of the last n bytes read*/
+static GIntBig last_read_position(AVCBinFile *file, int n)
+{
+	return file->psRawBinFile->nOffset+file->psRawBinFile->nCurPos-n;
+}
 
-		ptable[1][i]=reg->nUserId;
+/*It stores the fields of the i-th arc, but not its vertices*/
+static void store_arc_fields(AVCArc *reg, int i, rec_store *st)
+{
+	((int *)st->pdata[0])[i]=reg->nArcId;
+
+	((int *)st->pdata[1])[i]=reg->nUserId;
+
+	((int *)st->pdata[2])[i]=reg->nFNode;
+
+	((int *)st->pdata[3])[i]=reg->nTNode;
+
+	((int *)st->pdata[4])[i]=reg->nLPoly;
 
-		ptable[2][i]=reg->nFNode;
+	((int *)st->pdata[5])[i]=reg->nRPoly;
+
+	((int *)st->pdata[6])[i]=reg->numVertices;
+}
+
+/*It stores the i-th arc. The vertices are appended to the store in st->info 
+if the CSR layout is used*/
+static void store_arc(void *obj, int i, void *data)
+{
+	int j;
+	double *x,*y;
+	AVCArc *reg=(AVCArc *)obj;
+	rec_store *st=(rec_store *)data;
+	rec_store *geom=(rec_store *)st->info;
+	SEXP aux;
 
-		ptable[3][i]=reg->nTNode;
+	store_arc_fields(reg, i, st);
 
-		ptable[4][i]=reg->nLPoly;
+	if(geom)
+	{
+		reserve_store(geom, reg->numVertices);
 
-		ptable[5][i]=reg->nRPoly;
+		((int *)st->pdata[7])[i]=geom->used;
 
-		ptable[6][i]=reg->numVertices;
+		x=(double *)geom->pdata[0]+geom->used;
+		y=(double *)geom->pdata[1]+geom->used;
 
-		SET_VECTOR_ELT(points,i,NEW_LIST(2));
+		geom->used+=reg->numVertices;
+	}
+	else
+	{
+		SET_VECTOR_ELT(st->table[7],i,NEW_LIST(2));
 
-		aux=VECTOR_ELT(points,i);
+		aux=VECTOR_ELT(st->table[7],i);
 
 		SET_VECTOR_ELT(aux,0,NEW_NUMERIC(reg->numVertices));
 		SET_VECTOR_ELT(aux,1,NEW_NUMERIC(reg->numVertices));
 
 		x=REAL(VECTOR_ELT(aux,0));
 		y=REAL(VECTOR_ELT(aux,1));
+	}
 
-		for(j=0;j<reg->numVertices;j++)
-		{
-			x[j]=reg->pasVertices[j].x;
-			y[j]=reg->pasVertices[j].y;
-		}
-
+	for(j=0;j<reg->numVertices;j++)
+	{
+		x[j]=reg->pasVertices[j].x;
+		y[j]=reg->pasVertices[j].y;
 	}
+}
+
+/*It stores the i-th arc, but only where its vertices are in the file 
+(see lazy_geometry()). They are the last thing read*/
+static void store_arc_lazy(void *obj, int i, void *data)
+{
+	AVCArc *reg=(AVCArc *)obj;
+	rec_store *st=(rec_store *)data;
+	int vsize=(st->file->nPrecision==AVC_DOUBLE_PREC?16:8);
+
+	store_arc_fields(reg, i, st);
+
+	((double *)st->pdata[7])[i]=(double)last_read_position(st->file, 
+		reg->numVertices*vsize);
+}
+
+/*Columns of the arcs, in the default and the CSR layouts (where the last
+column is where the vertices of each arc start), and of their vertices*/
+static const SEXPTYPE arc_types[8]={INTSXP, INTSXP, INTSXP, INTSXP, 
+	INTSXP, INTSXP, INTSXP, VECSXP};
+static const SEXPTYPE arc_csrtypes[8]={INTSXP, INTSXP, INTSXP, INTSXP, 
+	INTSXP, INTSXP, INTSXP, INTSXP};
+static const SEXPTYPE arc_geomtypes[2]={REALSXP, REALSXP};
+
+/*In the lazy CSR layout the last column is where the vertices of each arc
+are in the file, which may be past 2 GB*/
+static const SEXPTYPE arc_lazytypes[8]={INTSXP, INTSXP, INTSXP, INTSXP, 
+	INTSXP, INTSXP, INTSXP, REALSXP};
+
+/*It imports the data from an arc file. If ids is not NULL only those
+arcs are read, using the index file (arx.adf). If csr is TRUE the vertices
+are returned in the CSR layout (see make_csr()), and if lazy is TRUE too
+they are only read when they are used. All the arcs in the CSR layout are
+decoded by threads threads (see read_columns())*/
+SEXP get_arc_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids,
+	SEXP csr, SEXP lazy, SEXP threads) 
+{
+	AVCBinFile *file;
+	rec_store geom;
+	SEXP aux, fileptr;
+#ifdef HAVE_ALTREP
+	char *fname;
+	int size;
+#endif
 
-	PROTECT(aux=NEW_LIST(8));
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
-	for(i=0;i<7;i++)
+	file=open_coverage_file(directory, coverage, filename, AVCFileARC,
+		fileptr);
+
+#ifdef HAVE_ALTREP
+	if(LOGICAL(csr)[0] && LOGICAL(lazy)[0] && lazy_available())
 	{
-		SET_VECTOR_ELT(aux,i,table[i]);
+		fname=strcpy(R_alloc(strlen(file->pszFilename)+1, 1),
+			file->pszFilename);
+		size=(file->nPrecision==AVC_DOUBLE_PREC?8:4);
+
+		PROTECT(aux=read_records(file, fileptr, ids, 8, arc_lazytypes,
+			store_arc_lazy, NULL));
+		SET_VECTOR_ELT(aux, 7, lazy_geometry(fname, 
+			LENGTH(VECTOR_ELT(aux,0)), INTEGER(VECTOR_ELT(aux,6)),
+			REAL(VECTOR_ELT(aux,7)), 2, AVC_FT_BINFLOAT, size));
+		UNPROTECT(1);
 	}
+	else
+#endif
+	if(LOGICAL(csr)[0])
+	{
+		if(ids!=R_NilValue || (aux=read_columns(file, fileptr, 8, 
+			arc_csrtypes, 2, arc_geomtypes, INTEGER(threads)[0]))==R_NilValue)
+		{
+			alloc_store(&geom, 2, arc_geomtypes, INIT_NREC);
+			PROTECT(aux=read_records(file, fileptr, ids, 8, 
+				arc_csrtypes, store_arc, &geom));
+			aux=make_csr(aux, 6, &geom);
+			UNPROTECT(3);
+		}
+	}
+	else
+		aux=read_records(file, fileptr, ids, 8, arc_types, store_arc, NULL);
 
-	SET_VECTOR_ELT(aux,7,points);
+	Rprintf("Number of ARCS:%d\n", LENGTH(VECTOR_ELT(aux,0)));
 
-	UNPROTECT(9);
+	UNPROTECT(1);
 
-	free(table);
 	return aux;
 }
 
@@ -241,10 +727,12 @@ SEXP get_bnd_data(SEXP info_dir, SEXP tablename)
 	double *d;
 	AVCBinFile *tablefile;
 	AVCField *datafield;
-	SEXP data;
+	SEXP data, fileptr;
+
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
-if(!(tablefile=_AVCBinReadOpenTable( CHAR(STRING_ELT(info_dir,0)), CHAR(STRING_ELT(tablename,0)) )) )
-	error("Couldn't open table");
+	if(!(tablefile=open_table_file(info_dir, tablename, fileptr)))
+		error("Couldn't open table");
 
 	tablefile->eFileType=AVCFileTABLE;
 
@@ -268,540 +756,1010 @@ if(!(tablefile=_AVCBinReadOpenTable( CHAR(STRING_ELT(info_dir,0)), CHAR(STRING_E
 			d[i]=datafield[i].dDouble;
 	}
 
-	UNPROTECT(1);
+	close_file_pointer(fileptr);
+
+	UNPROTECT(2);
 
 	return data;
 }
 
 
 
-SEXP get_pal_data(SEXP directory, SEXP coverage, SEXP filename) 
+/*It stores the fields of the i-th polygon, but not its arcs*/
+static void store_pal_fields(AVCPal *reg, int i, rec_store *st)
+{
+	((int *)st->pdata[0])[i]=reg->nPolyId;
+
+	((double *)st->pdata[1])[i]=reg->sMin.x;
+	((double *)st->pdata[2])[i]=reg->sMin.y;
+
+	((double *)st->pdata[3])[i]=reg->sMax.x;
+	((double *)st->pdata[4])[i]=reg->sMax.y;
+
+	((int *)st->pdata[5])[i]=reg->numArcs;
+}
+
+/*It stores the i-th polygon. The arcs are appended to the store in st->info
+if the CSR layout is used*/
+static void store_pal(void *obj, int i, void *data)
+{
+	int j;
+	int *idata[3];
+	AVCPal *reg=(AVCPal *)obj;
+	rec_store *st=(rec_store *)data;
+	rec_store *geom=(rec_store *)st->info;
+	SEXP aux;
+
+	store_pal_fields(reg, i, st);
+
+	if(geom)
+	{
+		reserve_store(geom, reg->numArcs);
+
+		((int *)st->pdata[6])[i]=geom->used;
+
+		for(j=0;j<3;j++)
+			idata[j]=(int *)geom->pdata[j]+geom->used;
+
+		geom->used+=reg->numArcs;
+	}
+	else
+	{
+		SET_VECTOR_ELT(st->table[6],i,NEW_LIST(3));
+		aux=VECTOR_ELT(st->table[6],i);
+
+		SET_VECTOR_ELT(aux,0,NEW_INTEGER(reg->numArcs));
+		idata[0]=INTEGER(VECTOR_ELT(aux,0));
+		SET_VECTOR_ELT(aux,1,NEW_INTEGER(reg->numArcs));
+		idata[1]=INTEGER(VECTOR_ELT(aux,1));
+		SET_VECTOR_ELT(aux,2,NEW_INTEGER(reg->numArcs));
+		idata[2]=INTEGER(VECTOR_ELT(aux,2));
+	}
+
+	for(j=0;j<reg->numArcs;j++)
+	{
+		idata[0][j]=reg->pasArcs[j].nArcId;
+		idata[1][j]=reg->pasArcs[j].nFNode;
+		idata[2][j]=reg->pasArcs[j].nAdjPoly;
+	}
+}
+
+/*It stores the i-th polygon, but only where its arcs are in the file
+(see lazy_geometry()). They are the last thing read*/
+static void store_pal_lazy(void *obj, int i, void *data)
+{
+	AVCPal *reg=(AVCPal *)obj;
+	rec_store *st=(rec_store *)data;
+
+	store_pal_fields(reg, i, st);
+
+	((double *)st->pdata[6])[i]=(double)last_read_position(st->file, 
+		reg->numArcs*3*4);
+}
+
+/*Columns of the polygons, in the default and the CSR layouts (where the last
+column is where the arcs of each polygon start), and of their arcs*/
+static const SEXPTYPE pal_types[7]={INTSXP, /*Polygon ID*/
+	REALSXP, REALSXP, /*Min X. and Y. coordinates*/
+	REALSXP, REALSXP, /*Max X. and Y. coordinates*/
+	INTSXP, /*Number of arcs*/
+	VECSXP};
+static const SEXPTYPE pal_csrtypes[7]={INTSXP, REALSXP, REALSXP, REALSXP,
+	REALSXP, INTSXP, INTSXP};
+static const SEXPTYPE pal_geomtypes[3]={INTSXP, INTSXP, INTSXP};
+static const SEXPTYPE pal_lazytypes[7]={INTSXP, REALSXP, REALSXP, REALSXP,
+	REALSXP, INTSXP, REALSXP};
+
+/*It imports the data from a pal file. If ids is not NULL only those
+polygons are read, using the index file (pax.adf). If csr is TRUE the arcs 
+are returned in the CSR layout (see make_csr()), and if lazy is TRUE too
+they are only read when they are used. All the polygons in the CSR layout
+are decoded by threads threads (see read_columns())*/
+SEXP get_pal_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids,
+	SEXP csr, SEXP lazy, SEXP threads) 
 {
-	int i,j,n;
-	int **idata;
-	char pathtofile[PATH];
-	void **ptable;
-	AVCPal *reg;
 	AVCBinFile *file;
-	SEXP *table, points, aux;
+	rec_store geom;
+	SEXP aux, fileptr;
+#ifdef HAVE_ALTREP
+	char *fname;
+#endif
 
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
-	strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
+	file=open_coverage_file(directory, coverage, filename, AVCFilePAL,
+		fileptr);
 
+#ifdef HAVE_ALTREP
+	if(LOGICAL(csr)[0] && LOGICAL(lazy)[0] && lazy_available())
+	{
+		fname=strcpy(R_alloc(strlen(file->pszFilename)+1, 1),
+			file->pszFilename);
+
+		/*The last column is where the arcs of each polygon are in the file*/
+		PROTECT(aux=read_records(file, fileptr, ids, 7, pal_lazytypes,
+			store_pal_lazy, NULL));
+		SET_VECTOR_ELT(aux, 6, lazy_geometry(fname, 
+			LENGTH(VECTOR_ELT(aux,0)), INTEGER(VECTOR_ELT(aux,5)),
+			REAL(VECTOR_ELT(aux,6)), 3, AVC_FT_BININT, 4));
+		UNPROTECT(1);
+	}
+	else
+#endif
+	if(LOGICAL(csr)[0])
+	{
+		if(ids!=R_NilValue || (aux=read_columns(file, fileptr, 7, 
+			pal_csrtypes, 3, pal_geomtypes, INTEGER(threads)[0]))==R_NilValue)
+		{
+			alloc_store(&geom, 3, pal_geomtypes, INIT_NREC);
+			PROTECT(aux=read_records(file, fileptr, ids, 7, 
+				pal_csrtypes, store_pal, &geom));
+			aux=make_csr(aux, 5, &geom);
+			UNPROTECT(4);
+		}
+	}
+	else
+		aux=read_records(file, fileptr, ids, 7, pal_types, store_pal, NULL);
 
-	complete_path(pathtofile, (char *) CHAR(STRING_ELT(coverage,0)), 1);
+	Rprintf("Number of POLYGONS:%d\n", LENGTH(VECTOR_ELT(aux,0)));
 
+	UNPROTECT(1);
 
-	if(!(file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), AVCFilePAL)))
-		error("Error opening file");
+	return aux;
+}
 
-	n=0;
 
-	while(AVCBinReadNextPal(file)){n++;}
 
-	Rprintf("Number of POLYGONS:%d\n",n);
+/*It stores the i-th label*/
+static void store_lab(void *obj, int i, void *data)
+{
+	AVCLab *reg=(AVCLab *)obj;
+	rec_store *st=(rec_store *)data;
+
+	((int *)st->pdata[0])[i]=reg->nValue;
+	((int *)st->pdata[1])[i]=reg->nPolyId;
+
+	((double*)st->pdata[2])[i]=reg->sCoord1.x;
+	((double*)st->pdata[3])[i]=reg->sCoord1.y;
+	((double*)st->pdata[4])[i]=reg->sCoord2.x;
+	((double*)st->pdata[5])[i]=reg->sCoord2.y;
+	((double*)st->pdata[6])[i]=reg->sCoord3.x;
+	((double*)st->pdata[7])[i]=reg->sCoord3.y;
+}
 
-	idata=calloc(3,sizeof(int *));
+static const SEXPTYPE lab_types[8]={INTSXP, INTSXP, REALSXP, REALSXP,
+	REALSXP, REALSXP, REALSXP, REALSXP};
 
-        table=calloc(6,sizeof(SEXP));
-        ptable=(void **)calloc(6, sizeof(void *));
+SEXP get_lab_data(SEXP directory, SEXP coverage, SEXP filename) 
+{
+	AVCBinFile *file;
+	SEXP aux, fileptr;
 
-        PROTECT(table[0]=NEW_INTEGER(n));  /*Polygon ID*/
-        ptable[0]=(int *)INTEGER(table[0]);
-        PROTECT(table[1]=NEW_NUMERIC(n));  /*Min X. coordinate*/
-        ptable[1]=(double *)REAL(table[1]);
-        PROTECT(table[2]=NEW_NUMERIC(n));  /*Min Y. coordinate*/
-        ptable[2]=(double *)REAL(table[2]);
-        PROTECT(table[3]=NEW_NUMERIC(n));  /*Max X. coordinate*/
-        ptable[3]=(double *)REAL(table[3]);
-        PROTECT(table[4]=NEW_NUMERIC(n));  /*Max Y. coordinate*/
-        ptable[4]=(double *)REAL(table[4]);
-        PROTECT(table[5]=NEW_INTEGER(n));  /*Number of arcs*/
-        ptable[5]=(int *)INTEGER(table[5]);
- 
- 
-        PROTECT(points=NEW_LIST(n));  
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
+	file=open_coverage_file(directory, coverage, filename, AVCFileLAB,
+		fileptr);
 
-	if(AVCBinReadRewind(file))
-		error("Rewind");
+	aux=read_records(file, fileptr, R_NilValue, 8, lab_types, store_lab, NULL);
 
-	for(i=0;i<n;i++)
+	Rprintf("Number of LABELS:%d\n", LENGTH(VECTOR_ELT(aux,0)));
+
+	UNPROTECT(1);
+
+	return aux;
+}
+
+
+/*It stores the i-th centroid*/
+static void store_cnt(void *obj, int i, void *data)
+{
+	int j, *ilabel;
+	AVCCnt *reg=(AVCCnt *)obj;
+	rec_store *st=(rec_store *)data;
+
+	((int *)st->pdata[0])[i]=reg->nPolyId;
+
+	((double *)st->pdata[1])[i]=reg->sCoord.x;
+	((double *)st->pdata[2])[i]=reg->sCoord.y;
+
+	((int *)st->pdata[3])[i]=reg->numLabels;
+
+	SET_VECTOR_ELT(st->table[4],i,NEW_INTEGER(reg->numLabels));
+	ilabel=INTEGER(VECTOR_ELT(st->table[4],i));
+	if(reg->numLabels >0)
 	{
-		
-		if(!(reg=(AVCPal*)AVCBinReadNextPal(file)))
-			error("Error while reading register");
+		for(j=0;j<reg->numLabels;j++)
+		{
+			ilabel[j]=reg->panLabelIds[j];
+		}
+	}
+}
+
+static const SEXPTYPE cnt_types[5]={INTSXP, REALSXP, REALSXP, INTSXP, 
+	VECSXP};
+
+/*It imports the data from a cnt file. If ids is not NULL only those
+centroids are read, using the index file (cnx.adf)*/
+SEXP get_cnt_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids) 
+{
+	AVCBinFile *file;
+	SEXP aux, fileptr;
+
+	PROTECT(fileptr=file_pointer(close_file_pointer));
+
+	file=open_coverage_file(directory, coverage, filename, AVCFileCNT,
+		fileptr);
+
+	aux=read_records(file, fileptr, ids, 5, cnt_types, store_cnt, NULL);
 
+	Rprintf("Number of CENTROIDS:%d\n", LENGTH(VECTOR_ELT(aux,0)));
 
-		((int *)ptable[0])[i]=reg->nPolyId;
+	UNPROTECT(1);
 
-		((double *)ptable[1])[i]=reg->sMin.x;
-		((double *)ptable[2])[i]=reg->sMin.y;
+	return aux;
+}
 
-		((double *)ptable[3])[i]=reg->sMax.x;
-		((double *)ptable[4])[i]=reg->sMax.y;
 
-		((int *)ptable[5])[i]=reg->numArcs;
 
+/*It stores the i-th tolerance*/
+static void store_tol(void *obj, int i, void *data)
+{
+	AVCTol *reg=(AVCTol *)obj;
+	rec_store *st=(rec_store *)data;
 
-		SET_VECTOR_ELT(points,i,NEW_LIST(3));
-		aux=VECTOR_ELT(points,i);
+	((int *)st->pdata[0])[i]=reg->nIndex;
 
-		SET_VECTOR_ELT(aux,0,NEW_INTEGER(reg->numArcs));
-		idata[0]=INTEGER(VECTOR_ELT(aux,0));
-		SET_VECTOR_ELT(aux,1,NEW_INTEGER(reg->numArcs));
-		idata[1]=INTEGER(VECTOR_ELT(aux,1));
-		SET_VECTOR_ELT(aux,2,NEW_INTEGER(reg->numArcs));
-		idata[2]=INTEGER(VECTOR_ELT(aux,2));
+	((int *)st->pdata[1])[i]=reg->nFlag;
 
-		for(j=0;j<reg->numArcs;j++)
-		{
-			idata[0][j]=reg->pasArcs[j].nArcId;
-			idata[1][j]=reg->pasArcs[j].nFNode;
-			idata[2][j]=reg->pasArcs[j].nAdjPoly;
-		}
+	((double *)st->pdata[2])[i]=reg->dValue;
+}
 
-	}
+static const SEXPTYPE tol_types[3]={INTSXP, INTSXP, REALSXP};
+
+SEXP get_tol_data(SEXP directory, SEXP coverage, SEXP filename) 
+{
+	AVCBinFile *file;
+	SEXP aux, fileptr;
 
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
-        PROTECT(aux=NEW_LIST(7));
- 
-        for(i=0;i<6;i++)
-        {
-                SET_VECTOR_ELT(aux,i,table[i]);
-        }
- 
-        SET_VECTOR_ELT(aux,6,points);
- 
-        UNPROTECT(8);  
+	file=open_coverage_file(directory, coverage, filename, AVCFileTOL,
+		fileptr);
 
+	aux=read_records(file, fileptr, R_NilValue, 3, tol_types, store_tol, NULL);
 
-	free(ptable);
-	free(idata);
+	Rprintf("Number of TOLERANCES:%d\n", LENGTH(VECTOR_ELT(aux,0)));
+
+	UNPROTECT(1);
 
 	return aux;
 }
 
 
 
-SEXP get_lab_data(SEXP directory, SEXP coverage, SEXP filename) 
+/*It stores the i-th annotation*/
+static void store_txt(void *obj, int i, void *data)
 {
-	int i,n;
-	void **pdata;
-	char pathtofile[PATH];
-	AVCLab *reg;
-	AVCBinFile *file;
-	SEXP *table,aux;
+	int j;
+	double *x, *y;
+	AVCTxt *reg=(AVCTxt *)obj;
+	rec_store *st=(rec_store *)data;
+	SEXP aux;
 
+	((int *)st->pdata[0])[i]=reg->nTxtId;
+	((int *)st->pdata[1])[i]=reg->nUserId;
+	((int *)st->pdata[2])[i]=reg->nLevel;
+	((int *)st->pdata[3])[i]=reg->numVerticesLine;
+	((int *)st->pdata[4])[i]=reg->numVerticesArrow;
 
-	strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
+	SET_STRING_ELT(st->table[5],i, COPY_TO_USER_STRING(reg->pszText));
 
-	complete_path(pathtofile, (char *) CHAR(STRING_ELT(coverage,0)),1);/*FIXME*/
+	SET_VECTOR_ELT(st->table[6], i, NEW_LIST(2));
+	aux=VECTOR_ELT(st->table[6], i);
 
-	if(!(file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), AVCFileLAB)))
-		error("Error opening file");
+/*This can be improved storing only the right numnber of vertices*/
+	SET_VECTOR_ELT(aux, 0, NEW_NUMERIC(4));
+	x=REAL(VECTOR_ELT(aux,0));
+	SET_VECTOR_ELT(aux, 1, NEW_NUMERIC(4));
+	y=REAL(VECTOR_ELT(aux,1));
 
-	n=0;
+	for(j=0;j<4;j++)
+	{
+		x[j]=reg->pasVertices[j].x;
+		y[j]=reg->pasVertices[j].y;
+	}
+}
 
-	while(AVCBinReadNextLab(file)){n++;}
+static const SEXPTYPE txt_types[7]={INTSXP, /*nTxtId*/
+	INTSXP, /*nUserId*/
+	INTSXP, /*nLevel*/
+	INTSXP, /*numVerticesLine*/
+	INTSXP, /*numVerticesArrow*/
+	STRSXP, /*Character strings*/
+	VECSXP};
+
+/*It imports the data from a txt file. If ids is not NULL only those
+annotations are read, using the index file (txx.adf)*/
+SEXP get_txt_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids) 
+{
+	AVCBinFile *file;
+	SEXP aux, fileptr;
 
-	Rprintf("Number of LABELS:%d\n",n);
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
+	file=open_coverage_file(directory, coverage, filename, AVCFileTXT,
+		fileptr);
 
-	table=calloc(8, sizeof(SEXP));
-	pdata=calloc(8, sizeof(void *));
+	aux=read_records(file, fileptr, ids, 7, txt_types, store_txt, NULL);
 
-	PROTECT(table[0]=NEW_INTEGER(n));
-	pdata[0]=INTEGER(table[0]);
-	PROTECT(table[1]=NEW_INTEGER(n));
-	pdata[1]=INTEGER(table[1]);
+	Rprintf("Number of TxT ANNOTATIONS:%d\n", LENGTH(VECTOR_ELT(aux,0)));
 
-	for(i=2;i<8;i++)
-	{
-		PROTECT(table[i]=NEW_NUMERIC(n));
-		pdata[i]=REAL(table[i]);
+	UNPROTECT(1);
 
-	}
+	return aux;
+}
 
-	if(AVCBinReadRewind(file))
-		error("Rewind");
 
-	for(i=0;i<n;i++)
-	{
-		if(!(reg=(AVCLab*)AVCBinReadNextLab(file)))
-			error("Error while reading register");
 
+/*Number of strings kept by str_cache (a power of 2)*/
+#define STR_CACHE_SIZE 4096
+
+/*
+What is needed to import the records of a table: its decode plan, the types
+of the columns and the strings already created. Character fields usually
+store codes and names that are repeated in many records, so each one is
+only converted to a CHARSXP once. The CHARSXPs are protected by the columns
+they were stored in.
+*/
+typedef struct
+{
+	AVCTableDecoder *decoder;
+	SEXPTYPE *types;
+	int nthreads;	/*Threads used to decode large tables (0 for all the
+			processors)*/
+	SEXP chr[STR_CACHE_SIZE];
+	unsigned int hash[STR_CACHE_SIZE];
+} table_store;
 
-		((int *)pdata[0])[i]=reg->nValue;
-		((int *)pdata[1])[i]=reg->nPolyId;
+/*
+It returns the CHARSXP for a value of a character field, from the cache if
+it has been seen before. ASCII strings (the usual case) are created in the
+native encoding and the rest are marked as latin1, the encoding used by
+Arc/Info.
+*/
+static SEXP table_string(table_store *ts, const char *pszStr)
+{
+	unsigned int h=2166136261u, slot;
+	unsigned char c, high=0;
+	int len, k;
+	SEXP chr;
 
-		((double*)pdata[2])[i]=reg->sCoord1.x;
-		((double*)pdata[3])[i]=reg->sCoord1.y;
-		((double*)pdata[4])[i]=reg->sCoord2.x;
-		((double*)pdata[5])[i]=reg->sCoord2.y;
-		((double*)pdata[6])[i]=reg->sCoord3.x;
-		((double*)pdata[7])[i]=reg->sCoord3.y;
-		
+	for(len=0;(c=(unsigned char)pszStr[len]);len++)
+	{
+		h=(h^c)*16777619u;
+		high|=c;
 	}
 
+	slot=h&(STR_CACHE_SIZE-1);
+	for(k=0;k<8;k++)
+	{
+		chr=ts->chr[(slot+k)&(STR_CACHE_SIZE-1)];
 
-	PROTECT(aux=NEW_LIST(8));
+		if(!chr)
+			break;
 
-	for(i=0;i<8;i++)
-	{
-		SET_VECTOR_ELT(aux,i,table[i]);
+		if(ts->hash[(slot+k)&(STR_CACHE_SIZE-1)]==h && LENGTH(chr)==len &&
+			!memcmp(CHAR(chr), pszStr, len))
+			return chr;
 	}
 
-	UNPROTECT(9);
+	/*Not found: it takes the first free slot or replaces the first one*/
+	if(k==8)
+		k=0;
+	slot=(slot+k)&(STR_CACHE_SIZE-1);
 
-	free(table);
-	free(pdata);
+	chr=mkCharLenCE(pszStr, len, (high&0x80)?CE_LATIN1:CE_NATIVE);
+	ts->chr[slot]=chr;
+	ts->hash[slot]=h;
 
-	return aux;
+	return chr;
 }
 
 
-SEXP get_cnt_data(SEXP directory, SEXP coverage, SEXP filename) 
+/*It returns the length of a name without its trailing spaces, that are
+not significant in the names of the fields of a table*/
+static int name_length(const char *name)
 {
-	int i,j,n, *ilabel;
-	void **pdata;
-	char pathtofile[PATH];
-	AVCCnt *reg;
-	AVCBinFile *file;
-	SEXP *table, label, aux;
-
+	int l=strlen(name);
 
-	strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
-	complete_path(pathtofile, (char *) CHAR(STRING_ELT(coverage,0)),1);/*FIXME*/
+	while(l>0 && name[l-1]==' ')
+		l--;
 
-	if(!(file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), AVCFileCNT)))
-		error("Error opening file");
+	return l;
+}
 
-	n=0;
+/*
+It sets fields to the (0-based) indexes of the fields of a table selected
+by columns, a vector of names or (1-based) positions, and n to their number.
+Names are matched ignoring trailing spaces.
+If columns is NULL fields is set to NULL and n to the number of fields, to
+select all of them. It returns 0, or i if the i-th column is not in the
+table.
+*/
+static int table_fields(AVCTableDef *tabledef, SEXP columns, int **fields,
+	int *n)
+{
+	int i, j, l;
+	const char *name;
 
-	while(AVCBinReadNextCnt(file)){n++;}
+	*fields=NULL;
+	*n=tabledef->numFields;
 
-	Rprintf("Number of CENTROIDS:%d\n",n);
+	if(isNull(columns))
+		return 0;
 
-	table=calloc(4, sizeof(SEXP));
-	pdata=calloc(4,sizeof(void *));
+	*n=LENGTH(columns);
+	*fields=(int *)R_alloc(MAX(*n,1), sizeof(int));
 
-	PROTECT(table[0]=NEW_INTEGER(n));
-	pdata[0]=INTEGER(table[0]);
+	for(i=0;i<*n;i++)
+	{
+		if(isString(columns))
+		{
+			name=CHAR(STRING_ELT(columns,i));
+			l=name_length(name);
 
-	PROTECT(table[1]=NEW_NUMERIC(n));
-	pdata[1]=REAL(table[1]);
+			for(j=0;j<tabledef->numFields;j++)
+				if(name_length(tabledef->pasFieldDef[j].szName)==l &&
+					!strncmp(tabledef->pasFieldDef[j].szName, name, l))
+					break;
+		}
+		else if((j=INTEGER(columns)[i])==NA_INTEGER || j<1)
+			j=tabledef->numFields;
+		else
+			j--;
 
-	PROTECT(table[2]=NEW_NUMERIC(n));
-	pdata[2]=REAL(table[2]);
+		if(j>=tabledef->numFields)
+			return i+1;
 
-	PROTECT(table[3]=NEW_INTEGER(n));
-	pdata[3]=INTEGER(table[3]);
+		(*fields)[i]=j;
+	}
 
-	PROTECT(label=NEW_LIST(n));
+	return 0;
+}
 
-	if(AVCBinReadRewind(file))
-		error("Rewind");
+/*It returns the names of n fields of a table (all of them if fields is
+NULL)*/
+static SEXP table_field_names(AVCTableDef *tabledef, const int *fields, int n)
+{
+	int i;
+	SEXP aux;
 
+	PROTECT(aux=NEW_STRING(n));
 	for(i=0;i<n;i++)
-	{
-		
-		if(!(reg=(AVCCnt*)AVCBinReadNextCnt(file)))
-			error("Error while reading register");
+		SET_STRING_ELT(aux, i, COPY_TO_USER_STRING(
+			tabledef->pasFieldDef[fields?fields[i]:i].szName));
+	UNPROTECT(1);
 
-		((int *)pdata[0])[i]=reg->nPolyId;
+	return aux;
+}
 
-		((double *)pdata[1])[i]=reg->sCoord.x;
-		((double *)pdata[2])[i]=reg->sCoord.y;
+/*It turns the columns of a table into a data frame*/
+static void make_data_frame(SEXP data, SEXP names)
+{
+	int n;
+	SEXP aux;
 
-		((int *)pdata[3])[i]=reg->numLabels;
+	n=(LENGTH(data)>0?LENGTH(VECTOR_ELT(data,0)):0);
 
-		SET_VECTOR_ELT(label,i,NEW_INTEGER(reg->numLabels));
-		ilabel=INTEGER(VECTOR_ELT(label,i));
-		if(reg->numLabels >0)
-		{
-			for(j=0;j<reg->numLabels;j++)
-			{
-/*				printf("%d\n", reg->panLabelIds[j]);*/
-				ilabel[j]=reg->panLabelIds[j];
-			}
-		}
+	setAttrib(data, R_NamesSymbol, names);
 
-	}
+	/*Compact row names, as in data.frame()*/
+	PROTECT(aux=NEW_INTEGER(2));
+	INTEGER(aux)[0]=NA_INTEGER;
+	INTEGER(aux)[1]=-n;
+	setAttrib(data, R_RowNamesSymbol, aux);
+	UNPROTECT(1);
 
+	setAttrib(data, R_ClassSymbol, mkString("data.frame"));
+}
 
-	PROTECT(aux=NEW_LIST(5));
+/*It returns the types of the columns for n fields of a table (to be freed
+by the caller)*/
+static SEXPTYPE *table_types(AVCTableDef *tabledef, const int *fields, int n)
+{
+	int i;
+	SEXPTYPE *types;
 
-	for(i=0;i<4;i++)
-		SET_VECTOR_ELT(aux, i, table[i]);
+	types=calloc(MAX(n,1), sizeof(SEXPTYPE));
 
-	SET_VECTOR_ELT(aux, 4, label);
+	for(i=0;i<n;i++)
+        {
+/*printf("%d %d %d\n",i,j,tabledef->pasFieldDef[j].nType1);*/
+		switch(tabledef->pasFieldDef[fields?fields[i]:i].nType1)
+		{
+			case 1:
+			case 2: types[i]=STRSXP;break;
 
-	UNPROTECT(6);
+			case 3: types[i]=INTSXP;break;
 
-	free(table);
-	free(pdata);
+			case 4: types[i]=REALSXP;break;
+                                
+			case 5: types[i]=INTSXP;break;
 
-	return aux;
-}
+			case 6: types[i]=REALSXP;break;
 
+			default: types[i]=LGLSXP;break;
+		}
+	}		
 
+	return types;
+}
 
-SEXP get_tol_data(SEXP directory, SEXP coverage, SEXP filename) 
+/*It returns a new table_store to import n fields of a table (all of them if
+fields is NULL). The rest of the fields are not decoded*/
+static table_store *new_table_store(AVCTableDef *tabledef, const int *fields,
+	int n)
 {
-	int i,n;
-	void **pdata;
-	char pathtofile[PATH];
-	AVCTol *reg;
-	AVCBinFile *file;
-	SEXP *table, aux;
+	AVCTableDecoder *decoder;
+	table_store *ts;
 
+	if(!(decoder=AVCBinCompileTableFields(tabledef, fields, n)))
+		error("The table has fields of unsupported types");
 
-	strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
-	complete_path(pathtofile, (char *) CHAR(STRING_ELT(coverage,0)), 1);/*FIXME*/
+	ts=(table_store *)calloc(1, sizeof(table_store));
+	ts->decoder=decoder;
+	ts->nthreads=1;
+	ts->types=table_types(tabledef, fields, n);
 
-	if(!(file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), AVCFileTOL)))
-		error("Error opening file");
+	return ts;
+}
 
-	n=0;
+static void free_table_store(table_store *ts)
+{
+	if(!ts)
+		return;
+
+	AVCBinFreeTableDecoder(ts->decoder);
+	free(ts->types);
+	free(ts);
+}
 
-	while(AVCBinReadNextTol(file)){n++;}
+/*Finalizer of a table_store kept in an external pointer*/
+static void finalize_table_store(SEXP ptr)
+{
+	free_table_store((table_store *)R_ExternalPtrAddr(ptr));
+	R_ClearExternalPtr(ptr);
+}
 
-	Rprintf("Number of TOLERANCES:%d\n", n);
-	
-	table=calloc(3, sizeof(SEXP));
-	pdata=calloc(3, sizeof(void *));
+/*Operators of the conditions on the fields of a table, in the order of
+AVCCompareOp*/
+static const char *compare_ops[]={"==", "!=", "<", "<=", ">", ">=", "in", NULL};
 
-	PROTECT(table[0]=NEW_INTEGER(n));
-	pdata[0]=INTEGER(table[0]);
-	PROTECT(table[1]=NEW_INTEGER(n));
-	pdata[1]=INTEGER(table[1]);
-	PROTECT(table[2]=NEW_NUMERIC(n));
-	pdata[2]=REAL(table[2]);
+/*
+It adds to the decode plan of a table the conditions in where, a list with
+the names of the fields, the operators and the values for each condition.
+It returns 0, i if the field of the i-th condition is not in the table or
+-i if its operator is not valid.
+*/
+static int table_conditions(AVCTableDef *tabledef, AVCTableDecoder *decoder,
+	SEXP where)
+{
+	int i, j, k, n, bad, *fields, type;
+	const char **str;
+	SEXP ops=VECTOR_ELT(where,1), values=VECTOR_ELT(where,2), v;
 
-	if(AVCBinReadRewind(file))
-		error("Rewind");
+	if((bad=table_fields(tabledef, VECTOR_ELT(where,0), &fields, &n)))
+		return bad;
 
 	for(i=0;i<n;i++)
 	{
-		if(!(reg=(AVCTol*)AVCBinReadNextTol(file)))
-			error("Error while reading register");
-
-		((int *)pdata[0])[i]=reg->nIndex;
-
-		((int *)pdata[1])[i]=reg->nFlag;
+		for(k=0;compare_ops[k];k++)
+			if(!strcmp(compare_ops[k], CHAR(STRING_ELT(ops,i))))
+				break;
 
-		((double *)pdata[2])[i]=reg->dValue;
-	}
+		if(!compare_ops[k])
+			return -(i+1);
 
-	PROTECT(aux=NEW_LIST(3));
-	for(i=0;i<3;i++)
-		SET_VECTOR_ELT(aux, i, table[i]);
+		/*Values are compared as strings for DATE and CHAR fields
+		and as numbers for the rest*/
+		type=tabledef->pasFieldDef[fields[i]].nType1;
+		if(type==1 || type==2)
+		{
+			PROTECT(v=coerceVector(VECTOR_ELT(values,i), STRSXP));
+			str=(const char **)R_alloc(MAX(LENGTH(v),1), sizeof(char *));
+			for(j=0;j<LENGTH(v);j++)
+				str[j]=CHAR(STRING_ELT(v,j));
 
-	UNPROTECT(4);
+			bad=AVCBinAddTableCondition(decoder, tabledef, 
+				fields[i], (AVCCompareOp)k, LENGTH(v), NULL, str);
+		}
+		else
+		{
+			PROTECT(v=coerceVector(VECTOR_ELT(values,i), REALSXP));
+			bad=AVCBinAddTableCondition(decoder, tabledef, 
+				fields[i], (AVCCompareOp)k, LENGTH(v), REAL(v), NULL);
+		}
+		UNPROTECT(1);
 
-	free(table);
-	free(pdata);
+		if(bad)
+			error("Invalid values in the condition on %s",
+				CHAR(STRING_ELT(VECTOR_ELT(where,0),i)));
+	}
 
-	return aux;
+	return 0;
 }
 
+/*Records of a table decoded at a time*/
+#define TABLE_BLOCK 1024
 
+/*Tables of at least TABLE_MT_MINSIZE bytes are decoded by several threads,
+in blocks of up to TABLE_MT_BLOCK records and TABLE_MT_STRBUF bytes of
+character fields*/
+#define TABLE_MT_MINSIZE (16*1024*1024)
+#define TABLE_MT_BLOCK (1024*1024)
+#define TABLE_MT_STRBUF (32*1024*1024)
 
-SEXP get_txt_data(SEXP directory, SEXP coverage, SEXP filename) 
+/*
+It imports the next nmax records of a table (all of them if nmax is
+negative) with its decode plan. Numeric fields are decoded straight into
+the columns, and character fields into a buffer for each block of records,
+from which the CHARSXPs are created. If the plan has conditions only the
+records that satisfy them are imported. If rows is not NULL the nmax
+records in rows (1-based) are imported instead, in that order. Large tables
+are decoded by ts->nthreads threads (see AVCBinReadTableRecordsMT()), but
+the CHARSXPs are always created by this thread.
+
+It returns a list with the columns.
+*/
+static SEXP read_table_records(AVCBinFile *file, table_store *ts, int nmax,
+	const int *rows)
 {
-	int i,j,n;
-	int **idata;
-	double *x, *y;
-	char pathtofile[PATH];
-	AVCTxt *reg;
-	AVCBinFile *file;
-	SEXP *table, points,aux;
+	AVCTableDecoder *dec=ts->decoder;
+	int i, j, k, n, nblock, ncol=dec->numFields, size, block=TABLE_BLOCK;
+	void **dest;
+	char **strbuf;
+	rec_store st;
+
+	/*When only some records are imported the columns grow as needed*/
+	if(nmax>=0)
+		n=nmax;
+	else if(dec->numConditions>0 || (n=AVCBinReadNumObjects(file))<0)
+		n=INIT_NREC;
+
+	st.file=file;
+	st.info=ts;
+	alloc_store(&st, ncol, ts->types, n);
+
+	if(ts->nthreads!=1 && !rows && dec->numConditions==0 &&
+		(double)AVCBinReadNumObjects(file)*dec->nRecordSize>=
+		TABLE_MT_MINSIZE)
+	{
+		for(j=0, size=0;j<ncol;j++)
+			if(ts->types[j]==STRSXP)
+				size+=dec->pasFields[j].nSize+1;
 
+		block=MAX(TABLE_BLOCK, 
+			MIN(TABLE_MT_BLOCK, TABLE_MT_STRBUF/MAX(size,1)));
+	}
 
-	strcpy(pathtofile, CHAR(STRING_ELT(directory,0)));
-	complete_path(pathtofile, (char *) CHAR(STRING_ELT(coverage,0)), 1);/*FIXME*/
+	dest=(void **)R_alloc(MAX(ncol,1), sizeof(void *));
+	strbuf=(char **)R_alloc(MAX(ncol,1), sizeof(char *));
+	for(j=0;j<ncol;j++)
+		if(ts->types[j]==STRSXP)
+			strbuf[j]=R_alloc(block, dec->pasFields[j].nSize+1);
 
-	if(!(file=AVCBinReadOpen(pathtofile,CHAR(STRING_ELT(filename,0)), AVCFileTXT)))
-		error("Error opening file");
+	for(i=0;nmax<0 || i<nmax;i+=k)
+	{
+		nblock=(nmax<0?block:MIN(block, nmax-i));
 
-	n=0;
+		if(i+nblock>st.len)
+			resize_store(&st, MAX(2*st.len, i+nblock));
 
-	while(AVCBinReadNextTxt(file)){n++;}
+		for(j=0;j<ncol;j++)
+		{
+			if(ts->types[j]==STRSXP)
+				dest[j]=strbuf[j];
+			else if(ts->types[j]==INTSXP)
+				dest[j]=(int *)st.pdata[j]+i;
+			else if(ts->types[j]==REALSXP)
+				dest[j]=(double *)st.pdata[j]+i;
+			else
+				dest[j]=NULL;
+		}
 
-	Rprintf("Number of TxT ANNOTATIONS:%d\n",n);
+		if(rows)
+			k=AVCBinReadTableRecordsAt(file, dec, nblock, rows+i, dest,
+				0);
+		else if(block>TABLE_BLOCK)
+			k=AVCBinReadTableRecordsMT(file, dec, nblock, dest, 0,
+				ts->nthreads);
+		else
+			k=AVCBinReadTableRecords(file, dec, nblock, dest, 0);
 
+		k=MAX(k, 0);
 
-	table=calloc(6, sizeof(SEXP));
-	idata=calloc(5, sizeof(int *));
+		for(j=0;j<ncol;j++)
+		{
+			if(ts->types[j]!=STRSXP)
+				continue;
 
+			size=dec->pasFields[j].nSize+1;
+			for(n=0;n<k;n++)
+				SET_STRING_ELT(st.table[j], i+n, 
+					table_string(ts, strbuf[j]+n*size));
+		}
 
-	PROTECT(table[0]=NEW_INTEGER(n));/*nTxtId*/
-	idata[0]=INTEGER(table[0]);
-	PROTECT(table[1]=NEW_INTEGER(n));/*nUserId*/
-	idata[1]=INTEGER(table[1]);
-	PROTECT(table[2]=NEW_INTEGER(n));/*nLevel*/
-	idata[2]=INTEGER(table[2]);
-	PROTECT(table[3]=NEW_INTEGER(n));/*numVerticesLine*/
-	idata[3]=INTEGER(table[3]);
-	PROTECT(table[4]=NEW_INTEGER(n));/*numVerticesArrow*/
-	idata[4]=INTEGER(table[4]);
+		if(k<nblock)
+		{
+			i+=k;
+			break;
+		}
+	}
 
-	PROTECT(table[5]=NEW_STRING(n));/*Character strings*/
+	if(i!=st.len)
+		resize_store(&st, i);
 
+	return store_to_list(&st);
+}
 
-	PROTECT(points=NEW_LIST(n));
+/*
+It imports the data from an INFO table as a data frame. If lazy is TRUE
+the columns are only read when they are used. Only the fields in columns
+(names or positions) are imported, or all of them if it is NULL. If where
+is not NULL only the records that satisfy its conditions (see
+table_conditions()) are imported; they are tested before any value is
+converted, and lazy is ignored. If rows is not NULL only those records
+(1-based) are imported, in that order, and lazy and where are ignored.
+Large tables are decoded by threads threads (0 for all the processors).
+*/
+SEXP get_table_data(SEXP infodir, SEXP tablename, SEXP lazy, SEXP columns,
+	SEXP where, SEXP rows, SEXP threads) 
+{
+	AVCBinFile *file;
+	table_store *ts;
+	int *fields, n, bad, i;
+	SEXP aux, names, tsptr, fileptr;
 
-	if(AVCBinReadRewind(file))
-		error("Rewind");
+	/*The file is closed by the finalizer if an error ends the call, unless
+	it is kept open by a coverage handle*/
+	PROTECT(fileptr=file_pointer(close_file_pointer));
 
-	for(i=0;i<n;i++)
+	if(!(file=open_table_file(infodir, tablename, fileptr)))
 	{
-		if(!(reg=(AVCTxt*)AVCBinReadNextTxt(file)))
-			error("Error while reading register");
+		error("Couldn't open table file\n");
+	}
 
-		((int *)idata[0])[i]=reg->nTxtId;
-		((int *)idata[1])[i]=reg->nUserId;
-		((int *)idata[2])[i]=reg->nLevel;
-		((int *)idata[3])[i]=reg->numVerticesLine;
-		((int *)idata[4])[i]=reg->numVerticesArrow;
+	/*Records are at a fixed position, so they can be read in any order*/
+	if(!isNull(rows))
+	{
+		where=R_NilValue;
 
-		SET_STRING_ELT(table[5],i, COPY_TO_USER_STRING(reg->pszText));
+		for(i=0;i<LENGTH(rows);i++)
+		{
+			if(INTEGER(rows)[i]==NA_INTEGER || INTEGER(rows)[i]<1 ||
+				INTEGER(rows)[i]>(file->hdr).psTableDef->numRecords)
+			{
+				close_file_pointer(fileptr);
+				error("Row %d not in the table", INTEGER(rows)[i]);
+			}
+		}
+	}
 
-		SET_VECTOR_ELT(points, i, NEW_LIST(2));
-		aux=VECTOR_ELT(points, i);
+	if((bad=table_fields((file->hdr).psTableDef, columns, &fields, &n)))
+	{
+		close_file_pointer(fileptr);
 
-/*This can be improved storing only the right numnber of vertices*/
-		SET_VECTOR_ELT(aux, 0, NEW_NUMERIC(4));
-		x=REAL(VECTOR_ELT(aux,0));
-		SET_VECTOR_ELT(aux, 1, NEW_NUMERIC(4));
-		y=REAL(VECTOR_ELT(aux,1));
+		if(isString(columns))
+			error("Field %s not found in the table",
+				CHAR(STRING_ELT(columns,bad-1)));
+		else
+			error("Field number %d not found in the table",
+				INTEGER(columns)[bad-1]);
+	}
 
-		for(j=0;j<4;j++)
-		{
-			x[j]=reg->pasVertices[j].x;
-			y[j]=reg->pasVertices[j].y;
-		}
+#ifdef HAVE_ALTREP
+	if(LOGICAL(lazy)[0] && isNull(where) && isNull(rows) && lazy_available())
+	{
+		PROTECT(aux=lazy_table_columns(file, fields, n));
+		PROTECT(names=table_field_names((file->hdr).psTableDef, fields, n));
+		make_data_frame(aux, names);
+		close_file_pointer(fileptr);
+		UNPROTECT(3);
 
+		return aux;
 	}
+#endif
 
-	PROTECT(aux=NEW_LIST(7));
+	ts=new_table_store((file->hdr).psTableDef, fields, n);
+	ts->nthreads=INTEGER(threads)[0];
 
-	for(i=0;i<6;i++)
-		SET_VECTOR_ELT(aux, i, table[i]);
+	/*The store is freed by the finalizer if an error ends the call*/
+	PROTECT(tsptr=R_MakeExternalPtr(ts, R_NilValue, R_NilValue));
+	R_RegisterCFinalizerEx(tsptr, finalize_table_store, TRUE);
 
-	SET_VECTOR_ELT(aux, i, points);
+	if(!isNull(where) && 
+		(bad=table_conditions((file->hdr).psTableDef, ts->decoder, where)))
+	{
+		close_file_pointer(fileptr);
+		finalize_table_store(tsptr);
 
-	UNPROTECT(8);
+		if(bad>0)
+			error("Field %s not found in the table",
+				CHAR(STRING_ELT(VECTOR_ELT(where,0),bad-1)));
+		else
+			error("Invalid operator %s",
+				CHAR(STRING_ELT(VECTOR_ELT(where,1),-bad-1)));
+	}
 
-	free(table);
-	free(idata);
+	PROTECT(names=table_field_names((file->hdr).psTableDef, fields, n));
+	if(!isNull(rows))
+		PROTECT(aux=read_table_records(file, ts, LENGTH(rows), 
+			INTEGER(rows)));
+	else
+		PROTECT(aux=read_table_records(file, ts, -1, NULL));
+	close_file_pointer(fileptr);
+	make_data_frame(aux, names);
+	finalize_table_store(tsptr);
+	UNPROTECT(4);
 
 	return aux;
 }
 
-SEXP get_table_data(SEXP infodir, SEXP tablename) 
-{
-	int i,j,n;
-	char pathtoinfodir[PATH];
-	void **pdata;
-	AVCTableDef *tabledef;
-	AVCField *reg;
-	AVCBinFile *file;
-	SEXP *table,aux;
 
-	strcpy(pathtoinfodir, CHAR(STRING_ELT(infodir,0)));
-	complete_path(pathtoinfodir, "", 1);
+/*How the records of each kind of file are imported in chunks*/
+typedef struct
+{
+	const char *name;
+	AVCFileType type;
+	int ncol;
+	const SEXPTYPE *types;
+	AVCBinReadObjectHandler store;
+	int ngeom;	/*Columns of the geometry (CSR layout), if any*/
+	const SEXPTYPE *geomtypes;
+	int icount;	/*Column with the number of elements of the geometry*/
+} chunk_format;
+
+static const chunk_format chunk_formats[]={
+	{"arc", AVCFileARC, 8, arc_csrtypes, store_arc, 2, arc_geomtypes, 6},
+	{"pal", AVCFilePAL, 7, pal_csrtypes, store_pal, 3, pal_geomtypes, 5},
+	{"lab", AVCFileLAB, 8, lab_types, store_lab, 0, NULL, 0},
+	{"cnt", AVCFileCNT, 5, cnt_types, store_cnt, 0, NULL, 0},
+	{"tol", AVCFileTOL, 3, tol_types, store_tol, 0, NULL, 0},
+	{"txt", AVCFileTXT, 7, txt_types, store_txt, 0, NULL, 0},
+	{"table", AVCFileTABLE, 0, NULL, NULL, 0, NULL, 0},
+	{NULL}
+};
+
+/*An open file that is read in chunks*/
+typedef struct
+{
+	AVCBinFile *file;	/*NULL when all the records have been read*/
+	const chunk_format *fmt;
+	int chunk;	/*Number of records of each chunk*/
+	table_store *ts;	/*Only for tables*/
+} chunk_iter;
 
-	if(!(file=AVCBinReadOpen(pathtoinfodir,CHAR(STRING_ELT(tablename,0)),AVCFileTABLE)))
-	{
-		error("Couldn't open table file\n");
-	}
+static void free_chunk_iter(SEXP ptr)
+{
+	chunk_iter *it=(chunk_iter *)R_ExternalPtrAddr(ptr);
 
-	n=0;
+	if(!it)
+		return;
 
-	while(AVCBinReadNextTableRec(file)){n++;}
+	if(it->file)
+		AVCBinReadClose(it->file);
 
-	AVCBinReadRewind(file);
+	free_table_store(it->ts);
+	free(it);
 
+	R_ClearExternalPtr(ptr);
+}
 
-	tabledef=(file->hdr).psTableDef;
+/*
+It opens a file of a coverage handle (or an INFO table) to read it in
+chunks of (at most) chunk records with next_chunk(). The iterator has its
+own copy of the file, so that it can be used with the rest of the
+functions of the handle at the same time.
+*/
+SEXP coverage_iter(SEXP handle, SEXP type, SEXP name, SEXP chunk)
+{
+	const chunk_format *fmt;
+	chunk_iter *it;
+	AVCTableDef *tabledef;
+	SEXP ptr;
 
-	table=calloc(tabledef->numFields, sizeof(SEXP));
-	pdata=calloc(tabledef->numFields, sizeof(void *));
+	if(!is_coverage_handle(handle))
+		error("A coverage handle is needed");
 
+	for(fmt=chunk_formats;fmt->name;fmt++)
+		if(!strcmp(fmt->name, CHAR(STRING_ELT(type,0))))
+			break;
 
-	for(i=0;i<tabledef->numFields;i++)
-        {
-/*printf("%d %d %d\n",i,j,tabledef->pasFieldDef[j].nType1);*/
-		switch(tabledef->pasFieldDef[i].nType1)
-		{
-			case 1:
-			case 2: PROTECT(table[i]=NEW_STRING(n));break;
+	if(!fmt->name)
+		error("Unknown type of file");
 
-			case 3: PROTECT(table[i]=NEW_INTEGER(n));
-				pdata[i]=(int *)INTEGER(table[i]);break;
+	if(INTEGER(chunk)[0]<1)
+		error("The size of the chunks must be positive");
 
-			case 4: PROTECT(table[i]=NEW_NUMERIC(n));
-				pdata[i]=(double *)REAL(table[i]);break;
-                                
-			case 5: PROTECT(table[i]=NEW_INTEGER(n));
-				pdata[i]=(int *)INTEGER(table[i]);break;
+	it=(chunk_iter *)calloc(1, sizeof(chunk_iter));
+	it->fmt=fmt;
+	it->chunk=INTEGER(chunk)[0];
 
-			case 6: PROTECT(table[i]=NEW_NUMERIC(n));
-				pdata[i]=(double *)REAL(table[i]);break;
-		}
-	}		
+	PROTECT(ptr=R_MakeExternalPtr(it, R_NilValue, R_NilValue));
+	R_RegisterCFinalizerEx(ptr, free_chunk_iter, TRUE);
 
+	if(!(it->file=coverage_open_file(handle, CHAR(STRING_ELT(name,0)),
+		fmt->type)))
+		error("Error opening file");
 
-	for(i=0;i<n;i++)
+	if(fmt->type==AVCFileTABLE)
 	{
-		reg=AVCBinReadNextTableRec(file);
+		tabledef=it->file->hdr.psTableDef;
+		it->ts=new_table_store(tabledef, NULL, tabledef->numFields);
 
-		for(j=0;j<tabledef->numFields;j++)
-		{
-/*			printf("%d %d %d\n",i,j,tabledef->pasFieldDef[j].nType1);*/
-			switch(tabledef->pasFieldDef[j].nType1)
-			{
-				case 1: 
-				case 2:
-	SET_STRING_ELT(table[j],i, COPY_TO_USER_STRING(reg[j].pszStr)); 
-				break;
+		/*The names of the fields are kept with the iterator*/
+		R_SetExternalPtrProtected(ptr, 
+			table_field_names(tabledef, NULL, tabledef->numFields));
+	}
 
-				case 3:
-				((int *)pdata[j])[i]=atoi(reg[j].pszStr);
-				break;
+	UNPROTECT(1);
 
-				case 4:
-				((double *)pdata[j])[i]=atof(reg[j].pszStr);
-				break;
+	return ptr;
+}
 
-				case 5:
-				if(reg[j].nInt16!=0)/*Single precision*/
-					((int *)pdata[j])[i]=reg[j].nInt16;
-				else/*Default and double precision*/
-					((int *)pdata[j])[i]=reg[j].nInt32;
-				break;
-				
-				case 6:
-				if(reg[j].fFloat!=0)/*Single precision*/
-					((double *)pdata[j])[i]=reg[j].fFloat;
-				else/*Default and double precision*/
-					((double *)pdata[j])[i]=reg[j].dDouble;
-				break;
-			}
-		}
-	}
+/*
+It returns the next chunk of records, as get_*_data() do (arcs and polygons
+in the CSR layout and tables as data frames), or NULL when all the records
+have been read. The user can interrupt the reading between two chunks.
+*/
+SEXP next_chunk(SEXP iter)
+{
+	chunk_iter *it=(chunk_iter *)R_ExternalPtrAddr(iter);
+	const chunk_format *fmt;
+	rec_store geom;
+	SEXP aux;
 
-	PROTECT(aux=NEW_LIST(tabledef->numFields));
+	if(!it)
+		error("The iterator is not valid");
 
-	for(i=0;i<tabledef->numFields;i++)
-		SET_VECTOR_ELT(aux, i, table[i]);
+	R_CheckUserInterrupt();
 
-	UNPROTECT(1+tabledef->numFields);
+	if(!it->file)
+		return R_NilValue;
 
-	free(table);
-	free(pdata);
+	fmt=it->fmt;
+
+	if(fmt->type==AVCFileTABLE)
+	{
+		/*The strings of the previous chunk may have been released*/
+		memset(it->ts->chr, 0, sizeof(it->ts->chr));
+
+		PROTECT(aux=read_table_records(it->file, it->ts, it->chunk, 
+			NULL));
+		make_data_frame(aux, R_ExternalPtrProtected(iter));
+		UNPROTECT(1);
+	}
+	else if(fmt->ngeom>0)
+	{
+		alloc_store(&geom, fmt->ngeom, fmt->geomtypes, INIT_NREC);
+		PROTECT(aux=read_chunk(it->file, it->chunk, fmt->ncol, fmt->types,
+			fmt->store, &geom));
+		aux=make_csr(aux, fmt->icount, &geom);
+		UNPROTECT(fmt->ngeom+1);
+	}
+	else
+		aux=read_chunk(it->file, it->chunk, fmt->ncol, fmt->types,
+			fmt->store, NULL);
+
+	/*The file is closed as soon as all the records have been read*/
+	if(LENGTH(aux)==0 || LENGTH(VECTOR_ELT(aux,0))<it->chunk)
+	{
+		AVCBinReadClose(it->file);
+		it->file=NULL;
+
+		if(LENGTH(aux)==0 || LENGTH(VECTOR_ELT(aux,0))==0)
+			return R_NilValue;
+	}
 
 	return aux;
 }
@@ -836,6 +1794,14 @@ void complete_path(char *path1, char *path2, int dir)
 	path1[l]='\0';
 }
 
+/*It raises an error if the path joining path1 and path2 with complete_path()
+(as a directory) doesn't fit in PATH chars*/
+void check_path(const char *path1, const char *path2)
+{
+	if(strlen(path1)+strlen(path2)+3>PATH)
+		error("The path is too long");
+}
+
 
 /*
 Code taken from the file avcimport.c
@@ -845,25 +1811,31 @@ Used to convert an E00 file into an Arc/Info binary coverage.
 /**********************************************************************
  *                          ConvertCover()
  *
- * Create a binary coverage from an E00 file.
+ * Create a binary coverage from an E00 file, which is expanded on the
+ * fly if it is compressed.
  *
  * It would be possible to have an option for the precision... coming soon!
  **********************************************************************/
-static void ConvertCovere00toavc(FILE *fpIn, const char *pszCoverName)
+static void ConvertCovere00toavc(VSILFILE *fpIn, const char *pszCoverName)
 {
     AVCE00WritePtr hWriteInfo;
+    AVCE00InputPtr hInput;
     const char *pszLine;
+    int nLineLen;
 
     hWriteInfo = AVCE00WriteOpen(pszCoverName, AVC_DEFAULT_PREC);
 
     if (hWriteInfo)
     {
+        hInput = AVCE00InputOpen(fpIn);
+
         while (CPLGetLastErrorNo() == 0 &&
-               (pszLine = CPLReadLine(fpIn) ) != NULL )
+               (pszLine = AVCE00InputNextLine(hInput, &nLineLen) ) != NULL )
         {
-            AVCE00WriteNextLine(hWriteInfo, pszLine);
+            AVCE00WriteNextLine(hWriteInfo, pszLine, nLineLen);
         }
 
+        AVCE00InputClose(hInput);
         AVCE00WriteClose(hWriteInfo);
     }
 }
@@ -874,9 +1846,11 @@ static void ConvertCovere00toavc(FILE *fpIn, const char *pszCoverName)
 
 SEXP e00toavc (SEXP e00file, SEXP avcdir)
 {
-	FILE *fpIn;
+	VSILFILE *fpIn;
 
-	fpIn = fopen( CHAR(STRING_ELT(e00file,0)), "rt");
+	/*The E00 file may be in a ZIP archive (/vsizip/), compressed
+	(/vsigzip/, /vsizstd/) or in memory*/
+	fpIn = VSIFOpenL( CHAR(STRING_ELT(e00file,0)), "rb");
 
 	if (fpIn == NULL)
 	{
@@ -885,7 +1859,7 @@ SEXP e00toavc (SEXP e00file, SEXP avcdir)
 
 	ConvertCovere00toavc(fpIn, CHAR(STRING_ELT(avcdir,0)));
 
-	fclose(fpIn);
+	VSIFCloseL(fpIn);
 
 	return R_NilValue;
 }
@@ -896,9 +1870,12 @@ SEXP e00toavc (SEXP e00file, SEXP avcdir)
 /**********************************************************************
  *                          ConvertCover()
  *
- * Convert a complete coverage to E00.
+ * Convert a complete coverage to E00, compressed (EXP  1) if
+ * bCompressed is TRUE.  The coverage is kept in hPtr (see 
+ * file_pointer()) while it is read.
  **********************************************************************/
-static void ConvertCoveravctoe00(const char *pszFname, FILE *fpOut)
+static void ConvertCoveravctoe00(const char *pszFname, VSILFILE *fpOut,
+                                 int bCompressed, SEXP hPtr)
 {
     AVCE00ReadPtr hReadInfo;
     const char *pszLine;
@@ -907,31 +1884,47 @@ static void ConvertCoveravctoe00(const char *pszFname, FILE *fpOut)
 
     if (hReadInfo)
     {
+        R_SetExternalPtrAddr(hPtr, hReadInfo);
+        AVCE00ReadSetCompressed(hReadInfo, bCompressed);
+
         while ((pszLine = AVCE00ReadNextLine(hReadInfo)) != NULL)
         {
-            fprintf(fpOut, "%s\n", pszLine);
+            if (VSIFWriteL(pszLine, 1, strlen(pszLine), fpOut) !=
+                    strlen(pszLine) ||
+                VSIFWriteL("\n", 1, 1, fpOut) != 1)
+                break;
         }
 
-        AVCE00ReadClose(hReadInfo);
+        close_e00_pointer(hPtr);
     }
 }
 
 /* Code to convert from a binary coverage to an E00 file*/
 
-SEXP avctoe00 (SEXP avcdir, SEXP e00file)
+SEXP avctoe00 (SEXP avcdir, SEXP e00file, SEXP compressed)
 {
-	FILE *fpOut;
+	VSILFILE *fpOut;
+	SEXP ptr;
 
-	fpOut = fopen( CHAR(STRING_ELT(e00file,0)), "wt");
+	/*The E00 file may be compressed (/vsigzip/, /vsizstd/) or in memory*/
+	fpOut = VSIFOpenL( CHAR(STRING_ELT(e00file,0)), "wb");
 
 	if (fpOut == NULL)
 	{
 		error("Cannot create E00 file\n");
 	}
 
-	ConvertCoveravctoe00( CHAR(STRING_ELT(avcdir,0)), fpOut);
+	PROTECT(ptr=file_pointer(close_e00_pointer));
+
+	ConvertCoveravctoe00( CHAR(STRING_ELT(avcdir,0)), fpOut,
+		LOGICAL(compressed)[0], ptr);
 
-	fclose(fpOut);
+	UNPROTECT(1);
+
+	if (VSIFCloseL(fpOut) != 0)
+	{
+		error("Cannot write E00 file\n");
+	}
 
 	return R_NilValue;
 }
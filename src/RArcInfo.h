@@ -5,6 +5,12 @@
 #include<Rinternals.h>
 #include<Rdefines.h>
 #include"cpl_port.h" /*Needed to set endianness.*/
+#include"avc.h"
+
+/*ALTREP, used to import data lazily, is available since R 3.5.0*/
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 5, 0)
+#define HAVE_ALTREP
+#endif
 
 #ifdef WIN32 
 #define SLASH 92 /* '\' */
@@ -18,21 +24,48 @@
 //SEXP get_names_of_coverages(SEXP directory);
 SEXP get_table_names(SEXP directory);
 SEXP get_table_fields(SEXP info_dir, SEXP table_name);
-SEXP get_arc_data(SEXP directory, SEXP coverage, SEXP filename) ;
+SEXP get_arc_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids, SEXP csr, SEXP lazy, SEXP threads);
 SEXP get_bnd_data(SEXP info_dir, SEXP tablename);
-SEXP get_pal_data(SEXP directory, SEXP coverage, SEXP filename);
+SEXP get_pal_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids, SEXP csr, SEXP lazy, SEXP threads);
 SEXP get_lab_data(SEXP directory, SEXP coverage, SEXP filename);
-SEXP get_cnt_data(SEXP directory, SEXP coverage, SEXP filename);
+SEXP get_cnt_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids);
 SEXP get_tol_data(SEXP directory, SEXP coverage, SEXP filename);
-SEXP get_table_data(SEXP infodir, SEXP tablename);
-SEXP get_txt_data(SEXP directory, SEXP coverage, SEXP filename);
+SEXP get_table_data(SEXP infodir, SEXP tablename, SEXP lazy, SEXP columns,
+	SEXP where, SEXP rows, SEXP threads);
+SEXP get_txt_data(SEXP directory, SEXP coverage, SEXP filename, SEXP ids);
 
 void complete_path(char *path1, char *path2, int dir);
+void check_path(const char *path1, const char *path2);
+
+SEXP open_coverage(SEXP directory, SEXP coverage);
+SEXP close_coverage(SEXP handle);
+SEXP coverage_info(SEXP handle);
+int is_coverage_handle(SEXP x);
+const char *coverage_info_path(SEXP handle);
+AVCBinFile *coverage_file(SEXP handle, const char *pszName, AVCFileType eType);
+AVCBinFile *coverage_open_file(SEXP handle, const char *pszName, 
+	AVCFileType eType);
+SEXP coverage_iter(SEXP handle, SEXP type, SEXP name, SEXP chunk);
+SEXP next_chunk(SEXP iter);
+
+SEXP vsimem_write(SEXP filename, SEXP data);
+SEXP vsimem_read(SEXP filename);
+SEXP vsimem_unlink(SEXP filename);
+
+#ifdef HAVE_ALTREP
+#include<R_ext/Rdynload.h>
+void init_lazy_classes(DllInfo *dll);
+int lazy_available(void);
+SEXP lazy_table_columns(AVCBinFile *file, const int *fields, int n);
+SEXP lazy_geometry(const char *pszFname, int n, const int *count,
+	const double *recpos, int nval, int type, int size);
+#endif
 
-static void ConvertCovere00toavc(FILE *fpIn, const char *pszCoverName);
+static void ConvertCovere00toavc(VSILFILE *fpIn, const char *pszCoverName);
 SEXP e00toavc (SEXP e00file, SEXP avcdir);
 
-static void ConvertCoveravctoe00(const char *pszFname, FILE *fpOut);
-SEXP avctoe00 (SEXP avcdir, SEXP e00file);
+static void ConvertCoveravctoe00(const char *pszFname, VSILFILE *fpOut,
+	int bCompressed, SEXP hPtr);
+SEXP avctoe00 (SEXP avcdir, SEXP e00file, SEXP compressed);
 
 #endif
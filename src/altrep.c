@@ -0,0 +1,529 @@
+#include"RArcInfo.h"
+#include"avc.h"
+
+#include<R.h>
+#include<Rinternals.h>
+
+/*
+Lazy import of the INFO tables and the geometry of the coverages. The
+vectors returned are ALTREP objects that only keep where their values are
+in the file. The values are read when they are accessed, one by one or by
+regions, and the whole vector is only read when R needs a pointer to its
+data.
+*/
+
+#ifdef HAVE_ALTREP
+
+#include<R_ext/Altrep.h>
+
+/*File where the values of lazy vectors are read from. It is shared by all
+the vectors imported from the same file*/
+typedef struct
+{
+	char *pszFname;
+	AVCRawBinFile *hFile;	/*Opened on first access*/
+	int nrec;	/*Number of records (-1 for tables)*/
+	int *offsets;	/*Only for geometry: first value of each record...*/
+	GIntBig *recpos;	/*...and position of its values in the file*/
+} lazy_file;
+
+/*Where the values of a lazy vector are in the file*/
+typedef struct
+{
+	lazy_file *src;
+	int type;	/*AVC_FT_* type of the values*/
+	int size;	/*Size of each value, in bytes*/
+	int n;		/*Number of values*/
+	int pos;	/*Position of the first value in a record*/
+	int stride;	/*Distance between two consecutive values, in bytes*/
+} lazy_vector;
+
+static R_altrep_class_t lazy_int_class, lazy_real_class, lazy_str_class;
+
+/*TRUE once the classes have been made by init_lazy_classes()*/
+static int lazy_classes_ready=FALSE;
+
+#define LAZY_VECTOR(x) ((lazy_vector *)R_ExternalPtrAddr(R_altrep_data1(x)))
+
+
+static void free_lazy_file(SEXP ptr)
+{
+	lazy_file *src=(lazy_file *)R_ExternalPtrAddr(ptr);
+
+	if(!src)
+		return;
+
+	if(src->hFile)
+		AVCRawBinClose(src->hFile);
+
+	CPLFree(src->pszFname);
+	CPLFree(src->offsets);
+	CPLFree(src->recpos);
+	CPLFree(src);
+
+	R_ClearExternalPtr(ptr);
+}
+
+static void free_lazy_vector(SEXP ptr)
+{
+	CPLFree(R_ExternalPtrAddr(ptr));
+	R_ClearExternalPtr(ptr);
+}
+
+/*It returns a new (protected) lazy_file. nrec is -1 for tables*/
+static SEXP new_lazy_file(const char *pszFname, int nrec)
+{
+	lazy_file *src;
+	SEXP ptr;
+
+	/*The finalizer is set first, so that nothing is lost if an allocation
+	fails*/
+	PROTECT(ptr=R_MakeExternalPtr(NULL, R_NilValue, R_NilValue));
+	R_RegisterCFinalizerEx(ptr, free_lazy_file, TRUE);
+
+	src=(lazy_file *)CPLCalloc(1, sizeof(lazy_file));
+	R_SetExternalPtrAddr(ptr, src);
+	src->pszFname=CPLStrdup(pszFname);
+	src->nrec=nrec;
+
+	if(nrec>=0)
+	{
+		src->offsets=(int *)CPLCalloc(nrec+1, sizeof(int));
+		src->recpos=(GIntBig *)CPLCalloc(MAX(nrec, 1), sizeof(GIntBig));
+	}
+
+	return ptr;
+}
+
+/*It returns a new lazy vector with values in file*/
+static SEXP new_lazy_vector(SEXP file, int type, int size, int n, int pos,
+	int stride)
+{
+	lazy_vector *lv;
+	R_altrep_class_t class;
+	SEXP ptr, ans;
+
+	/*The file is released when no vector uses it*/
+	PROTECT(ptr=R_MakeExternalPtr(NULL, R_NilValue, file));
+	R_RegisterCFinalizerEx(ptr, free_lazy_vector, TRUE);
+
+	lv=(lazy_vector *)CPLCalloc(1, sizeof(lazy_vector));
+	R_SetExternalPtrAddr(ptr, lv);
+	lv->src=(lazy_file *)R_ExternalPtrAddr(file);
+	lv->type=type;
+	lv->size=size;
+	lv->n=n;
+	lv->pos=pos;
+	lv->stride=stride;
+
+	switch(type)
+	{
+		case AVC_FT_FIXINT:
+		case AVC_FT_BININT: class=lazy_int_class;break;
+
+		case AVC_FT_FIXNUM:
+		case AVC_FT_BINFLOAT: class=lazy_real_class;break;
+
+		default: class=lazy_str_class;break;
+	}
+
+	ans=R_new_altrep(class, ptr, R_NilValue);
+
+	UNPROTECT(1);
+
+	return ans;
+}
+
+/*It returns where the k-th value is in the file*/
+static GIntBig value_position(lazy_vector *lv, R_xlen_t k)
+{
+	int a, b, m;
+	lazy_file *src=lv->src;
+
+	if(src->nrec<0)/*Tables*/
+		return lv->pos+(GIntBig)k*lv->stride;
+
+	/*Geometry: look for the record with offsets[a]<=k<offsets[a+1]*/
+	a=0;
+	b=src->nrec;
+	while(b-a>1)
+	{
+		m=(a+b)/2;
+		if(src->offsets[m]<=k)
+			a=m;
+		else
+			b=m;
+	}
+
+	return src->recpos[a]+lv->pos+(GIntBig)(k-src->offsets[a])*lv->stride;
+}
+
+/*It reads the bytes of the k-th value. pabyBuf must be at least
+lv->size+1 bytes long*/
+static GByte *read_value(lazy_vector *lv, R_xlen_t k, GByte *pabyBuf)
+{
+	lazy_file *src=lv->src;
+
+	if(!src->hFile && !(src->hFile=AVCRawBinOpen(src->pszFname, "r")))
+		error("Couldn't open %s", src->pszFname);
+
+	AVCRawBinFSeek(src->hFile, value_position(lv, k), SEEK_SET);
+	AVCRawBinReadBytes(src->hFile, lv->size, pabyBuf);
+	pabyBuf[lv->size]='\0';
+
+	return pabyBuf;
+}
+
+static int decode_int(lazy_vector *lv, GByte *pabyBuf)
+{
+	if(lv->type==AVC_FT_FIXINT)
+		return _AVCParseFixInt((char *)pabyBuf, lv->size);
+	else if(lv->size==2)
+		return AVCRawBinDecodeInt16(pabyBuf);
+	else
+		return AVCRawBinDecodeInt32(pabyBuf);
+}
+
+static double decode_real(lazy_vector *lv, GByte *pabyBuf)
+{
+	if(lv->type==AVC_FT_FIXNUM)
+		return _AVCParseFixNum((char *)pabyBuf, lv->size);
+	else if(lv->size==4)
+		return AVCRawBinDecodeFloat(pabyBuf);
+	else
+		return AVCRawBinDecodeDouble(pabyBuf);
+}
+
+/*Strings that are not ASCII are marked as latin1, as get_table_data() does*/
+static SEXP decode_str(GByte *pabyBuf)
+{
+	GByte *p;
+
+	for(p=pabyBuf;*p;p++)
+		if(*p&0x80)
+			return mkCharCE((char *)pabyBuf, CE_LATIN1);
+
+	return mkChar((char *)pabyBuf);
+}
+
+/*It reads n values starting at the start-th one*/
+static void read_values(lazy_vector *lv, R_xlen_t start, R_xlen_t n,
+	SEXP x, void *buf)
+{
+	R_xlen_t k;
+	GByte *pabyBuf;
+
+	pabyBuf=(GByte *)R_alloc(lv->size+1, sizeof(GByte));
+
+	for(k=0;k<n;k++)
+	{
+		read_value(lv, start+k, pabyBuf);
+
+		if(TYPEOF(x)==INTSXP)
+			((int *)buf)[k]=decode_int(lv, pabyBuf);
+		else if(TYPEOF(x)==REALSXP)
+			((double *)buf)[k]=decode_real(lv, pabyBuf);
+		else
+			SET_STRING_ELT(x, start+k, decode_str(pabyBuf));
+	}
+}
+
+/*It reads all the values, which are kept in data2*/
+static SEXP lazy_materialize(SEXP x)
+{
+	lazy_vector *lv;
+	SEXP data=R_altrep_data2(x);
+
+	if(data==R_NilValue)
+	{
+		lv=LAZY_VECTOR(x);
+
+		PROTECT(data=allocVector(TYPEOF(x), lv->n));
+
+		if(TYPEOF(x)==INTSXP)
+			read_values(lv, 0, lv->n, data, INTEGER(data));
+		else if(TYPEOF(x)==REALSXP)
+			read_values(lv, 0, lv->n, data, REAL(data));
+		else
+			read_values(lv, 0, lv->n, data, NULL);
+
+		R_set_altrep_data2(x, data);
+		UNPROTECT(1);
+	}
+
+	return data;
+}
+
+/*Methods common to all the classes*/
+static R_xlen_t lazy_length(SEXP x)
+{
+	return LAZY_VECTOR(x)->n;
+}
+
+static Rboolean lazy_inspect(SEXP x, int pre, int deep, int pvec,
+	void (*inspect_subtree)(SEXP, int, int, int))
+{
+	Rprintf(" lazy vector from %s (%s)\n", LAZY_VECTOR(x)->src->pszFname,
+		R_altrep_data2(x)==R_NilValue?"not read":"read");
+
+	return TRUE;
+}
+
+/*Serialized as an ordinary vector*/
+static SEXP lazy_serialized_state(SEXP x)
+{
+	return lazy_materialize(x);
+}
+
+static SEXP lazy_unserialize(SEXP class, SEXP state)
+{
+	return state;
+}
+
+static const void *lazy_dataptr_or_null(SEXP x)
+{
+	SEXP data=R_altrep_data2(x);
+
+	if(data==R_NilValue)
+		return NULL;
+
+	return DATAPTR_RO(data);
+}
+
+/*Integer vectors*/
+static void *lazy_int_dataptr(SEXP x, Rboolean writeable)
+{
+	return INTEGER(lazy_materialize(x));
+}
+
+static int lazy_int_elt(SEXP x, R_xlen_t i)
+{
+	GByte abyBuf[AVCRAWBIN_READBUFSIZE];
+	lazy_vector *lv=LAZY_VECTOR(x);
+
+	if(R_altrep_data2(x)!=R_NilValue)
+		return INTEGER(R_altrep_data2(x))[i];
+
+	if(lv->size>=AVCRAWBIN_READBUFSIZE)
+		return INTEGER(lazy_materialize(x))[i];
+
+	return decode_int(lv, read_value(lv, i, abyBuf));
+}
+
+static R_xlen_t lazy_int_get_region(SEXP x, R_xlen_t i, R_xlen_t n, int *buf)
+{
+	lazy_vector *lv=LAZY_VECTOR(x);
+
+	n=(i+n>lv->n?lv->n-i:n);
+
+	if(R_altrep_data2(x)!=R_NilValue)
+		memcpy(buf, INTEGER(R_altrep_data2(x))+i, n*sizeof(int));
+	else
+		read_values(lv, i, n, x, buf);
+
+	return n;
+}
+
+/*Real vectors*/
+static void *lazy_real_dataptr(SEXP x, Rboolean writeable)
+{
+	return REAL(lazy_materialize(x));
+}
+
+static double lazy_real_elt(SEXP x, R_xlen_t i)
+{
+	GByte abyBuf[AVCRAWBIN_READBUFSIZE];
+	lazy_vector *lv=LAZY_VECTOR(x);
+
+	if(R_altrep_data2(x)!=R_NilValue)
+		return REAL(R_altrep_data2(x))[i];
+
+	if(lv->size>=AVCRAWBIN_READBUFSIZE)
+		return REAL(lazy_materialize(x))[i];
+
+	return decode_real(lv, read_value(lv, i, abyBuf));
+}
+
+static R_xlen_t lazy_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n,
+	double *buf)
+{
+	lazy_vector *lv=LAZY_VECTOR(x);
+
+	n=(i+n>lv->n?lv->n-i:n);
+
+	if(R_altrep_data2(x)!=R_NilValue)
+		memcpy(buf, REAL(R_altrep_data2(x))+i, n*sizeof(double));
+	else
+		read_values(lv, i, n, x, buf);
+
+	return n;
+}
+
+/*Character vectors (strings are always read at once)*/
+static void *lazy_str_dataptr(SEXP x, Rboolean writeable)
+{
+	return (void *)DATAPTR_RO(lazy_materialize(x));
+}
+
+static SEXP lazy_str_elt(SEXP x, R_xlen_t i)
+{
+	return STRING_ELT(lazy_materialize(x), i);
+}
+
+static void lazy_str_set_elt(SEXP x, R_xlen_t i, SEXP v)
+{
+	SET_STRING_ELT(lazy_materialize(x), i, v);
+}
+
+/*It registers the ALTREP classes. Called when the package is loaded*/
+void init_lazy_classes(DllInfo *dll)
+{
+	R_altrep_class_t class;
+
+	lazy_int_class=R_make_altinteger_class("avc_lazy_int", "RArcInfo", dll);
+	lazy_real_class=R_make_altreal_class("avc_lazy_real", "RArcInfo", dll);
+	lazy_str_class=R_make_altstring_class("avc_lazy_str", "RArcInfo", dll);
+
+	class=lazy_int_class;
+	R_set_altinteger_Elt_method(class, lazy_int_elt);
+	R_set_altinteger_Get_region_method(class, lazy_int_get_region);
+	R_set_altvec_Dataptr_method(class, lazy_int_dataptr);
+
+	class=lazy_real_class;
+	R_set_altreal_Elt_method(class, lazy_real_elt);
+	R_set_altreal_Get_region_method(class, lazy_real_get_region);
+	R_set_altvec_Dataptr_method(class, lazy_real_dataptr);
+
+	class=lazy_str_class;
+	R_set_altstring_Elt_method(class, lazy_str_elt);
+	R_set_altstring_Set_elt_method(class, lazy_str_set_elt);
+	R_set_altvec_Dataptr_method(class, lazy_str_dataptr);
+
+	/*Common methods*/
+	R_set_altrep_Length_method(lazy_int_class, lazy_length);
+	R_set_altrep_Length_method(lazy_real_class, lazy_length);
+	R_set_altrep_Length_method(lazy_str_class, lazy_length);
+
+	R_set_altrep_Inspect_method(lazy_int_class, lazy_inspect);
+	R_set_altrep_Inspect_method(lazy_real_class, lazy_inspect);
+	R_set_altrep_Inspect_method(lazy_str_class, lazy_inspect);
+
+	R_set_altrep_Serialized_state_method(lazy_int_class,
+		lazy_serialized_state);
+	R_set_altrep_Serialized_state_method(lazy_real_class,
+		lazy_serialized_state);
+	R_set_altrep_Serialized_state_method(lazy_str_class,
+		lazy_serialized_state);
+
+	R_set_altrep_Unserialize_method(lazy_int_class, lazy_unserialize);
+	R_set_altrep_Unserialize_method(lazy_real_class, lazy_unserialize);
+	R_set_altrep_Unserialize_method(lazy_str_class, lazy_unserialize);
+
+	R_set_altvec_Dataptr_or_null_method(lazy_int_class,
+		lazy_dataptr_or_null);
+	R_set_altvec_Dataptr_or_null_method(lazy_real_class,
+		lazy_dataptr_or_null);
+	R_set_altvec_Dataptr_or_null_method(lazy_str_class,
+		lazy_dataptr_or_null);
+
+	lazy_classes_ready=TRUE;
+}
+
+/*It returns TRUE if lazy vectors can be made. Otherwise the data must be
+imported at once*/
+int lazy_available(void)
+{
+	return lazy_classes_ready;
+}
+
+/*
+It returns a list with a lazy vector for n fields of an (already opened)
+INFO table, the fields[i]-th field for the i-th vector (all the fields, in
+order, if fields is NULL). Fields of unsupported types are returned as
+vectors of NAs.
+*/
+SEXP lazy_table_columns(AVCBinFile *file, const int *fields, int n)
+{
+	int i, j, stride, type, *pos;
+	AVCTableDef *tabledef=file->hdr.psTableDef;
+	AVCFieldInfo *field;
+	SEXP src, aux;
+
+	/*Records are as long as their fields, rounded to nRecSize
+	(see _AVCBinReadNextTableRec())*/
+	pos=(int *)R_alloc(tabledef->numFields+1, sizeof(int));
+	for(j=0, pos[0]=0;j<tabledef->numFields;j++)
+		pos[j+1]=pos[j]+tabledef->pasFieldDef[j].nSize;
+	stride=MAX(pos[tabledef->numFields], tabledef->nRecSize);
+
+	src=new_lazy_file(file->pszFilename, -1);
+	PROTECT(aux=NEW_LIST(n));
+
+	for(i=0;i<n;i++)
+	{
+		j=(fields?fields[i]:i);
+		field=tabledef->pasFieldDef+j;
+		type=field->nType1*10;
+
+		if(!(type==AVC_FT_DATE || type==AVC_FT_CHAR || 
+			type==AVC_FT_FIXINT || type==AVC_FT_FIXNUM ||
+			(type==AVC_FT_BININT && 
+				(field->nSize==2 || field->nSize==4)) ||
+			(type==AVC_FT_BINFLOAT &&
+				(field->nSize==4 || field->nSize==8))))
+		{
+			SET_VECTOR_ELT(aux, i,
+				allocVector(LGLSXP, tabledef->numRecords));
+			continue;
+		}
+
+		SET_VECTOR_ELT(aux, i, new_lazy_vector(src, type,
+			field->nSize, tabledef->numRecords, pos[j], stride));
+	}
+
+	UNPROTECT(2);
+
+	return aux;
+}
+
+/*
+It returns a list with the (lazy) geometry of n records in the CSR layout
+(see make_csr() in RArcInfo.c): a vector for each of the nval values of the
+elements of a record, plus the offsets of the records. Each record has
+count[i] elements and they start at recpos[i] in the file. Values are
+of type AVC_FT_BININT or AVC_FT_BINFLOAT, with size bytes.
+*/
+SEXP lazy_geometry(const char *pszFname, int n, const int *count,
+	const double *recpos, int nval, int type, int size)
+{
+	int i, *offsets;
+	lazy_file *file;
+	SEXP src, aux;
+
+	src=new_lazy_file(pszFname, n);
+	file=(lazy_file *)R_ExternalPtrAddr(src);
+
+	PROTECT(aux=NEW_LIST(nval+1));
+	SET_VECTOR_ELT(aux, nval, NEW_INTEGER(n+1));
+	offsets=INTEGER(VECTOR_ELT(aux, nval));
+
+	offsets[0]=0;
+	for(i=0;i<n;i++)
+	{
+		offsets[i+1]=offsets[i]+count[i];
+		file->recpos[i]=(GIntBig)recpos[i];
+	}
+	memcpy(file->offsets, offsets, (n+1)*sizeof(int));
+
+	for(i=0;i<nval;i++)
+	{
+		SET_VECTOR_ELT(aux, i, new_lazy_vector(src, type, size,
+			offsets[n], i*size, nval*size));
+	}
+
+	UNPROTECT(2);
+
+	return aux;
+}
+
+#endif /*HAVE_ALTREP*/
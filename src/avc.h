@@ -291,21 +291,119 @@ typedef struct AVCField_t
     char        *pszStr;
 }AVCField;
 
+/*---------------------------------------------------------------------
+ * Decode plan for the records of a table, compiled once from its 
+ * AVCTableDef by AVCBinCompileTableDef() (or AVCBinCompileTableFields() 
+ * for a subset of its fields) and used by AVCBinReadTableRecords() to 
+ * decode blocks of records straight into typed columns.
+ *--------------------------------------------------------------------*/
+typedef enum
+{
+    AVCDecodeString,    /* DATE, CHAR: nSize chars + '\0' per value    */
+    AVCDecodeFixInt,    /* FIXINT: GInt32                              */
+    AVCDecodeFixNum,    /* FIXNUM: double                              */
+    AVCDecodeInt16,     /* 16 bits BININT: GInt32                      */
+    AVCDecodeInt32,     /* 32 bits BININT: GInt32                      */
+    AVCDecodeFloat,     /* Single precision BINFLOAT: double           */
+    AVCDecodeDouble     /* Double precision BINFLOAT: double           */
+}AVCFieldDecodeKind;
+
+typedef struct AVCFieldDecoder_t
+{
+    AVCFieldDecodeKind eKind;
+    int         nOffset;        /* Position of the field in the record  */
+    int         nSize;
+}AVCFieldDecoder;
+
+/*---------------------------------------------------------------------
+ * Conditions on the fields of a table, added to a decode plan with 
+ * AVCBinAddTableCondition().  They are tested on the bytes of each 
+ * record, and AVCBinReadTableRecords() only decodes the records that 
+ * satisfy all of them.
+ *--------------------------------------------------------------------*/
+typedef enum
+{
+    AVCCompareEQ,       /* ==  */
+    AVCCompareNE,       /* !=  */
+    AVCCompareLT,       /* <   */
+    AVCCompareLE,       /* <=  */
+    AVCCompareGT,       /* >   */
+    AVCCompareGE,       /* >=  */
+    AVCCompareIN        /* equal to one of the values */
+}AVCCompareOp;
+
+typedef struct AVCFieldCondition_t
+{
+    AVCFieldDecoder sField;
+    AVCCompareOp eOp;
+    int         numValues;
+    double      *padValues;     /* Numeric fields                       */
+    char        **papszValues;  /* DATE and CHAR fields, without the    */
+                                /* trailing spaces                      */
+}AVCFieldCondition;
+
+typedef struct AVCTableDecoder_t
+{
+    int         numFields;
+    int         nRecordSize;    /* Bytes used by each record in the file */
+    AVCFieldDecoder *pasFields;
+
+    int         numConditions;
+    AVCFieldCondition *pasConditions;
+}AVCTableDecoder;
+
+/* Bytes of records read at a time by AVCBinReadTableRecords() when they
+ * are not in the buffer of the file
+ */
+#define AVCTABLE_READBLOCKSIZE 65536
+
+/* Minimum number of records decoded by each thread of 
+ * AVCBinReadTableRecordsMT()
+ */
+#define AVCTABLE_MT_MINRECORDS 16384
+
 /*---------------------------------------------------------------------
  * Stuff related to buffered reading of raw binary files
  *--------------------------------------------------------------------*/
 
 #define AVCRAWBIN_READBUFSIZE 1024
 
+/* Files opened for reading that are not memory-mapped, and larger than
+ * one block, are read ahead by a background thread in two blocks of
+ * this size.  The environment variable AVC_READAHEAD sets another size 
+ * in bytes, 0 disables the read-ahead.  The thread only stops when
+ * the file is closed, so a caller whose error handler does not return
+ * (see avc_rawbin.c) must make sure the file is closed anyway.
+ */
+#define AVCRAWBIN_READAHEADSIZE (1024*1024)
+
+typedef struct AVCRawBinReadAhead_t AVCRawBinReadAhead;
+
 typedef struct AVCRawBinFile_t
 {
-    FILE        *fp;
+    VSILFILE    *fp;
     char        *pszFname;
     AVCAccess   eAccess;
     GByte       abyBuf[AVCRAWBIN_READBUFSIZE];
-    int         nOffset;        /* Location of current buffer in the file */
+    GByte       *pabyBuf;       /* Current buffer: abyBuf[] or pabyMap  */
+    GIntBig     nOffset;        /* Location of current buffer in the file */
     int         nCurSize;       /* Nbr of bytes currently loaded        */
-    int         nCurPos;        /* Next byte to read from abyBuf[]      */
+    int         nCurPos;        /* Next byte to read from pabyBuf[]     */
+
+    /* In read-only mode the whole file may be memory-mapped, in which
+     * case pabyBuf points to the mapping and nCurSize is the file size.
+     * Files larger than 2 GB are never mapped, positions in a buffer 
+     * are ints.
+     */
+    GByte       *pabyMap;
+    size_t      nMapSize;
+
+    GBool       bDisableReadBytesEOFError; /* Set by AVCRawBinEOF()  */
+
+    /* When the file is read ahead, pabyBuf points to the block of the
+     * read-ahead thread that is being read.
+     */
+    AVCRawBinReadAhead *psReadAhead;
 }AVCRawBinFile;
 
 
@@ -325,7 +423,7 @@ typedef struct AVCBinFile_t
 {
     AVCRawBinFile *psRawBinFile;
     char          *pszFilename;
-    AVCRawBinFile *psIndexFile;   /* Index file, Write mode only */
+    AVCRawBinFile *psIndexFile;   /* Index file (arx, pax, ...) or NULL */
 
     AVCFileType   eFileType;
     int           nPrecision;     /* AVC_SINGLE/DOUBLE_PREC  */
@@ -353,6 +451,29 @@ typedef struct AVCBinFile_t
 
 }AVCBinFile;
 
+/* Callback used by AVCBinReadObjects() to pass each object that is read
+ * (an AVCArc*, AVCPal*, ...) and its position in the list of objects.
+ */
+typedef void (*AVCBinReadObjectHandler)(void *psObj, int iPos, 
+                                        void *pUserData);
+
+/* Where the records of an ARC or PAL file are and the number of 
+ * vertices or arcs of each one (see AVCBinReadObjectPositions())
+ */
+typedef struct AVCBinObjectPositions_t
+{
+    int         numObjects;
+    GIntBig     *panPosition;   /* Position of each record, in bytes    */
+    int         *panCount;      /* Vertices (ARC) or arcs (PAL)         */
+    int         *panStart;      /* Vertices or arcs of the records that */
+                                /* come before (numObjects+1 values)    */
+}AVCBinObjectPositions;
+
+/* Minimum number of bytes of records decoded by each thread of 
+ * AVCBinReadObjectColumns()
+ */
+#define AVCBIN_MT_MINBYTES (1024*1024)
+
 /*---------------------------------------------------------------------
  * Stuff related to the generation of E00
  *--------------------------------------------------------------------*/
@@ -426,6 +547,59 @@ typedef struct AVCE00ParseInfo_t
 }AVCE00ParseInfo;
 
 
+/*---------------------------------------------------------------------
+ * Stuff related to compressed E00 files (EXP  1)
+ *--------------------------------------------------------------------*/
+
+/* Longest line expanded from a compressed E00 file (they have 80
+ * characters at most)
+ */
+#define AVC_E00_MAX_LINE_LEN    1024
+
+typedef struct AVCE00InputInfo_t
+{
+    VSILFILE    *fp;
+    GBool       bCompressed;
+    int         nLineNo;        /* Lines returned so far        */
+
+    /* Block of the file, cut in lines in place: the bytes from
+     * iBlockPos to nBlockLen are not returned yet
+     */
+    char        *pszBlock;
+    int         nBlockSize;
+    int         nBlockLen;
+    int         iBlockPos;
+    GBool       bFileEOF;       /* Nothing more to read from fp */
+
+    /* Physical line of a compressed file being expanded, and the
+     * expanded line
+     */
+    const char  *pszInBuf;
+    int         iInBufPtr;
+    GBool       bEOF;
+    char        szOutBuf[AVC_E00_MAX_LINE_LEN+1];
+
+} *AVCE00InputPtr;
+
+/* Length of the lines of a compressed E00 file
+ */
+#define AVC_E00_COMPR_LINE_LEN  80
+
+typedef struct AVCE00Compressor_t
+{
+    int         nLines;         /* E00 lines compressed so far  */
+    GBool       bHeader;        /* szLine is the header to return */
+
+    /* Compressed stream not yet cut in lines
+     */
+    char        *pszBuf;
+    int         nBufLen;
+    int         nBufSize;
+
+    char        szLine[AVC_E00_MAX_LINE_LEN+1];
+
+} AVCE00Compressor;
+
 /*---------------------------------------------------------------------
  * Stuff related to the transparent binary -> E00 conversion
  *--------------------------------------------------------------------*/
@@ -462,6 +636,10 @@ typedef struct AVCE00ReadInfo_t
     int           iCurStep;  /* AVC_GEN_* values, see below */
     AVCE00GenInfo *hGenInfo;
 
+    /* Set by AVCE00ReadSetCompressed() to return compressed E00 lines
+     */
+    AVCE00Compressor *hCompressor;
+
 } *AVCE00ReadPtr;
 
 /* E00 generation steps... tells the AVCE00Read*() functions which
@@ -511,7 +689,8 @@ typedef struct AVCE00WriteInfo_t
  *--------------------------------------------------------------------*/
 AVCRawBinFile *AVCRawBinOpen(const char *pszFname, const char *pszAccess);
 void        AVCRawBinClose(AVCRawBinFile *psInfo);
-void        AVCRawBinFSeek(AVCRawBinFile *psInfo, int nOffset, int nFrom);
+void        AVCRawBinFSeek(AVCRawBinFile *psInfo, GIntBig nOffset, 
+                           int nFrom);
 GBool       AVCRawBinEOF(AVCRawBinFile *psInfo);
 
 void        AVCRawBinReadBytes(AVCRawBinFile *psInfo, int nBytesToRead, 
@@ -520,6 +699,24 @@ GInt16      AVCRawBinReadInt16(AVCRawBinFile *psInfo);
 GInt32      AVCRawBinReadInt32(AVCRawBinFile *psInfo);
 float       AVCRawBinReadFloat(AVCRawBinFile *psInfo);
 double      AVCRawBinReadDouble(AVCRawBinFile *psInfo);
+void        AVCRawBinReadInt32Array(AVCRawBinFile *psInfo, int numValues,
+                                    GInt32 *panValues);
+void        AVCRawBinReadFloatArrayToDouble(AVCRawBinFile *psInfo, 
+                                            int numValues, double *padValues);
+void        AVCRawBinReadDoubleArray(AVCRawBinFile *psInfo, int numValues,
+                                     double *padValues);
+
+GInt16      AVCRawBinDecodeInt16(const GByte *pabySrc);
+GInt32      AVCRawBinDecodeInt32(const GByte *pabySrc);
+float       AVCRawBinDecodeFloat(const GByte *pabySrc);
+double      AVCRawBinDecodeDouble(const GByte *pabySrc);
+void        AVCRawBinDecodeInt32Array(const GByte *pabySrc, int numValues,
+                                      GInt32 *panValues);
+void        AVCRawBinDecodeFloatArrayToDouble(const GByte *pabySrc, 
+                                              int numValues, 
+                                              double *padValues);
+void        AVCRawBinDecodeDoubleArray(const GByte *pabySrc, int numValues,
+                                       double *padValues);
 
 void        AVCRawBinWriteBytes(AVCRawBinFile *psFile, int nBytesToWrite,
                                 GByte *pBuf);
@@ -542,6 +739,17 @@ void        AVCBinReadClose(AVCBinFile *psFile);
 int         AVCBinReadRewind(AVCBinFile *psFile);
 
 void       *AVCBinReadNextObject(AVCBinFile *psFile);
+int         AVCBinReadNumObjects(AVCBinFile *psFile);
+void       *AVCBinReadObject(AVCBinFile *psFile, int iObjIndex);
+int         AVCBinReadObjects(AVCBinFile *psFile, int numObjects,
+                              const int *paiObjIndex,
+                              AVCBinReadObjectHandler pfnHandler,
+                              void *pUserData);
+AVCBinObjectPositions *AVCBinReadObjectPositions(AVCBinFile *psFile);
+void        AVCBinFreeObjectPositions(AVCBinObjectPositions *psPos);
+int         AVCBinReadObjectColumns(AVCBinFile *psFile, 
+                                    AVCBinObjectPositions *psPos,
+                                    void **papDest, int nThreads);
 AVCArc     *AVCBinReadNextArc(AVCBinFile *psFile);
 AVCPal     *AVCBinReadNextPal(AVCBinFile *psFile);
 AVCCnt     *AVCBinReadNextCnt(AVCBinFile *psFile);
@@ -550,6 +758,29 @@ AVCTol     *AVCBinReadNextTol(AVCBinFile *psFile);
 AVCTxt     *AVCBinReadNextTxt(AVCBinFile *psFile);
 AVCRxp     *AVCBinReadNextRxp(AVCBinFile *psFile);
 AVCField   *AVCBinReadNextTableRec(AVCBinFile *psFile);
+AVCField   *AVCBinReadTableRecAt(AVCBinFile *psFile, int iRow);
+AVCTableDecoder *AVCBinCompileTableDef(AVCTableDef *psTableDef);
+AVCTableDecoder *AVCBinCompileTableFields(AVCTableDef *psTableDef,
+                                          const int *panFields, 
+                                          int numFields);
+void        AVCBinFreeTableDecoder(AVCTableDecoder *psDecoder);
+int         AVCBinAddTableCondition(AVCTableDecoder *psDecoder,
+                                    AVCTableDef *psTableDef, int iField,
+                                    AVCCompareOp eOp, int numValues,
+                                    const double *padValues,
+                                    const char **papszValues);
+int         AVCBinReadTableRecords(AVCBinFile *psFile, 
+                                   AVCTableDecoder *psDecoder,
+                                   int numRecords, void **papDest,
+                                   int iFirstDest);
+int         AVCBinReadTableRecordsMT(AVCBinFile *psFile, 
+                                     AVCTableDecoder *psDecoder,
+                                     int numRecords, void **papDest,
+                                     int iFirstDest, int nThreads);
+int         AVCBinReadTableRecordsAt(AVCBinFile *psFile, 
+                                     AVCTableDecoder *psDecoder,
+                                     int numRows, const int *paiRows,
+                                     void **papDest, int iFirstDest);
 char      **AVCBinReadPrj(AVCBinFile *psFile);
 
 char      **AVCBinReadListTables(const char *pszInfoPath, 
@@ -608,9 +839,21 @@ const char *AVCE00GenTableRec(AVCE00GenInfo *psInfo, int numFields,
                               AVCFieldInfo *pasDef, AVCField *pasFields,
                               GBool bCont);
 
+/*---------------------------------------------------------------------
+ * Functions related to writing compressed E00
+ *--------------------------------------------------------------------*/
+AVCE00Compressor *AVCE00CompressorAlloc();
+void        AVCE00CompressorFree(AVCE00Compressor *psInfo);
+void        AVCE00CompressorReset(AVCE00Compressor *psInfo);
+void        AVCE00CompressLine(AVCE00Compressor *psInfo, const char *pszLine);
+const char *AVCE00CompressNextLine(AVCE00Compressor *psInfo, GBool bFlush);
+
 /*---------------------------------------------------------------------
  * Functions related to parsing E00 lines
  *--------------------------------------------------------------------*/
+int     AVCE00Str2Int(const char *pszStr, int numChars);
+double  AVCE00Str2Dbl(const char *pszStr, int numChars);
+
 AVCE00ParseInfo  *AVCE00ParseInfoAlloc();
 void    AVCE00ParseInfoFree(AVCE00ParseInfo *psInfo);
 void    AVCE00ParseReset(AVCE00ParseInfo  *psInfo);
@@ -624,20 +867,30 @@ AVCFileType AVCE00ParseSuperSectionHeader(AVCE00ParseInfo  *psInfo,
 GBool   AVCE00ParseSuperSectionEnd(AVCE00ParseInfo  *psInfo,
                                    const char *pszLine );
 
-void    *AVCE00ParseNextLine(AVCE00ParseInfo  *psInfo, const char *pszLine);
-AVCArc  *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCPal  *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCCnt  *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCLab  *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCTol  *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCTxt  *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCTxt  *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine);
-char   **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine);
-AVCRxp  *AVCE00ParseNextRxpLine(AVCE00ParseInfo *psInfo, const char *pszLine);
+void    *AVCE00ParseNextLine(AVCE00ParseInfo  *psInfo, const char *pszLine,
+                             int nLineLen);
+AVCArc  *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCPal  *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCCnt  *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCLab  *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCTol  *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCTxt  *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCTxt  *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+char   **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
+AVCRxp  *AVCE00ParseNextRxpLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                int nLineLen);
 AVCTableDef *AVCE00ParseNextTableDefLine(AVCE00ParseInfo *psInfo, 
-                                         const char *pszLine);
+                                         const char *pszLine, int nLineLen);
 AVCField    *AVCE00ParseNextTableRecLine(AVCE00ParseInfo *psInfo, 
-                                         const char *pszLine);
+                                         const char *pszLine, int nLineLen);
 
 
 /*---------------------------------------------------------------------
@@ -649,6 +902,12 @@ void _AVCDestroyTableFields(AVCTableDef *psTableDef, AVCField *pasFields);
 void _AVCDestroyTableDef(AVCTableDef *psTableDef);
 AVCTableDef *_AVCDupTableDef(AVCTableDef *psSrcDef);
 
+GInt32 _AVCParseFixInt(const char *pszStr, int nSize);
+double _AVCParseFixNum(const char *pszStr, int nSize);
+GBool  _AVCScalePow10(GUIntBig nMantissa, int nExp, double *pdValue);
+
+char *_AVCBinGetIndexFilename(const char *pszFname, AVCFileType eType);
+
 /*=====================================================================
               Function prototypes (THE PUBLIC ONES)
  =====================================================================*/
@@ -661,12 +920,23 @@ AVCE00ReadPtr   AVCE00ReadOpen(const char *pszCoverPath);
 void            AVCE00ReadClose(AVCE00ReadPtr psInfo);
 const char     *AVCE00ReadNextLine(AVCE00ReadPtr psInfo);
 int             AVCE00ReadRewind(AVCE00ReadPtr psInfo);
+void            AVCE00ReadSetCompressed(AVCE00ReadPtr psInfo, 
+                                        GBool bCompressed);
 
 AVCE00Section  *AVCE00ReadSectionsList(AVCE00ReadPtr psInfo, int *numSect);
 int             AVCE00ReadGotoSection(AVCE00ReadPtr psInfo, 
                                       AVCE00Section *psSect,
                                       GBool bContinue);
 
+/*---------------------------------------------------------------------
+ * Functions to read the lines of an E00 file, compressed or not
+ *--------------------------------------------------------------------*/
+
+AVCE00InputPtr  AVCE00InputOpen(VSILFILE *fp);
+void            AVCE00InputClose(AVCE00InputPtr psInfo);
+const char     *AVCE00InputNextLine(AVCE00InputPtr psInfo,
+                                    int *pnLineLen);
+
 /*---------------------------------------------------------------------
  * Functions to write E00 lines to a binary coverage
  *--------------------------------------------------------------------*/
@@ -674,7 +944,7 @@ int             AVCE00ReadGotoSection(AVCE00ReadPtr psInfo,
 AVCE00WritePtr  AVCE00WriteOpen(const char *pszCoverPath, int nPrecision);
 void            AVCE00WriteClose(AVCE00WritePtr psInfo);
 int             AVCE00WriteNextLine(AVCE00WritePtr psInfo, 
-                                    const char *pszLine);
+                                    const char *pszLine, int nLineLen);
 int             AVCE00DeleteCoverage(const char *pszCoverPath);
 
 CPL_C_END
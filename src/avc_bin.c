@@ -63,6 +63,18 @@
 #include "avc.h"
 
 #include <ctype.h>      /* for isspace() */
+#include <limits.h>     /* for INT_MAX */
+
+/*---------------------------------------------------------------------
+ * Tables can be decoded by several threads when the platform supports
+ * it (see AVCBinReadTableRecordsMT()).  Define AVC_NO_THREADS to always
+ * decode them in the calling thread.
+ *--------------------------------------------------------------------*/
+#if !defined(WIN32) && !defined(AVC_NO_THREADS)
+#  define AVC_USE_THREADS
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
 
 /*=====================================================================
  * Stuff related to reading the binary coverage files
@@ -96,6 +108,8 @@ AVCBinFile *AVCBinReadOpen(const char *pszPath, const char *pszName,
                            AVCFileType eType)
 {
     AVCBinFile   *psFile;
+    char         *pszIndexName;
+    VSIStatBufL  sStatBuf;
 
     /*-----------------------------------------------------------------
      * The case of INFO tables is a bit more complicated...
@@ -138,6 +152,18 @@ AVCBinFile *AVCBinReadOpen(const char *pszPath, const char *pszName,
         return NULL;
     }
 
+    /*-----------------------------------------------------------------
+     * Open the index file (arx, pax, cnx, txx) if there is one for
+     * this file type.  It is optional: without it we just can't use
+     * AVCBinReadObject().
+     *----------------------------------------------------------------*/
+    pszIndexName = _AVCBinGetIndexFilename(psFile->pszFilename, eType);
+    if (pszIndexName && VSIStatL(pszIndexName, &sStatBuf) == 0)
+    {
+        psFile->psIndexFile = AVCRawBinOpen(pszIndexName, "r");
+    }
+    CPLFree(pszIndexName);
+
     /*-----------------------------------------------------------------
      * Read the header, and set the precision field if applicable
      *----------------------------------------------------------------*/
@@ -199,6 +225,12 @@ void    AVCBinReadClose(AVCBinFile *psFile)
     AVCRawBinClose(psFile->psRawBinFile);
     psFile->psRawBinFile = NULL;
 
+    if (psFile->psIndexFile)
+    {
+        AVCRawBinClose(psFile->psIndexFile);
+        psFile->psIndexFile = NULL;
+    }
+
     CPLFree(psFile->pszFilename);
     psFile->pszFilename = NULL;
 
@@ -417,6 +449,297 @@ void *AVCBinReadNextObject(AVCBinFile *psFile)
 
 
 
+/**********************************************************************
+ *                          _AVCBinGetIndexFilename()
+ *
+ * (This function is for internal library use)
+ *
+ * Return the name of the index file that goes with the data file 
+ * pszFname, i.e. arx/pax/cnx/txx for arc/pal/cnt/txt files, or NULL if
+ * this type of file has no index.
+ *
+ * Yep, we'll have a problem if filenames come in as uppercase, but
+ * this should not happen in a normal situation.
+ *
+ * The returned string should be freed with CPLFree().
+ **********************************************************************/
+char *_AVCBinGetIndexFilename(const char *pszFname, AVCFileType eType)
+{
+    char        *pszIndexName, *pszExt = NULL;
+    const char  *pszIndexExt = NULL;
+    int         nLen;
+
+    pszIndexName = CPLStrdup(pszFname);
+    nLen = strlen(pszIndexName);
+
+    if (eType == AVCFileARC &&
+        ( (nLen>=4 && EQUALN((pszExt=pszIndexName+nLen-3)-1, ".arc", 4)) ||
+          (nLen>=7 && EQUALN((pszExt=pszIndexName+nLen-7), "arc.adf", 7)) ))
+    {
+        pszIndexExt = "arx";
+    }
+    else if ((eType == AVCFilePAL || eType == AVCFileRPL) &&
+         ( (nLen>=4 && EQUALN((pszExt=pszIndexName+nLen-3)-1, ".pal", 4)) ||
+           (nLen>=7 && EQUALN((pszExt=pszIndexName+nLen-7), "pal.adf", 7)) ))
+    {
+        pszIndexExt = "pax";
+    }
+    else if (eType == AVCFileCNT &&
+         ( (nLen>=4 && EQUALN((pszExt=pszIndexName+nLen-3)-1, ".cnt", 4)) ||
+           (nLen>=7 && EQUALN((pszExt=pszIndexName+nLen-7), "cnt.adf", 7)) ))
+    {
+        pszIndexExt = "cnx";
+    }
+    else if ((eType == AVCFileTXT || eType == AVCFileTX6) &&
+         ( (nLen>=4 && EQUALN((pszExt=pszIndexName+nLen-3)-1, ".txt", 4)) ||
+           (nLen>=7 && EQUALN((pszExt=pszIndexName+nLen-7), "txt.adf", 7)) ))
+    {
+        pszIndexExt = "txx";
+    }
+
+    if (pszIndexExt == NULL)
+    {
+        CPLFree(pszIndexName);
+        return NULL;
+    }
+
+    memcpy(pszExt, pszIndexExt, 3);
+
+    return pszIndexName;
+}
+
+/**********************************************************************
+ *                          _AVCBinNumIndexEntries()
+ *
+ * (This function is for internal library use)
+ *
+ * Return the number of entries in an index file.
+ *
+ * Index files have the usual 100 bytes header followed by one 
+ * (position, size) pair of int32 per object, both in 2 byte words.
+ **********************************************************************/
+static int _AVCBinNumIndexEntries(AVCRawBinFile *psIndexFile)
+{
+    int nLength;
+
+    /* Overall index file length (in 2 byte words) is in the header
+     */
+    AVCRawBinFSeek(psIndexFile, 24, SEEK_SET);
+    nLength = AVCRawBinReadInt32(psIndexFile);
+
+    return (int)MAX(0, ((GIntBig)nLength*2 - 100)/8);
+}
+
+/**********************************************************************
+ *                          _AVCBinReadIndexEntry()
+ *
+ * (This function is for internal library use)
+ *
+ * Read the index entry of object iObjIndex (1-based) and return the
+ * position of the object in the data file, in bytes.
+ *
+ * Returns -1 if the object is not in the index.
+ **********************************************************************/
+static GIntBig _AVCBinReadIndexEntry(AVCRawBinFile *psIndexFile, 
+                                     int iObjIndex)
+{
+    int nPosition;
+
+    if (iObjIndex < 1 || iObjIndex > _AVCBinNumIndexEntries(psIndexFile))
+        return -1;
+
+    AVCRawBinFSeek(psIndexFile, 100 + (GIntBig)(iObjIndex-1)*8, SEEK_SET);
+    nPosition = AVCRawBinReadInt32(psIndexFile);
+
+    if (nPosition < 50)
+        return -1;
+
+    return (GIntBig)nPosition*2;
+}
+
+/**********************************************************************
+ *                          AVCBinReadNumObjects()
+ *
+ * Return the number of objects in the file when it can be found 
+ * without reading them: from the index file for ARC/PAL/CNT/TXT, from 
+ * the file size for files made of fixed size records (LAB, TOL), or 
+ * from the table definition for tables.
+ *
+ * Returns -1 if the number of objects is not known, in which case the
+ * only way to find it is to read all the objects.
+ **********************************************************************/
+int AVCBinReadNumObjects(AVCBinFile *psFile)
+{
+    VSIStatBufL sStatBuf;
+    int         nHeaderSize = 100, nRecSize;
+
+    if (psFile->eFileType == AVCFileTABLE)
+        return psFile->hdr.psTableDef->numRecords;
+
+    if (psFile->psIndexFile)
+        return _AVCBinNumIndexEntries(psFile->psIndexFile);
+
+    if (psFile->eFileType == AVCFileLAB)
+    {
+        /* nValue, nPolyId, and 3 x,y pairs */
+        nRecSize = (psFile->nPrecision == AVC_SINGLE_PREC) ? 32 : 56;
+    }
+    else if (psFile->eFileType == AVCFileTOL)
+    {
+        /* nIndex, nFlag, and dValue... single precision tol.adf 
+         * files have no header (see AVCBinReadRewind())
+         */
+        if (psFile->nPrecision == AVC_SINGLE_PREC)
+        {
+            nHeaderSize = 0;
+            nRecSize = 12;
+        }
+        else
+            nRecSize = 16;
+    }
+    else
+        return -1;
+
+    if (VSIStatL(psFile->pszFilename, &sStatBuf) != 0)
+        return -1;
+
+    return (int)MIN(MAX(0, ((GIntBig)sStatBuf.st_size - nHeaderSize)/
+                           nRecSize), INT_MAX);
+}
+
+/**********************************************************************
+ *                          AVCBinReadObject()
+ *
+ * Read the object with index iObjIndex (1-based, i.e. the iObjIndex'th
+ * object in the file, which is also its ArcId, PolyId, ...) from an
+ * ARC, PAL, CNT or TXT file by looking up its position in the index
+ * file, without reading the objects that come before.
+ *
+ * After this call, AVCBinReadNextObject() continues with the object
+ * that follows the one that was read.
+ *
+ * Returns a (void*) to a static structure as AVCBinReadNextObject() 
+ * does, or NULL if the file has no index, if the object is not in the
+ * index, or if an error happened.
+ **********************************************************************/
+void *AVCBinReadObject(AVCBinFile *psFile, int iObjIndex)
+{
+    GIntBig nPosition;
+
+    if (psFile->psIndexFile == NULL)
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "AVCBinReadObject(): No index file for %s.", 
+                 psFile->pszFilename);
+        return NULL;
+    }
+
+    if ((nPosition = _AVCBinReadIndexEntry(psFile->psIndexFile, 
+                                           iObjIndex)) == -1)
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "AVCBinReadObject(): Object %d not found in index of %s.",
+                 iObjIndex, psFile->pszFilename);
+        return NULL;
+    }
+
+    AVCRawBinFSeek(psFile->psRawBinFile, nPosition, SEEK_SET);
+
+    return AVCBinReadNextObject(psFile);
+}
+
+/**********************************************************************
+ *                          AVCBinReadObjects()
+ *
+ * Batched version of AVCBinReadObject(): read the numObjects objects
+ * whose indexes are in paiObjIndex[] and pass each of them to 
+ * pfnHandler() together with its position in paiObjIndex[] and 
+ * pUserData.
+ *
+ * All the index entries are looked up first, and the objects are then
+ * read in the order in which they appear in the data file (not the 
+ * order of paiObjIndex[]) so that the data file is only read forward.
+ * The object passed to pfnHandler() is only valid during the call.
+ *
+ * Returns the number of objects read, or -1 if the file has no index,
+ * if one of the objects is not in the index or if an error happened.
+ **********************************************************************/
+typedef struct AVCBinIndexPos_t
+{
+    GIntBig     nPosition;
+    int         iPos;
+}AVCBinIndexPos;
+
+static int _AVCBinCompareIndexPos(const void *p1, const void *p2)
+{
+    const AVCBinIndexPos *ps1 = (const AVCBinIndexPos *)p1;
+    const AVCBinIndexPos *ps2 = (const AVCBinIndexPos *)p2;
+
+    if (ps1->nPosition != ps2->nPosition)
+        return (ps1->nPosition < ps2->nPosition) ? -1 : 1;
+
+    return ps1->iPos - ps2->iPos;
+}
+
+int AVCBinReadObjects(AVCBinFile *psFile, int numObjects, 
+                      const int *paiObjIndex, 
+                      AVCBinReadObjectHandler pfnHandler, void *pUserData)
+{
+    AVCBinIndexPos *pasPos;
+    void           *psObj;
+    int            i, numRead = 0;
+
+    if (psFile->psIndexFile == NULL)
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "AVCBinReadObjects(): No index file for %s.", 
+                 psFile->pszFilename);
+        return -1;
+    }
+
+    if (numObjects <= 0)
+        return 0;
+
+    pasPos = (AVCBinIndexPos*)CPLMalloc(numObjects*sizeof(AVCBinIndexPos));
+
+    for(i=0; i<numObjects; i++)
+    {
+        pasPos[i].iPos = i;
+        if ((pasPos[i].nPosition = 
+             _AVCBinReadIndexEntry(psFile->psIndexFile, 
+                                   paiObjIndex[i])) == -1)
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "AVCBinReadObjects(): Object %d not found in index "
+                     "of %s.", paiObjIndex[i], psFile->pszFilename);
+            CPLFree(pasPos);
+            return -1;
+        }
+    }
+
+    qsort(pasPos, numObjects, sizeof(AVCBinIndexPos), 
+          _AVCBinCompareIndexPos);
+
+    for(i=0; i<numObjects; i++)
+    {
+        AVCRawBinFSeek(psFile->psRawBinFile, pasPos[i].nPosition, SEEK_SET);
+
+        if ((psObj = AVCBinReadNextObject(psFile)) == NULL)
+        {
+            numRead = -1;
+            break;
+        }
+
+        pfnHandler(psObj, pasPos[i].iPos, pUserData);
+        numRead++;
+    }
+
+    CPLFree(pasPos);
+
+    return numRead;
+}
+
+
 /*=====================================================================
  *                              ARC
  *====================================================================*/
@@ -438,7 +761,7 @@ void *AVCBinReadNextObject(AVCBinFile *psFile)
 int _AVCBinReadNextArc(AVCRawBinFile *psFile, AVCArc *psArc,
                               int nPrecision)
 {
-    int         i, numVertices;
+    int         numVertices;
 
     psArc->nArcId  = AVCRawBinReadInt32(psFile);
     if (AVCRawBinEOF(psFile))
@@ -463,23 +786,15 @@ int _AVCBinReadNextArc(AVCRawBinFile *psFile, AVCArc *psArc,
 
     psArc->numVertices = numVertices;
 
+    /* The x,y pairs are read in one pass as an array of 2*numVertices
+     * doubles, AVCVertex being made of 2 doubles.
+     */
     if (nPrecision == AVC_SINGLE_PREC)
-    {
-        for(i=0; i<numVertices; i++)
-        {
-            psArc->pasVertices[i].x = AVCRawBinReadFloat(psFile);
-            psArc->pasVertices[i].y = AVCRawBinReadFloat(psFile);
-        }
-    }
+        AVCRawBinReadFloatArrayToDouble(psFile, 2*numVertices,
+                                        (double*)psArc->pasVertices);
     else
-    {
-        for(i=0; i<numVertices; i++)
-        {
-            psArc->pasVertices[i].x = AVCRawBinReadDouble(psFile);
-            psArc->pasVertices[i].y = AVCRawBinReadDouble(psFile);
-        }
-
-    }
+        AVCRawBinReadDoubleArray(psFile, 2*numVertices,
+                                 (double*)psArc->pasVertices);
 
     return 0;
 }
@@ -528,7 +843,7 @@ AVCArc *AVCBinReadNextArc(AVCBinFile *psFile)
 int _AVCBinReadNextPal(AVCRawBinFile *psFile, AVCPal *psPal, 
                               int nPrecision)
 {
-    int i, numArcs;
+    int numArcs;
 
     psPal->nPolyId = AVCRawBinReadInt32(psFile);
                      AVCRawBinReadInt32(psFile);  /* Skip Record size field */
@@ -562,12 +877,9 @@ int _AVCBinReadNextPal(AVCRawBinFile *psFile, AVCPal *psPal,
 
     psPal->numArcs = numArcs;
 
-    for(i=0; i<numArcs; i++)
-    {
-        psPal->pasArcs[i].nArcId = AVCRawBinReadInt32(psFile);
-        psPal->pasArcs[i].nFNode = AVCRawBinReadInt32(psFile);
-        psPal->pasArcs[i].nAdjPoly = AVCRawBinReadInt32(psFile);
-    }
+    /* Each AVCPalArc is made of 3 GInt32: ArcId, FNode, AdjPoly
+     */
+    AVCRawBinReadInt32Array(psFile, 3*numArcs, (GInt32*)psPal->pasArcs);
 
     return 0;
 }
@@ -596,117 +908,686 @@ AVCPal *AVCBinReadNextPal(AVCBinFile *psFile)
 
 
 /*=====================================================================
- *                              CNT
+ *                         ARC and PAL columns
  *====================================================================*/
 
 /**********************************************************************
- *                          _AVCBinReadNextCnt()
+ *                          _AVCBinObjectSize()
  *
- * (This function is for internal library use... external calls should
- * go to AVCBinReadNextCnt() instead)
- *
- * Read the next CNT (Polygon Centroid) structure from the file.
+ * (This function is for internal library use)
  *
- * Returns 0 on success or -1 on error.
+ * Size in bytes of an ARC or PAL (or RPL) record with nCount vertices 
+ * or arcs, as read by _AVCBinReadNextArc() and _AVCBinReadNextPal(), 
+ * and offset of the count in the record (*pnCountOffset).
  **********************************************************************/
-int _AVCBinReadNextCnt(AVCRawBinFile *psFile, AVCCnt *psCnt, 
-                              int nPrecision)
+static GIntBig _AVCBinObjectSize(AVCFileType eType, int nPrecision,
+                                 int nCount, int *pnCountOffset)
 {
-    int i, numLabels;
-
-    psCnt->nPolyId = AVCRawBinReadInt32(psFile);
-                     AVCRawBinReadInt32(psFile); /* Skip Record size field */
-
-    if (AVCRawBinEOF(psFile))
-        return -1;
+    int nCoordSize = (nPrecision == AVC_SINGLE_PREC) ? 4 : 8;
 
-    if (nPrecision == AVC_SINGLE_PREC)
-    {
-        psCnt->sCoord.x  = AVCRawBinReadFloat(psFile);
-        psCnt->sCoord.y  = AVCRawBinReadFloat(psFile);
-    }
-    else
+    if (eType == AVCFileARC)
     {
-        psCnt->sCoord.x  = AVCRawBinReadDouble(psFile);
-        psCnt->sCoord.y  = AVCRawBinReadDouble(psFile);
+        /* ArcId, RecSize, UserId, FNode, TNode, LPoly, RPoly, and 
+         * numVertices followed by the x,y pairs
+         */
+        if (pnCountOffset)
+            *pnCountOffset = 28;
+        return 32 + (GIntBig)nCount*2*nCoordSize;
     }
 
-    numLabels      = AVCRawBinReadInt32(psFile);
-
-    /* Realloc the LabelIds array only if it needs to grow...
-     * do not realloc to a smaller size.
+    /* PolyId, RecSize, the Min and Max x,y and numArcs followed by 
+     * the ArcId, FNode, AdjPoly triplets
      */
-    if (psCnt->panLabelIds == NULL || numLabels > psCnt->numLabels)
-        psCnt->panLabelIds = (GInt32 *)CPLRealloc(psCnt->panLabelIds,
-                                                  numLabels*sizeof(GInt32));
-
-    psCnt->numLabels = numLabels;
-
-    for(i=0; i<numLabels; i++)
-    {
-        psCnt->panLabelIds[i] = AVCRawBinReadInt32(psFile);
-    }
-
-    return 0;
+    if (pnCountOffset)
+        *pnCountOffset = 8 + 4*nCoordSize;
+    return 12 + 4*nCoordSize + (GIntBig)nCount*12;
 }
 
 /**********************************************************************
- *                          AVCBinReadNextCnt()
+ *                          _AVCBinIndexPositions()
  *
- * Read the next CNT structure from the file.
+ * (This function is for internal library use)
  *
- * Returns a pointer to a static AVCCnt structure whose contents will be
- * valid only until the next call or NULL if an error happened or if EOF
- * was reached.  
+ * Fill psPos with the positions of the records found in the index file
+ * (arx.adf, pax.adf) and the counts that follow from the size of the 
+ * records in the index.  The records in the index must follow each 
+ * other up to the end of the data file (nFileSize), which is where 
+ * AVCBinReadNextObject() would find them.
+ *
+ * Returns FALSE if the index cannot be used.
  **********************************************************************/
-AVCCnt *AVCBinReadNextCnt(AVCBinFile *psFile)
+static GBool _AVCBinIndexPositions(AVCBinFile *psFile, GIntBig nFileSize,
+                                   AVCBinObjectPositions *psPos)
 {
-    if (psFile->eFileType != AVCFileCNT ||
-        AVCRawBinEOF(psFile->psRawBinFile) ||
-        _AVCBinReadNextCnt(psFile->psRawBinFile, psFile->cur.psCnt,
-                           psFile->nPrecision) !=0)
+    AVCRawBinFile *psIndexFile = psFile->psIndexFile;
+    VSIStatBufL sStatBuf;
+    GInt32      *panEntries;
+    GIntBig     nPos = 100, nStart = 0;
+    int         i, n, nBaseSize, nItemSize;
+
+    n = _AVCBinNumIndexEntries(psIndexFile);
+
+    /* The entries must be in the index file, or reading them fails 
+     * with an error instead of falling back to the data file
+     */
+    if (VSIStatL(psIndexFile->pszFname, &sStatBuf) != 0 ||
+        (GIntBig)sStatBuf.st_size < 100 + (GIntBig)n*8)
+        return FALSE;
+
+    nBaseSize = (int)_AVCBinObjectSize(psFile->eFileType, 
+                                       psFile->nPrecision, 0, NULL);
+    nItemSize = (int)_AVCBinObjectSize(psFile->eFileType, 
+                                       psFile->nPrecision, 1, NULL) - 
+                nBaseSize;
+
+    panEntries = (GInt32*)CPLMalloc(MAX(1, 2*n)*sizeof(GInt32));
+
+    AVCRawBinFSeek(psIndexFile, 100, SEEK_SET);
+    AVCRawBinReadInt32Array(psIndexFile, 2*n, panEntries);
+
+    for(i=0; i<n; i++)
     {
-        return NULL;
+        /* Position and size of the record (past its first 8 bytes), 
+         * in 2 byte words
+         */
+        GIntBig nSize = (GIntBig)panEntries[2*i+1]*2 + 8;
+
+        if ((GIntBig)panEntries[2*i]*2 != nPos || nSize < nBaseSize ||
+            (nSize - nBaseSize) % nItemSize != 0)
+            break;
+
+        psPos->panPosition[i] = nPos;
+        psPos->panCount[i] = (int)((nSize - nBaseSize)/nItemSize);
+        psPos->panStart[i] = (int)nStart;
+
+        nPos += nSize;
+        nStart += psPos->panCount[i];
+
+        if (nPos > nFileSize || nStart > INT_MAX)
+            break;
     }
 
-    return psFile->cur.psCnt;
-}
+    CPLFree(panEntries);
 
+    if (i < n || nPos != nFileSize)
+        return FALSE;
 
-/*=====================================================================
- *                              LAB
- *====================================================================*/
+    psPos->numObjects = n;
+    psPos->panStart[n] = (int)nStart;
+
+    return TRUE;
+}
 
 /**********************************************************************
- *                          _AVCBinReadNextLab()
+ *                          AVCBinReadObjectPositions()
  *
- * (This function is for internal library use... external calls should
- * go to AVCBinReadNextLab() instead)
+ * Find where the records of an ARC or PAL file are and how many 
+ * vertices or arcs each one has, without decoding them, so that they 
+ * can then be decoded in any order (see AVCBinReadObjectColumns()).
  *
- * Read the next LAB (Centroid Label) structure from the file.
+ * They are taken from the index file (arx.adf, pax.adf) when there is 
+ * one and it matches the data file.  Otherwise the file is scanned 
+ * reading only the count in the header of each record, which gives the
+ * position of the next one.  The current position of the file is kept.
  *
- * Returns 0 on success or -1 on error.
+ * Returns a new AVCBinObjectPositions, to be released with
+ * AVCBinFreeObjectPositions(), or NULL if the file is not an ARC or PAL
+ * file or if the records do not make up the whole file, in which case
+ * they must be read with AVCBinReadNextObject().
  **********************************************************************/
-int _AVCBinReadNextLab(AVCRawBinFile *psFile, AVCLab *psLab, 
-                              int nPrecision)
+AVCBinObjectPositions *AVCBinReadObjectPositions(AVCBinFile *psFile)
 {
+    AVCRawBinFile *psRaw = psFile->psRawBinFile;
+    AVCBinObjectPositions *psPos;
+    VSIStatBufL sStatBuf;
+    GIntBig     nPos, nStart, nFileSize, nSavedPos;
+    int         n, nMax, nCount, nCountOffset;
+    GBool       bMapped;
+
+    if (psFile->eFileType != AVCFileARC && psFile->eFileType != AVCFilePAL &&
+        psFile->eFileType != AVCFileRPL)
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "AVCBinReadObjectPositions(): %s is not an ARC or PAL "
+                 "file.", psFile->pszFilename);
+        return NULL;
+    }
 
-    psLab->nValue  = AVCRawBinReadInt32(psFile);
-    psLab->nPolyId = AVCRawBinReadInt32(psFile);
+    if (psRaw == NULL || VSIStatL(psFile->pszFilename, &sStatBuf) != 0)
+        return NULL;
 
-    if (AVCRawBinEOF(psFile))
-        return -1;
+    nFileSize = (GIntBig)sStatBuf.st_size;
+    nMax = (int)MIN(nFileSize/32 + 1, INT_MAX - 1);
 
-    if (nPrecision == AVC_SINGLE_PREC)
+    psPos = (AVCBinObjectPositions*)CPLCalloc(1, 
+                                              sizeof(AVCBinObjectPositions));
+
+    if (psFile->psIndexFile)
     {
-        psLab->sCoord1.x  = AVCRawBinReadFloat(psFile);
-        psLab->sCoord1.y  = AVCRawBinReadFloat(psFile);
-        psLab->sCoord2.x  = AVCRawBinReadFloat(psFile);
-        psLab->sCoord2.y  = AVCRawBinReadFloat(psFile);
-        psLab->sCoord3.x  = AVCRawBinReadFloat(psFile);
-        psLab->sCoord3.y  = AVCRawBinReadFloat(psFile);
+        n = _AVCBinNumIndexEntries(psFile->psIndexFile);
+        if (n <= nMax)
+        {
+            psPos->panPosition = (GIntBig*)CPLMalloc(MAX(1, n)*
+                                                     sizeof(GIntBig));
+            psPos->panCount = (int*)CPLMalloc(MAX(1, n)*sizeof(int));
+            psPos->panStart = (int*)CPLMalloc((n+1)*sizeof(int));
+
+            if (_AVCBinIndexPositions(psFile, nFileSize, psPos))
+                return psPos;
+        }
+
+        AVCBinFreeObjectPositions(psPos);
+        psPos = (AVCBinObjectPositions*)CPLCalloc(1, 
+                                              sizeof(AVCBinObjectPositions));
     }
-    else
+
+    /* No (usable) index: follow the records from the end of the header.
+     * The whole file is in memory when it is mapped; otherwise only the 
+     * counts are read.
+     */
+    nSavedPos = psRaw->nOffset + psRaw->nCurPos;
+    bMapped = (psRaw->nOffset == 0 && psRaw->nCurSize >= nFileSize);
+
+    _AVCBinObjectSize(psFile->eFileType, psFile->nPrecision, 0, 
+                      &nCountOffset);
+
+    for(n=0, nMax=0, nPos=100, nStart=0; nPos < nFileSize; n++)
+    {
+        if (nPos + nCountOffset + 4 > nFileSize || nStart > INT_MAX)
+            break;
+
+        if (bMapped)
+            nCount = AVCRawBinDecodeInt32(psRaw->pabyBuf + nPos + 
+                                          nCountOffset);
+        else
+        {
+            AVCRawBinFSeek(psRaw, nPos + nCountOffset, SEEK_SET);
+            nCount = AVCRawBinReadInt32(psRaw);
+        }
+
+        if (nCount < 0)
+            break;
+
+        if (n == nMax)
+        {
+            nMax = MAX(2*nMax, 1024);
+            psPos->panPosition = (GIntBig*)CPLRealloc(psPos->panPosition,
+                                                      nMax*sizeof(GIntBig));
+            psPos->panCount = (int*)CPLRealloc(psPos->panCount,
+                                               nMax*sizeof(int));
+            psPos->panStart = (int*)CPLRealloc(psPos->panStart,
+                                               (nMax+1)*sizeof(int));
+        }
+
+        psPos->panPosition[n] = nPos;
+        psPos->panCount[n] = nCount;
+        psPos->panStart[n] = (int)nStart;
+
+        nPos += _AVCBinObjectSize(psFile->eFileType, psFile->nPrecision,
+                                  nCount, NULL);
+        nStart += nCount;
+    }
+
+    if (!bMapped)
+        AVCRawBinFSeek(psRaw, nSavedPos, SEEK_SET);
+
+    if (nPos != nFileSize || nStart > INT_MAX)
+    {
+        AVCBinFreeObjectPositions(psPos);
+        return NULL;
+    }
+
+    if (psPos->panStart == NULL)
+        psPos->panStart = (int*)CPLMalloc(sizeof(int));
+
+    psPos->numObjects = n;
+    psPos->panStart[n] = (int)nStart;
+
+    return psPos;
+}
+
+/**********************************************************************
+ *                          AVCBinFreeObjectPositions()
+ *
+ * Release an AVCBinObjectPositions from AVCBinReadObjectPositions().
+ **********************************************************************/
+void AVCBinFreeObjectPositions(AVCBinObjectPositions *psPos)
+{
+    if (psPos == NULL)
+        return;
+
+    CPLFree(psPos->panPosition);
+    CPLFree(psPos->panCount);
+    CPLFree(psPos->panStart);
+    CPLFree(psPos);
+}
+
+/**********************************************************************
+ *                          _AVCBinDecodeObject()
+ *
+ * (This function is for internal library use)
+ *
+ * Decode the record iObj of an ARC or PAL file from pabyRec into the
+ * columns of papDest (see AVCBinReadObjectColumns()).
+ *
+ * Returns FALSE if the count in the record is not the expected one.
+ **********************************************************************/
+static GBool _AVCBinDecodeObject(AVCFileType eType, int nPrecision,
+                                 const GByte *pabyRec, 
+                                 AVCBinObjectPositions *psPos, int iObj,
+                                 void **papDest)
+{
+    int     j, nCount = psPos->panCount[iObj], nCountOffset;
+    int     nCoordSize = (nPrecision == AVC_SINGLE_PREC) ? 4 : 8;
+    double  *padX, *padY;
+    GInt32  *panArcId, *panFNode, *panAdjPoly;
+
+    _AVCBinObjectSize(eType, nPrecision, 0, &nCountOffset);
+
+    if (AVCRawBinDecodeInt32(pabyRec + nCountOffset) != nCount)
+        return FALSE;
+
+    if (eType == AVCFileARC)
+    {
+        ((GInt32*)papDest[0])[iObj] = AVCRawBinDecodeInt32(pabyRec);
+        for(j=1; j<6; j++)
+            ((GInt32*)papDest[j])[iObj] = 
+                                    AVCRawBinDecodeInt32(pabyRec + 4 + 4*j);
+        ((GInt32*)papDest[6])[iObj] = nCount;
+
+        padX = (double*)papDest[7] + psPos->panStart[iObj];
+        padY = (double*)papDest[8] + psPos->panStart[iObj];
+        pabyRec += 32;
+
+        if (nPrecision == AVC_SINGLE_PREC)
+        {
+            for(j=0; j<nCount; j++, pabyRec+=8)
+            {
+                padX[j] = AVCRawBinDecodeFloat(pabyRec);
+                padY[j] = AVCRawBinDecodeFloat(pabyRec+4);
+            }
+        }
+        else
+        {
+            for(j=0; j<nCount; j++, pabyRec+=16)
+            {
+                padX[j] = AVCRawBinDecodeDouble(pabyRec);
+                padY[j] = AVCRawBinDecodeDouble(pabyRec+8);
+            }
+        }
+
+        return TRUE;
+    }
+
+    ((GInt32*)papDest[0])[iObj] = AVCRawBinDecodeInt32(pabyRec);
+    for(j=1; j<5; j++)
+    {
+        ((double*)papDest[j])[iObj] = (nPrecision == AVC_SINGLE_PREC) ?
+            AVCRawBinDecodeFloat(pabyRec + 8 + (j-1)*nCoordSize) :
+            AVCRawBinDecodeDouble(pabyRec + 8 + (j-1)*nCoordSize);
+    }
+    ((GInt32*)papDest[5])[iObj] = nCount;
+
+    panArcId = (GInt32*)papDest[6] + psPos->panStart[iObj];
+    panFNode = (GInt32*)papDest[7] + psPos->panStart[iObj];
+    panAdjPoly = (GInt32*)papDest[8] + psPos->panStart[iObj];
+    pabyRec += nCountOffset + 4;
+
+    for(j=0; j<nCount; j++, pabyRec+=12)
+    {
+        panArcId[j] = AVCRawBinDecodeInt32(pabyRec);
+        panFNode[j] = AVCRawBinDecodeInt32(pabyRec+4);
+        panAdjPoly[j] = AVCRawBinDecodeInt32(pabyRec+8);
+    }
+
+    return TRUE;
+}
+
+/**********************************************************************
+ *                          _AVCBinObjectWorker()
+ *
+ * A range of records decoded by one of the threads of
+ * AVCBinReadObjectColumns(): either from the whole file in memory
+ * (pabyData) or with its own file (psRaw).  As _AVCBinTableWorker(), 
+ * it reports its errors with its result only: they are kept quiet in 
+ * the thread, since the default error handler must not be called from
+ * other threads than the main one.
+ **********************************************************************/
+typedef struct AVCBinObjectWorker_t
+{
+    AVCFileType eType;
+    int         nPrecision;
+    AVCBinObjectPositions *psPos;
+    const GByte *pabyData;      /* Whole file, if mapped                */
+    AVCRawBinFile *psRaw;       /* Otherwise, file to read the range    */
+    int         iFirst;         /* Records iFirst to iLast-1            */
+    int         iLast;
+    void        **papDest;
+    GBool       bDone;
+}AVCBinObjectWorker;
+
+static void *_AVCBinObjectWorker(void *pArg)
+{
+    AVCBinObjectWorker *psWorker = (AVCBinObjectWorker *)pArg;
+    AVCBinObjectPositions *psPos = psWorker->psPos;
+    GByte   *pabyBuf = NULL, *pabyNewBuf;
+    const GByte *pabyRec;
+    int     i, nSize, nBufSize = 0;
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+
+    if (psWorker->psRaw && psWorker->iFirst < psWorker->iLast)
+        AVCRawBinFSeek(psWorker->psRaw, 
+                       psPos->panPosition[psWorker->iFirst], SEEK_SET);
+
+    for(i=psWorker->iFirst; i<psWorker->iLast; i++)
+    {
+        if (psWorker->pabyData)
+            pabyRec = psWorker->pabyData + psPos->panPosition[i];
+        else
+        {
+            /* The records follow each other, so they are read in turn */
+            nSize = (int)_AVCBinObjectSize(psWorker->eType, 
+                                           psWorker->nPrecision,
+                                           psPos->panCount[i], NULL);
+            if (nSize > nBufSize)
+            {
+                if ((pabyNewBuf = (GByte*)VSIRealloc(pabyBuf, nSize)) == NULL)
+                    break;
+                pabyBuf = pabyNewBuf;
+                nBufSize = nSize;
+            }
+
+            AVCRawBinReadBytes(psWorker->psRaw, nSize, pabyBuf);
+            if (psWorker->psRaw->nOffset + psWorker->psRaw->nCurPos <
+                psPos->panPosition[i] + nSize)
+                break;
+
+            pabyRec = pabyBuf;
+        }
+
+        if (!_AVCBinDecodeObject(psWorker->eType, psWorker->nPrecision,
+                                 pabyRec, psPos, i, psWorker->papDest))
+            break;
+    }
+
+    psWorker->bDone = (i == psWorker->iLast);
+
+    VSIFree(pabyBuf);
+
+    CPLPopErrorHandler();
+
+    return NULL;
+}
+
+#ifdef AVC_USE_THREADS
+/* Start routine of the threads of AVCBinReadObjectColumns() */
+static void *_AVCBinObjectThread(void *pArg)
+{
+    CPLSetWorkerThread();
+
+    return _AVCBinObjectWorker(pArg);
+}
+#endif
+
+/**********************************************************************
+ *                          AVCBinReadObjectColumns()
+ *
+ * Decode all the records of an ARC or PAL file, whose positions come 
+ * from AVCBinReadObjectPositions(), into columns: record i goes to 
+ * position i of the columns of the records, and its vertices or arcs 
+ * to positions psPos->panStart[i] to psPos->panStart[i+1]-1 of the 
+ * columns of the vertices or arcs, i.e. in the same order as in the 
+ * file.  papDest has 9 columns:
+ *
+ *  - ARC: ArcId, UserId, FNode, TNode, LPoly, RPoly and numVertices 
+ *    (GInt32), followed by the x and y of the vertices (double).
+ *  - PAL: PolyId (GInt32), Min x and y, Max x and y (double), numArcs
+ *    (GInt32), followed by the ArcId, FNode and AdjPoly of the arcs 
+ *    (GInt32).
+ *
+ * The file is split into nThreads ranges of about the same size (as
+ * many as processors if nThreads <= 0) that are decoded at the same 
+ * time by as many threads, each of at least AVCBIN_MT_MINBYTES.  The
+ * threads share the mapping of the file when it is mapped, or else 
+ * each one reads its range with its own copy of the file.
+ *
+ * Returns the number of records decoded, or -1 if a record does not 
+ * match psPos or an error happened, in which case the position of the 
+ * file is undefined.  Otherwise the file is left after the last record.
+ **********************************************************************/
+int AVCBinReadObjectColumns(AVCBinFile *psFile, AVCBinObjectPositions *psPos,
+                            void **papDest, int nThreads)
+{
+    AVCRawBinFile      *psRaw = psFile->psRawBinFile;
+    AVCBinObjectWorker *pasWorkers;
+#ifdef AVC_USE_THREADS
+    pthread_t          *pahThreads;
+    GBool              *pabStarted;
+#endif
+    GIntBig nFirstPos, nEndPos, nSplitPos;
+    int     i, n = psPos->numObjects, iObj, iLow, iHigh, numDone;
+    GBool   bMapped;
+
+    if (n == 0)
+        return 0;
+
+    nFirstPos = psPos->panPosition[0];
+    nEndPos = psPos->panPosition[n-1] + 
+              _AVCBinObjectSize(psFile->eFileType, psFile->nPrecision,
+                                psPos->panCount[n-1], NULL);
+    bMapped = (psRaw->nOffset == 0 && psRaw->nCurSize >= nEndPos);
+
+#ifdef AVC_USE_THREADS
+    if (nThreads <= 0)
+        nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    nThreads = (int)MIN(nThreads, (nEndPos - nFirstPos)/AVCBIN_MT_MINBYTES);
+    nThreads = MAX(1, MIN(nThreads, n));
+#else
+    nThreads = 1;
+#endif
+
+    pasWorkers = (AVCBinObjectWorker*)CPLCalloc(nThreads, 
+                                                sizeof(AVCBinObjectWorker));
+
+    /* The ranges are split at the first record that starts past each 
+     * nThreads'th of the bytes of the records
+     */
+    for(i=0, iObj=0; i<nThreads; i++)
+    {
+        pasWorkers[i].eType = psFile->eFileType;
+        pasWorkers[i].nPrecision = psFile->nPrecision;
+        pasWorkers[i].psPos = psPos;
+        pasWorkers[i].papDest = papDest;
+        pasWorkers[i].iFirst = iObj;
+
+        nSplitPos = nFirstPos + (nEndPos - nFirstPos)*(i+1)/nThreads;
+        for(iLow=iObj, iHigh=n; iLow<iHigh; )
+        {
+            int iMid = iLow + (iHigh - iLow)/2;
+            if (psPos->panPosition[iMid] < nSplitPos)
+                iLow = iMid + 1;
+            else
+                iHigh = iMid;
+        }
+        iObj = (i == nThreads-1) ? n : iLow;
+        pasWorkers[i].iLast = iObj;
+
+        if (bMapped)
+            pasWorkers[i].pabyData = psRaw->pabyBuf;
+        else if (nThreads == 1)
+            pasWorkers[i].psRaw = psRaw;
+        else if ((pasWorkers[i].psRaw = 
+                      AVCRawBinOpen(psRaw->pszFname, "r")) == NULL)
+        {
+            /* The copies of the file are opened here, where errors can 
+             * be reported.  Without them the records are decoded here.
+             */
+            for(i--; i>=0; i--)
+                AVCRawBinClose(pasWorkers[i].psRaw);
+            pasWorkers[0].iLast = n;
+            pasWorkers[0].psRaw = psRaw;
+            nThreads = 1;
+            break;
+        }
+    }
+
+#ifdef AVC_USE_THREADS
+    if (nThreads > 1)
+    {
+        pahThreads = (pthread_t*)CPLCalloc(nThreads, sizeof(pthread_t));
+        pabStarted = (GBool*)CPLCalloc(nThreads, sizeof(GBool));
+
+        for(i=0; i<nThreads; i++)
+            pabStarted[i] = (pthread_create(pahThreads+i, NULL, 
+                                            _AVCBinObjectThread, 
+                                            pasWorkers+i) == 0);
+
+        /* A range whose thread could not be started is decoded here */
+        for(i=0; i<nThreads; i++)
+        {
+            if (pabStarted[i])
+                pthread_join(pahThreads[i], NULL);
+            else
+                _AVCBinObjectWorker(pasWorkers+i);
+        }
+
+        CPLFree(pahThreads);
+        CPLFree(pabStarted);
+    }
+    else
+#endif
+        _AVCBinObjectWorker(pasWorkers);
+
+    for(i=0, numDone=0; i<nThreads; i++)
+    {
+        if (pasWorkers[i].bDone)
+            numDone++;
+
+        if (pasWorkers[i].psRaw != psRaw)
+            AVCRawBinClose(pasWorkers[i].psRaw);
+    }
+
+    CPLFree(pasWorkers);
+
+    if (numDone < nThreads)
+        return -1;
+
+    AVCRawBinFSeek(psRaw, nEndPos, SEEK_SET);
+
+    return n;
+}
+
+
+/*=====================================================================
+ *                              CNT
+ *====================================================================*/
+
+/**********************************************************************
+ *                          _AVCBinReadNextCnt()
+ *
+ * (This function is for internal library use... external calls should
+ * go to AVCBinReadNextCnt() instead)
+ *
+ * Read the next CNT (Polygon Centroid) structure from the file.
+ *
+ * Returns 0 on success or -1 on error.
+ **********************************************************************/
+int _AVCBinReadNextCnt(AVCRawBinFile *psFile, AVCCnt *psCnt, 
+                              int nPrecision)
+{
+    int numLabels;
+
+    psCnt->nPolyId = AVCRawBinReadInt32(psFile);
+                     AVCRawBinReadInt32(psFile); /* Skip Record size field */
+
+    if (AVCRawBinEOF(psFile))
+        return -1;
+
+    if (nPrecision == AVC_SINGLE_PREC)
+    {
+        psCnt->sCoord.x  = AVCRawBinReadFloat(psFile);
+        psCnt->sCoord.y  = AVCRawBinReadFloat(psFile);
+    }
+    else
+    {
+        psCnt->sCoord.x  = AVCRawBinReadDouble(psFile);
+        psCnt->sCoord.y  = AVCRawBinReadDouble(psFile);
+    }
+
+    numLabels      = AVCRawBinReadInt32(psFile);
+
+    /* Realloc the LabelIds array only if it needs to grow...
+     * do not realloc to a smaller size.
+     */
+    if (psCnt->panLabelIds == NULL || numLabels > psCnt->numLabels)
+        psCnt->panLabelIds = (GInt32 *)CPLRealloc(psCnt->panLabelIds,
+                                                  numLabels*sizeof(GInt32));
+
+    psCnt->numLabels = numLabels;
+
+    AVCRawBinReadInt32Array(psFile, numLabels, psCnt->panLabelIds);
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          AVCBinReadNextCnt()
+ *
+ * Read the next CNT structure from the file.
+ *
+ * Returns a pointer to a static AVCCnt structure whose contents will be
+ * valid only until the next call or NULL if an error happened or if EOF
+ * was reached.  
+ **********************************************************************/
+AVCCnt *AVCBinReadNextCnt(AVCBinFile *psFile)
+{
+    if (psFile->eFileType != AVCFileCNT ||
+        AVCRawBinEOF(psFile->psRawBinFile) ||
+        _AVCBinReadNextCnt(psFile->psRawBinFile, psFile->cur.psCnt,
+                           psFile->nPrecision) !=0)
+    {
+        return NULL;
+    }
+
+    return psFile->cur.psCnt;
+}
+
+
+/*=====================================================================
+ *                              LAB
+ *====================================================================*/
+
+/**********************************************************************
+ *                          _AVCBinReadNextLab()
+ *
+ * (This function is for internal library use... external calls should
+ * go to AVCBinReadNextLab() instead)
+ *
+ * Read the next LAB (Centroid Label) structure from the file.
+ *
+ * Returns 0 on success or -1 on error.
+ **********************************************************************/
+int _AVCBinReadNextLab(AVCRawBinFile *psFile, AVCLab *psLab, 
+                              int nPrecision)
+{
+
+    psLab->nValue  = AVCRawBinReadInt32(psFile);
+    psLab->nPolyId = AVCRawBinReadInt32(psFile);
+
+    if (AVCRawBinEOF(psFile))
+        return -1;
+
+    if (nPrecision == AVC_SINGLE_PREC)
+    {
+        psLab->sCoord1.x  = AVCRawBinReadFloat(psFile);
+        psLab->sCoord1.y  = AVCRawBinReadFloat(psFile);
+        psLab->sCoord2.x  = AVCRawBinReadFloat(psFile);
+        psLab->sCoord2.y  = AVCRawBinReadFloat(psFile);
+        psLab->sCoord3.x  = AVCRawBinReadFloat(psFile);
+        psLab->sCoord3.y  = AVCRawBinReadFloat(psFile);
+    }
+    else
     {
         psLab->sCoord1.x  = AVCRawBinReadDouble(psFile);
         psLab->sCoord1.y  = AVCRawBinReadDouble(psFile);
@@ -954,21 +1835,11 @@ int _AVCBinReadNextTxt(AVCRawBinFile *psFile, AVCTxt *psTxt,
                                               numVertices*sizeof(AVCVertex));
 
     if (nPrecision == AVC_SINGLE_PREC)
-    {
-        for(i=0; i<numVertices; i++)
-        {
-            psTxt->pasVertices[i].x = AVCRawBinReadFloat(psFile);
-            psTxt->pasVertices[i].y = AVCRawBinReadFloat(psFile);
-        }
-    }
+        AVCRawBinReadFloatArrayToDouble(psFile, 2*numVertices,
+                                        (double*)psTxt->pasVertices);
     else
-    {
-        for(i=0; i<numVertices; i++)
-        {
-            psTxt->pasVertices[i].x = AVCRawBinReadDouble(psFile);
-            psTxt->pasVertices[i].y = AVCRawBinReadDouble(psFile);
-        }
-    }
+        AVCRawBinReadDoubleArray(psFile, 2*numVertices,
+                                 (double*)psTxt->pasVertices);
 
     AVCRawBinFSeek(psFile, 8, SEEK_CUR);     /* Skip 8 bytes */
 
@@ -1386,7 +2257,7 @@ AVCBinFile *_AVCBinReadOpenTable(const char *pszInfoPath,
      *----------------------------------------------------------------*/
     if (sTableDef.numRecords > 0)
     {
-        VSIStatBuf      sStatBuf;
+        VSIStatBufL     sStatBuf;
 
         sprintf(pszFname, "%s%s", pszInfoPath, sTableDef.szDataFile);
         hFile = AVCRawBinOpen(pszFname, "r");
@@ -1411,11 +2282,13 @@ AVCBinFile *_AVCBinReadOpenTable(const char *pszInfoPath,
          * Fetch the data file size, and correct the number of record
          * field in the table header if necessary.
          *------------------------------------------------------------*/
-        if ( VSIStat(pszFname, &sStatBuf) != -1 &&
+        if ( VSIStatL(pszFname, &sStatBuf) != -1 &&
              sTableDef.nRecSize > 0 &&
-             sStatBuf.st_size/sTableDef.nRecSize != sTableDef.numRecords)
+             (GIntBig)sStatBuf.st_size/sTableDef.nRecSize != 
+                                                     sTableDef.numRecords)
         {
-            sTableDef.numRecords = sStatBuf.st_size/sTableDef.nRecSize;
+            sTableDef.numRecords = (GInt32)MIN((GIntBig)sStatBuf.st_size/
+                                               sTableDef.nRecSize, INT_MAX);
         }
 
     }
@@ -1466,6 +2339,23 @@ AVCBinFile *_AVCBinReadOpenTable(const char *pszInfoPath,
 }
 
 
+/**********************************************************************
+ *                         _AVCBinTableRecordSize()
+ *
+ * Return the number of bytes used by each record of a table in its 
+ * data file: the size of its fields, rounded to nRecSize (see 
+ * _AVCBinReadNextTableRec()).
+ **********************************************************************/
+static int _AVCBinTableRecordSize(AVCTableDef *psTableDef)
+{
+    int i, nSize = 0;
+
+    for(i=0; i<psTableDef->numFields; i++)
+        nSize += psTableDef->pasFieldDef[i].nSize;
+
+    return MAX(nSize, psTableDef->nRecSize);
+}
+
 /**********************************************************************
  *                         _AVCBinReadNextTableRec()
  *
@@ -1485,25 +2375,57 @@ int _AVCBinReadNextTableRec(AVCRawBinFile *psFile, int nFields,
                             AVCFieldInfo *pasDef, AVCField *pasFields,
                             int nRecordSize)
 {
-    int i, nType, nBytesRead=0;
+    int i, nType, nPos, nBytesToRead=0, nStatus=0;
+    GByte abyRecBuf[AVCRAWBIN_READBUFSIZE], *pabyRec, *pabyAlloc=NULL;
 
-    if (psFile == NULL)
+    if (psFile == NULL || AVCRawBinEOF(psFile))
         return -1;
 
+    /*-----------------------------------------------------------------
+     * Record size is rounded to a multiple of 2 bytes, so the whole
+     * record is usually a bit longer than the fields it contains.
+     *----------------------------------------------------------------*/
     for(i=0; i<nFields; i++)
+        nBytesToRead += pasDef[i].nSize;
+    nBytesToRead = MAX(nBytesToRead, nRecordSize);
+
+    /*-----------------------------------------------------------------
+     * Fetch the whole record at once: when it is all in the current
+     * buffer (or file mapping) we decode it in place, otherwise it is
+     * copied to a temporary buffer.
+     *----------------------------------------------------------------*/
+    if (psFile->nCurPos + nBytesToRead <= psFile->nCurSize)
     {
-        if (AVCRawBinEOF(psFile))
-            return -1;
+        pabyRec = psFile->pabyBuf + psFile->nCurPos;
+        psFile->nCurPos += nBytesToRead;
+    }
+    else
+    {
+        GIntBig nStartPos = psFile->nOffset + psFile->nCurPos;
 
-        nType = pasDef[i].nType1*10;
+        if (nBytesToRead <= AVCRAWBIN_READBUFSIZE)
+            pabyRec = abyRecBuf;
+        else
+            pabyRec = pabyAlloc = 
+                          (GByte*)CPLMalloc(nBytesToRead*sizeof(GByte));
 
-        if (nType ==  AVC_FT_DATE || nType == AVC_FT_CHAR ||
+        AVCRawBinReadBytes(psFile, nBytesToRead, pabyRec);
+
+        if (psFile->nOffset + psFile->nCurPos - nStartPos < nBytesToRead)
+            nStatus = -1;
+    }
+
+    for(i=0, nPos=0; nStatus == 0 && i<nFields; i++)
+    {
+        nType = pasDef[i].nType1*10;
+
+        if (nType ==  AVC_FT_DATE || nType == AVC_FT_CHAR ||
             nType == AVC_FT_FIXINT || nType == AVC_FT_FIXNUM)
         {
             /*---------------------------------------------------------
              * Values stored as strings
              *--------------------------------------------------------*/
-            AVCRawBinReadBytes(psFile, pasDef[i].nSize, (GByte *) (pasFields[i].pszStr) );
+            memcpy(pasFields[i].pszStr, pabyRec+nPos, pasDef[i].nSize);
             pasFields[i].pszStr[pasDef[i].nSize] = '\0';
         }
         else if (nType == AVC_FT_BININT && pasDef[i].nSize == 4)
@@ -1511,28 +2433,28 @@ int _AVCBinReadNextTableRec(AVCRawBinFile *psFile, int nFields,
             /*---------------------------------------------------------
              * 32 bit binary integers
              *--------------------------------------------------------*/
-            pasFields[i].nInt32 = AVCRawBinReadInt32(psFile);
+            pasFields[i].nInt32 = AVCRawBinDecodeInt32(pabyRec+nPos);
         }
         else if (nType == AVC_FT_BININT && pasDef[i].nSize == 2)
         {
             /*---------------------------------------------------------
              * 16 bit binary integers
              *--------------------------------------------------------*/
-            pasFields[i].nInt16 = AVCRawBinReadInt16(psFile);
+            pasFields[i].nInt16 = AVCRawBinDecodeInt16(pabyRec+nPos);
         }
         else if (nType == AVC_FT_BINFLOAT && pasDef[i].nSize == 4)
         {
             /*---------------------------------------------------------
              * Single precision floats
              *--------------------------------------------------------*/
-            pasFields[i].fFloat = AVCRawBinReadFloat(psFile);
+            pasFields[i].fFloat = AVCRawBinDecodeFloat(pabyRec+nPos);
         }
         else if (nType == AVC_FT_BINFLOAT && pasDef[i].nSize == 8)
         {
             /*---------------------------------------------------------
              * Double precision floats
              *--------------------------------------------------------*/
-            pasFields[i].dDouble = AVCRawBinReadDouble(psFile);
+            pasFields[i].dDouble = AVCRawBinDecodeDouble(pabyRec+nPos);
         }
         else
         {
@@ -1542,21 +2464,15 @@ int _AVCBinReadNextTableRec(AVCRawBinFile *psFile, int nFields,
             CPLError(CE_Failure, CPLE_NotSupported,
                      "Unsupported field type: (type=%d, size=%d)",
                      nType, pasDef[i].nSize);
-            return -1;
+            nStatus = -1;
         }
 
-        nBytesRead += pasDef[i].nSize;
+        nPos += pasDef[i].nSize;
     }
 
-    /*-----------------------------------------------------------------
-     * Record size is rounded to a multiple of 2 bytes.
-     * Check the number of bytes read, and move the read pointer if
-     * necessary.
-     *----------------------------------------------------------------*/
-    if (nBytesRead < nRecordSize)
-        AVCRawBinFSeek(psFile, SEEK_CUR, nRecordSize - nBytesRead);
+    CPLFree(pabyAlloc);
 
-    return 0;
+    return nStatus;
 }
 
 /**********************************************************************
@@ -1585,4 +2501,908 @@ AVCField *AVCBinReadNextTableRec(AVCBinFile *psFile)
     return psFile->cur.pasFields;
 }
 
+/**********************************************************************
+ *                          AVCBinReadTableRecAt()
+ *
+ * Read the iRow'th record (1-based) of a table.  Records have a fixed 
+ * size, so the record is read directly from its position in the data 
+ * file, without reading the records that come before.
+ *
+ * After this call, AVCBinReadNextTableRec() continues with the record
+ * that follows the one that was read.
+ *
+ * Returns a reference to a static AVCField array as 
+ * AVCBinReadNextTableRec() does, or NULL if the record is not in the 
+ * table or if an error happened.
+ **********************************************************************/
+AVCField *AVCBinReadTableRecAt(AVCBinFile *psFile, int iRow)
+{
+    if (psFile->eFileType != AVCFileTABLE || 
+        psFile->psRawBinFile == NULL)
+        return NULL;
+
+    if (iRow < 1 || iRow > psFile->hdr.psTableDef->numRecords)
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "AVCBinReadTableRecAt(): Record %d not in %s.",
+                 iRow, psFile->pszFilename);
+        return NULL;
+    }
+
+    AVCRawBinFSeek(psFile->psRawBinFile, 
+                   (GIntBig)(iRow-1)*
+                       _AVCBinTableRecordSize(psFile->hdr.psTableDef),
+                   SEEK_SET);
+
+    return AVCBinReadNextTableRec(psFile);
+}
+
+/**********************************************************************
+ *                          AVCBinCompileTableDef()
+ *
+ * Compile the definition of a table into a decode plan for 
+ * AVCBinReadTableRecords(): the kind, position and size of each field
+ * are worked out once instead of for each field of each record.
+ *
+ * Returns a new AVCTableDecoder (to be released with 
+ * AVCBinFreeTableDecoder()), or NULL if the table contains a field of
+ * an unsupported type.
+ **********************************************************************/
+AVCTableDecoder *AVCBinCompileTableDef(AVCTableDef *psTableDef)
+{
+    return AVCBinCompileTableFields(psTableDef, NULL, psTableDef->numFields);
+}
+
+/**********************************************************************
+ *                          AVCBinCompileTableFields()
+ *
+ * Same as AVCBinCompileTableDef(), but the plan only decodes the 
+ * numFields fields whose indexes (0-based) are in panFields, in that 
+ * order.  The i-th field of the plan is the panFields[i]-th field of the
+ * table, and the others are never looked at.  If panFields is NULL then
+ * all the fields of the table are used.
+ *
+ * Returns NULL if one of the fields is of an unsupported type or is
+ * not in the table.
+ **********************************************************************/
+AVCTableDecoder *AVCBinCompileTableFields(AVCTableDef *psTableDef,
+                                          const int *panFields, 
+                                          int numFields)
+{
+    AVCTableDecoder *psDecoder;
+    AVCFieldDecoder *psField;
+    AVCFieldInfo    *psDef;
+    int             i, iField, nType, nPos, *panOffsets;
+
+    /* Position of each field in the record */
+    panOffsets = (int*)CPLMalloc((psTableDef->numFields+1)*sizeof(int));
+    for(i=0, nPos=0; i<psTableDef->numFields; i++)
+    {
+        panOffsets[i] = nPos;
+        nPos += psTableDef->pasFieldDef[i].nSize;
+    }
+    panOffsets[i] = nPos;
+
+    psDecoder = (AVCTableDecoder*)CPLCalloc(1, sizeof(AVCTableDecoder));
+    psDecoder->numFields = numFields;
+    psDecoder->pasFields = (AVCFieldDecoder*)
+                  CPLCalloc(MAX(numFields, 1), sizeof(AVCFieldDecoder));
+
+    /* Same record size as in _AVCBinReadNextTableRec() */
+    psDecoder->nRecordSize = MAX(panOffsets[psTableDef->numFields], 
+                                 psTableDef->nRecSize);
+
+    for(i=0; i<numFields; i++)
+    {
+        iField = (panFields ? panFields[i] : i);
+
+        if (iField < 0 || iField >= psTableDef->numFields)
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "Invalid field index: %d", iField);
+            AVCBinFreeTableDecoder(psDecoder);
+            psDecoder = NULL;
+            break;
+        }
+
+        psDef = psTableDef->pasFieldDef + iField;
+        psField = psDecoder->pasFields + i;
+        nType = psDef->nType1*10;
+
+        psField->nOffset = panOffsets[iField];
+        psField->nSize = psDef->nSize;
+
+        if (nType == AVC_FT_DATE || nType == AVC_FT_CHAR)
+            psField->eKind = AVCDecodeString;
+        else if (nType == AVC_FT_FIXINT)
+            psField->eKind = AVCDecodeFixInt;
+        else if (nType == AVC_FT_FIXNUM)
+            psField->eKind = AVCDecodeFixNum;
+        else if (nType == AVC_FT_BININT && psDef->nSize == 2)
+            psField->eKind = AVCDecodeInt16;
+        else if (nType == AVC_FT_BININT && psDef->nSize == 4)
+            psField->eKind = AVCDecodeInt32;
+        else if (nType == AVC_FT_BINFLOAT && psDef->nSize == 4)
+            psField->eKind = AVCDecodeFloat;
+        else if (nType == AVC_FT_BINFLOAT && psDef->nSize == 8)
+            psField->eKind = AVCDecodeDouble;
+        else
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Unsupported field type: (type=%d, size=%d)",
+                     nType, psDef->nSize);
+            AVCBinFreeTableDecoder(psDecoder);
+            psDecoder = NULL;
+            break;
+        }
+    }
+
+    CPLFree(panOffsets);
+
+    return psDecoder;
+}
+
+/**********************************************************************
+ *                          AVCBinFreeTableDecoder()
+ *
+ * Release a plan created by AVCBinCompileTableDef().
+ **********************************************************************/
+void AVCBinFreeTableDecoder(AVCTableDecoder *psDecoder)
+{
+    int i;
+
+    if (psDecoder)
+    {
+        for(i=0; i<psDecoder->numConditions; i++)
+        {
+            CPLFree(psDecoder->pasConditions[i].padValues);
+            CSLDestroy(psDecoder->pasConditions[i].papszValues);
+        }
+        CPLFree(psDecoder->pasConditions);
+        CPLFree(psDecoder->pasFields);
+        CPLFree(psDecoder);
+    }
+}
+
+/**********************************************************************
+ *                          AVCBinAddTableCondition()
+ *
+ * Add a condition on the iField-th field (0-based) of the table to a 
+ * decode plan: AVCBinReadTableRecords() will then skip the records for
+ * which the value of the field is not eOp the values.  The field does 
+ * not have to be one of the fields decoded by the plan.
+ *
+ * The values are given in padValues for numeric fields, or in 
+ * papszValues for DATE and CHAR fields, which are compared byte by byte
+ * ignoring trailing spaces.  All the operators but AVCCompareIN take a
+ * single value.
+ *
+ * Returns 0 on success or -1 on error.
+ **********************************************************************/
+int AVCBinAddTableCondition(AVCTableDecoder *psDecoder, 
+                            AVCTableDef *psTableDef, int iField,
+                            AVCCompareOp eOp, int numValues,
+                            const double *padValues, 
+                            const char **papszValues)
+{
+    AVCTableDecoder   *psField;
+    AVCFieldCondition *psCond;
+    int               i, nLen;
+
+    if (numValues < 1 || (numValues > 1 && eOp != AVCCompareIN))
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Invalid number of values in a condition: %d", numValues);
+        return -1;
+    }
+
+    /* The position and kind of the field come from a plan for it alone */
+    if ((psField = AVCBinCompileTableFields(psTableDef, &iField, 1)) == NULL)
+        return -1;
+
+    if ((psField->pasFields[0].eKind == AVCDecodeString && 
+         papszValues == NULL) ||
+        (psField->pasFields[0].eKind != AVCDecodeString && 
+         padValues == NULL))
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Values of the wrong type in a condition on field %d", 
+                 iField);
+        AVCBinFreeTableDecoder(psField);
+        return -1;
+    }
+
+    psDecoder->pasConditions = (AVCFieldCondition*)
+                CPLRealloc(psDecoder->pasConditions, 
+                           (psDecoder->numConditions+1)*
+                                          sizeof(AVCFieldCondition));
+    psCond = psDecoder->pasConditions + psDecoder->numConditions++;
+    memset(psCond, 0, sizeof(AVCFieldCondition));
+
+    psCond->sField = psField->pasFields[0];
+    psCond->eOp = eOp;
+    psCond->numValues = numValues;
+
+    if (psCond->sField.eKind == AVCDecodeString)
+    {
+        for(i=0; i<numValues; i++)
+        {
+            psCond->papszValues = CSLAddString(psCond->papszValues, 
+                                               papszValues[i]);
+            nLen = strlen(papszValues[i]);
+            while(nLen > 0 && psCond->papszValues[i][nLen-1] == ' ')
+                psCond->papszValues[i][--nLen] = '\0';
+        }
+    }
+    else
+    {
+        psCond->padValues = (double*)CPLMalloc(numValues*sizeof(double));
+        memcpy(psCond->padValues, padValues, numValues*sizeof(double));
+    }
+
+    AVCBinFreeTableDecoder(psField);
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          _AVCBinTestCondition()
+ *
+ * Return TRUE if the record in pabyRec satisfies the condition.
+ **********************************************************************/
+static GBool _AVCBinTestCondition(const GByte *pabyRec, 
+                                  AVCFieldCondition *psCond)
+{
+    const GByte *pabySrc = pabyRec + psCond->sField.nOffset;
+    int         i, nCmp = 0, nLen = 0, nValLen;
+    double      dValue = 0.0;
+
+    switch(psCond->sField.eKind)
+    {
+      case AVCDecodeString:
+        /* Trailing spaces (and NULs) are not part of the value */
+        nLen = psCond->sField.nSize;
+        while(nLen > 0 && 
+              (pabySrc[nLen-1] == ' ' || pabySrc[nLen-1] == '\0'))
+            nLen--;
+        break;
+      case AVCDecodeFixInt:
+        dValue = _AVCParseFixInt((const char*)pabySrc, psCond->sField.nSize);
+        break;
+      case AVCDecodeFixNum:
+        dValue = _AVCParseFixNum((const char*)pabySrc, psCond->sField.nSize);
+        break;
+      case AVCDecodeInt16:
+        dValue = AVCRawBinDecodeInt16(pabySrc);
+        break;
+      case AVCDecodeInt32:
+        dValue = AVCRawBinDecodeInt32(pabySrc);
+        break;
+      case AVCDecodeFloat:
+        dValue = AVCRawBinDecodeFloat(pabySrc);
+        break;
+      case AVCDecodeDouble:
+        dValue = AVCRawBinDecodeDouble(pabySrc);
+        break;
+    }
+
+    for(i=0; i<psCond->numValues; i++)
+    {
+        if (psCond->sField.eKind == AVCDecodeString)
+        {
+            nValLen = strlen(psCond->papszValues[i]);
+            nCmp = memcmp(pabySrc, psCond->papszValues[i], 
+                          MIN(nLen, nValLen));
+            if (nCmp == 0)
+                nCmp = nLen - nValLen;
+            nCmp = (nCmp < 0) ? -1 : (nCmp > 0) ? 1 : 0;
+        }
+        else if (dValue != psCond->padValues[i])
+        {
+            /* NaN is neither less nor greater than anything */
+            nCmp = (dValue < psCond->padValues[i]) ? -1 : 
+                   (dValue > psCond->padValues[i]) ? 1 : 2;
+        }
+        else
+            nCmp = 0;
+
+        switch(psCond->eOp)
+        {
+          case AVCCompareEQ:
+          case AVCCompareIN:
+            if (nCmp == 0)
+                return TRUE;
+            break;
+          case AVCCompareNE:
+            return (nCmp != 0);
+          case AVCCompareLT:
+            return (nCmp < 0);
+          case AVCCompareLE:
+            return (nCmp <= 0);
+          case AVCCompareGT:
+            return (nCmp > 0 && nCmp != 2);
+          case AVCCompareGE:
+            return (nCmp >= 0 && nCmp != 2);
+        }
+    }
+
+    return FALSE;
+}
+
+/**********************************************************************
+ *                          _AVCBinFilterTableBlock()
+ *
+ * Test the conditions of a plan on numRecords consecutive records of a
+ * buffer, and store in panRecs the position of the records that satisfy 
+ * all of them.  Returns their number.
+ **********************************************************************/
+static int _AVCBinFilterTableBlock(const GByte *pabyRecs, int numRecords,
+                                   AVCTableDecoder *psDecoder, int *panRecs)
+{
+    int i, j, n = numRecords, m;
+
+    for(j=0; j<numRecords; j++)
+        panRecs[j] = j;
+
+    for(i=0; i<psDecoder->numConditions && n > 0; i++)
+    {
+        for(j=0, m=0; j<n; j++)
+        {
+            if (_AVCBinTestCondition(pabyRecs + 
+                                     panRecs[j]*psDecoder->nRecordSize,
+                                     psDecoder->pasConditions + i))
+                panRecs[m++] = panRecs[j];
+        }
+        n = m;
+    }
+
+    return n;
+}
+
+/**********************************************************************
+ *                          _AVCBinDecodeTableBlock()
+ *
+ * Execute a decode plan on numRecords records (nRecordSize bytes each)
+ * of a buffer: the consecutive records at its start, or the records at
+ * the positions in panRecs if it is not NULL.  Each field is decoded for
+ * all the records before going to the next one, so that the kind of the
+ * field is only looked at once per block.
+ **********************************************************************/
+static void _AVCBinDecodeTableBlock(const GByte *pabyRecs, int numRecords,
+                                    const int *panRecs,
+                                    AVCTableDecoder *psDecoder,
+                                    void **papDest, int iFirstDest)
+{
+    int     i, j, nStride = psDecoder->nRecordSize;
+    const GByte *pabyField;
+    AVCFieldDecoder *psField;
+
+/* Start of the field in the j-th record of the block */
+#define FIELD_SRC(j) (pabyField + (panRecs ? panRecs[j] : (j))*nStride)
+
+    for(i=0; i<psDecoder->numFields; i++)
+    {
+        psField = psDecoder->pasFields + i;
+
+        if (papDest[i] == NULL)
+            continue;
+
+        pabyField = pabyRecs + psField->nOffset;
+
+        switch(psField->eKind)
+        {
+          case AVCDecodeString:
+          {
+            int  nSize = psField->nSize;
+            char *pszDst = (char*)papDest[i] + iFirstDest*(nSize+1);
+
+            for(j=0; j<numRecords; j++, pszDst+=nSize+1)
+            {
+                memcpy(pszDst, FIELD_SRC(j), nSize);
+                pszDst[nSize] = '\0';
+            }
+            break;
+          }
+          case AVCDecodeFixInt:
+          {
+            GInt32 *panDst = (GInt32*)papDest[i] + iFirstDest;
+
+            for(j=0; j<numRecords; j++)
+                panDst[j] = _AVCParseFixInt((const char*)FIELD_SRC(j), 
+                                            psField->nSize);
+            break;
+          }
+          case AVCDecodeFixNum:
+          {
+            double *padDst = (double*)papDest[i] + iFirstDest;
+
+            for(j=0; j<numRecords; j++)
+                padDst[j] = _AVCParseFixNum((const char*)FIELD_SRC(j), 
+                                            psField->nSize);
+            break;
+          }
+          case AVCDecodeInt16:
+          {
+            GInt32 *panDst = (GInt32*)papDest[i] + iFirstDest;
+
+            for(j=0; j<numRecords; j++)
+                panDst[j] = AVCRawBinDecodeInt16(FIELD_SRC(j));
+            break;
+          }
+          case AVCDecodeInt32:
+          {
+            GInt32 *panDst = (GInt32*)papDest[i] + iFirstDest;
+
+            for(j=0; j<numRecords; j++)
+                panDst[j] = AVCRawBinDecodeInt32(FIELD_SRC(j));
+            break;
+          }
+          case AVCDecodeFloat:
+          {
+            double *padDst = (double*)papDest[i] + iFirstDest;
+
+            for(j=0; j<numRecords; j++)
+                padDst[j] = AVCRawBinDecodeFloat(FIELD_SRC(j));
+            break;
+          }
+          case AVCDecodeDouble:
+          {
+            double *padDst = (double*)papDest[i] + iFirstDest;
+
+            for(j=0; j<numRecords; j++)
+                padDst[j] = AVCRawBinDecodeDouble(FIELD_SRC(j));
+            break;
+          }
+        }
+    }
+
+#undef FIELD_SRC
+}
+
+/**********************************************************************
+ *                          AVCBinReadTableRecords()
+ *
+ * Read (up to) the next numRecords records of a table and decode them
+ * with a plan from AVCBinCompileTableDef().
+ *
+ * papDest[i] is where the values of the i-th field are stored, starting
+ * at position iFirstDest: an array of GInt32 for integer fields, of 
+ * double for floating point fields, or of chars for DATE and CHAR 
+ * fields (nSize+1 chars per value, '\0'-terminated).  Fields with a NULL
+ * papDest[i] are skipped.
+ *
+ * If conditions have been added to the plan (AVCBinAddTableCondition())
+ * the records that do not satisfy them are skipped without being 
+ * decoded, and only the records that do count towards numRecords.
+ *
+ * The records that are in the current buffer (the whole file when it is
+ * mapped) are decoded in place, in a single block; the others are 
+ * read in blocks of whole records.  With a plan for a few fields 
+ * (AVCBinCompileTableFields()) only the bytes of those fields are
+ * decoded.
+ *
+ * Returns the number of records read, which is less than numRecords
+ * only if EOF was reached or an error happened.
+ **********************************************************************/
+int AVCBinReadTableRecords(AVCBinFile *psFile, AVCTableDecoder *psDecoder,
+                           int numRecords, void **papDest, int iFirstDest)
+{
+    AVCRawBinFile *psRaw = psFile->psRawBinFile;
+    int     nRecSize = psDecoder->nRecordSize, numRead = 0, n, nLeft;
+    int     nAllocSize = 0, nMaxBlock, nWanted, nUsed, *panRecs = NULL;
+    GByte   abyRecBuf[AVCRAWBIN_READBUFSIZE], *pabyRec, *pabyAlloc=NULL;
+
+    if (psFile->eFileType != AVCFileTABLE ||
+        psFile->hdr.psTableDef->numRecords == 0 || psRaw == NULL ||
+        nRecSize <= 0)
+        return 0;
+
+    /* Records that are read (or tested) at a time out of the buffer */
+    nMaxBlock = MAX(1, AVCTABLE_READBLOCKSIZE/nRecSize);
+
+    if (psDecoder->numConditions > 0)
+        panRecs = (int*)CPLMalloc(nMaxBlock*sizeof(int));
+
+    while(numRead < numRecords && !AVCRawBinEOF(psRaw))
+    {
+        /* With conditions we don't know how many records will be needed,
+         * they are tested in blocks
+         */
+        nWanted = (panRecs ? nMaxBlock : numRecords - numRead);
+        n = MIN((psRaw->nCurSize - psRaw->nCurPos)/nRecSize, nWanted);
+
+        if (n > 0)
+        {
+            /* A block of whole records in the current buffer */
+            pabyRec = psRaw->pabyBuf + psRaw->nCurPos;
+            psRaw->nCurPos += n*nRecSize;
+        }
+        else
+        {
+            /* The next records are not in the buffer: those that are 
+             * known to be in the file (see AVCBinReadOpen()) are read 
+             * with a single call, up to AVCTABLE_READBLOCKSIZE bytes.
+             * Past them records are read one by one, to stop at EOF as
+             * _AVCBinReadNextTableRec() does.
+             */
+            GIntBig nStartPos = psRaw->nOffset + psRaw->nCurPos;
+
+            nLeft = (int)(((GIntBig)psFile->hdr.psTableDef->numRecords *
+                           psFile->hdr.psTableDef->nRecSize - nStartPos)/
+                          nRecSize);
+            n = MAX(1, MIN(MIN(nLeft, nWanted), nMaxBlock));
+
+            if (n*nRecSize > AVCRAWBIN_READBUFSIZE && n*nRecSize > nAllocSize)
+            {
+                nAllocSize = n*nRecSize;
+                pabyAlloc = (GByte*)CPLRealloc(pabyAlloc, nAllocSize);
+            }
+            pabyRec = (pabyAlloc ? pabyAlloc : abyRecBuf);
+
+            AVCRawBinReadBytes(psRaw, n*nRecSize, pabyRec);
+
+            n = (int)((psRaw->nOffset + psRaw->nCurPos - nStartPos)/nRecSize);
+            if (n == 0)
+                break;
+        }
+
+        if (panRecs)
+        {
+            nUsed = n;
+            n = _AVCBinFilterTableBlock(pabyRec, n, psDecoder, panRecs);
+
+            /* The records after the last one needed are left to be read
+             * again by the next call
+             */
+            if (n > numRecords - numRead)
+            {
+                n = numRecords - numRead;
+                AVCRawBinFSeek(psRaw, 
+                               (panRecs[n-1] + 1 - nUsed)*nRecSize, SEEK_CUR);
+            }
+        }
+
+        _AVCBinDecodeTableBlock(pabyRec, n, panRecs, psDecoder, papDest, 
+                                iFirstDest + numRead);
+        numRead += n;
+    }
+
+    CPLFree(panRecs);
+    CPLFree(pabyAlloc);
+
+    return numRead;
+}
+
+/**********************************************************************
+ *                          _AVCBinTableWorker()
+ *
+ * A range of records decoded by one of the threads of
+ * AVCBinReadTableRecordsMT(): either from the file mapping shared by 
+ * all the threads (pabyRecs) or with its own file (psRaw).  The errors
+ * of the worker are kept quiet in its thread, and it only reports the
+ * number of records read.
+ **********************************************************************/
+typedef struct AVCBinTableWorker_t
+{
+    AVCTableDecoder *psDecoder;
+    const GByte *pabyRecs;      /* Records of the range, if mapped      */
+    AVCRawBinFile *psRaw;       /* Otherwise, file to read them from    */
+    int         nFirst;         /* First record (0-based) of the range  */
+    int         numRecords;
+    void        **papDest;
+    int         iFirstDest;
+    int         numRead;
+}AVCBinTableWorker;
+
+static void *_AVCBinTableWorker(void *pArg)
+{
+    AVCBinTableWorker *psWorker = (AVCBinTableWorker *)pArg;
+    int     n, nRecSize = psWorker->psDecoder->nRecordSize, nBlock;
+    GByte   *pabyBuf;
+
+    if (psWorker->pabyRecs)
+    {
+        _AVCBinDecodeTableBlock(psWorker->pabyRecs, psWorker->numRecords,
+                                NULL, psWorker->psDecoder, 
+                                psWorker->papDest, psWorker->iFirstDest);
+        psWorker->numRead = psWorker->numRecords;
+        return NULL;
+    }
+
+    nBlock = MAX(1, AVCTABLE_READBLOCKSIZE/nRecSize);
+    if ((pabyBuf = (GByte*)VSIMalloc(nBlock*nRecSize)) == NULL)
+        return NULL;
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+
+    AVCRawBinFSeek(psWorker->psRaw, (GIntBig)psWorker->nFirst*nRecSize, 
+                   SEEK_SET);
+
+    while(psWorker->numRead < psWorker->numRecords)
+    {
+        n = MIN(nBlock, psWorker->numRecords - psWorker->numRead);
+
+        /* The records are known to be in the file, so the read can only
+         * come up short on an I/O error
+         */
+        AVCRawBinReadBytes(psWorker->psRaw, n*nRecSize, pabyBuf);
+        if (psWorker->psRaw->nOffset + psWorker->psRaw->nCurPos <
+            (GIntBig)(psWorker->nFirst + psWorker->numRead + n)*nRecSize)
+            break;
+
+        _AVCBinDecodeTableBlock(pabyBuf, n, NULL, psWorker->psDecoder, 
+                                psWorker->papDest, 
+                                psWorker->iFirstDest + psWorker->numRead);
+        psWorker->numRead += n;
+    }
+
+    VSIFree(pabyBuf);
+
+    CPLPopErrorHandler();
+
+    return NULL;
+}
+
+#ifdef AVC_USE_THREADS
+/* Start routine of the threads of AVCBinReadTableRecordsMT() */
+static void *_AVCBinTableThread(void *pArg)
+{
+    CPLSetWorkerThread();
+
+    return _AVCBinTableWorker(pArg);
+}
+#endif
+
+/**********************************************************************
+ *                          AVCBinReadTableRecordsMT()
+ *
+ * Same as AVCBinReadTableRecords(), but the records are split into 
+ * nThreads ranges that are decoded at the same time by as many threads
+ * (as many as processors if nThreads <= 0).  Records have a fixed size,
+ * so each range starts at a known position: the threads share the 
+ * mapping of the file when it is mapped, or else each one reads its 
+ * range with its own copy of the file.  Each thread decodes its records
+ * straight into their positions in papDest.
+ *
+ * Records are decoded in the calling thread, by 
+ * AVCBinReadTableRecords(), when there are too few of them 
+ * (AVCTABLE_MT_MINRECORDS per thread), when the plan has conditions, or
+ * when the platform has no threads.
+ *
+ * Returns the number of records read, which is less than numRecords
+ * only if EOF was reached or an error happened.
+ **********************************************************************/
+int AVCBinReadTableRecordsMT(AVCBinFile *psFile, AVCTableDecoder *psDecoder,
+                             int numRecords, void **papDest, int iFirstDest,
+                             int nThreads)
+{
+#ifdef AVC_USE_THREADS
+    AVCRawBinFile     *psRaw = psFile->psRawBinFile;
+    AVCBinTableWorker *pasWorkers;
+    pthread_t         *pahThreads;
+    GBool             *pabStarted, bMapped, bOpened;
+    GIntBig nPos;
+    int     i, n, nFirst, numRead = 0, nRecSize;
+
+    if (nThreads <= 0)
+        nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (psFile->eFileType != AVCFileTABLE || psRaw == NULL || 
+        psDecoder->numConditions > 0 || nThreads <= 1 ||
+        (nRecSize = psDecoder->nRecordSize) <= 0)
+        return AVCBinReadTableRecords(psFile, psDecoder, numRecords, 
+                                      papDest, iFirstDest);
+
+    /* Records left in the file (see AVCBinReadTableRecords())
+     */
+    nPos = psRaw->nOffset + psRaw->nCurPos;
+    n = (int)MIN(((GIntBig)psFile->hdr.psTableDef->numRecords * 
+                  psFile->hdr.psTableDef->nRecSize - nPos)/nRecSize, 
+                 numRecords);
+    nThreads = MIN(nThreads, n/AVCTABLE_MT_MINRECORDS);
+
+    if (nThreads <= 1 || nPos % nRecSize != 0)
+        return AVCBinReadTableRecords(psFile, psDecoder, numRecords, 
+                                      papDest, iFirstDest);
+
+    bMapped = (psRaw->nOffset == 0 && 
+               psRaw->nCurSize >= nPos + (GIntBig)n*nRecSize);
+
+    pasWorkers = (AVCBinTableWorker*)CPLCalloc(nThreads, 
+                                               sizeof(AVCBinTableWorker));
+    pahThreads = (pthread_t*)CPLCalloc(nThreads, sizeof(pthread_t));
+    pabStarted = (GBool*)CPLCalloc(nThreads, sizeof(GBool));
+
+    /* The files of the threads are opened here, where errors can be
+     * reported
+     */
+    for(i=0, nFirst=(int)(nPos/nRecSize), bOpened=TRUE; i<nThreads; i++)
+    {
+        pasWorkers[i].psDecoder = psDecoder;
+        pasWorkers[i].nFirst = nFirst;
+        pasWorkers[i].numRecords = n/nThreads + (i < n%nThreads ? 1 : 0);
+        pasWorkers[i].papDest = papDest;
+        pasWorkers[i].iFirstDest = iFirstDest + nFirst - 
+                                   (int)(nPos/nRecSize);
+        nFirst += pasWorkers[i].numRecords;
+
+        if (bMapped)
+            pasWorkers[i].pabyRecs = psRaw->pabyBuf + 
+                                     (size_t)pasWorkers[i].nFirst*nRecSize;
+        else if (bOpened &&
+                 (pasWorkers[i].psRaw = 
+                      AVCRawBinOpen(psRaw->pszFname, "r")) == NULL)
+            bOpened = FALSE;
+    }
+
+    for(i=0; i<nThreads && bOpened; i++)
+    {
+        pabStarted[i] = (pthread_create(pahThreads+i, NULL, 
+                                        _AVCBinTableThread, 
+                                        pasWorkers+i) == 0);
+    }
+
+    /* A range whose thread could not be started is decoded here */
+    for(i=0; i<nThreads && bOpened; i++)
+    {
+        if (pabStarted[i])
+            pthread_join(pahThreads[i], NULL);
+        else
+            _AVCBinTableWorker(pasWorkers+i);
+    }
+
+    /* Only the records up to the first range that is not complete are
+     * counted as read
+     */
+    for(i=0; i<nThreads; i++)
+    {
+        numRead += pasWorkers[i].numRead;
+
+        if (pasWorkers[i].numRead < pasWorkers[i].numRecords)
+            break;
+    }
+
+    for(i=0; i<nThreads; i++)
+        AVCRawBinClose(pasWorkers[i].psRaw);
+
+    CPLFree(pasWorkers);
+    CPLFree(pahThreads);
+    CPLFree(pabStarted);
+
+    if (!bOpened)
+        return AVCBinReadTableRecords(psFile, psDecoder, numRecords, 
+                                      papDest, iFirstDest);
+
+    AVCRawBinFSeek(psRaw, nPos + (GIntBig)numRead*nRecSize, SEEK_SET);
+
+    /* The records after the last range, if any, are read as usual */
+    if (numRead == n && n < numRecords)
+        numRead += AVCBinReadTableRecords(psFile, psDecoder, 
+                                          numRecords - n, papDest, 
+                                          iFirstDest + n);
+
+    return numRead;
+#else
+    return AVCBinReadTableRecords(psFile, psDecoder, numRecords, 
+                                  papDest, iFirstDest);
+#endif
+}
+
+/**********************************************************************
+ *                          AVCBinReadTableRecordsAt()
+ *
+ * Random access version of AVCBinReadTableRecords(): read the numRows
+ * records whose numbers (1-based) are in paiRows[] and decode them with
+ * a plan from AVCBinCompileTableDef().  The values of the record 
+ * paiRows[i] are stored at position iFirstDest+i of papDest (see 
+ * AVCBinReadTableRecords()).  Rows can be in any order and repeated.  
+ * The conditions of the plan, if any, are not used.
+ *
+ * When the whole data file is in memory (it is mapped) the records are
+ * decoded in place.  Otherwise they are read in the order in which they
+ * appear in the data file, so that it is only read forward.
+ *
+ * Returns numRows, or -1 if one of the records is not in the table or
+ * if an error happened.
+ **********************************************************************/
+typedef struct AVCBinRowPos_t
+{
+    int         iRow;
+    int         iPos;
+}AVCBinRowPos;
+
+static int _AVCBinCompareRowPos(const void *p1, const void *p2)
+{
+    const AVCBinRowPos *ps1 = (const AVCBinRowPos *)p1;
+    const AVCBinRowPos *ps2 = (const AVCBinRowPos *)p2;
+
+    if (ps1->iRow != ps2->iRow)
+        return (ps1->iRow < ps2->iRow) ? -1 : 1;
+
+    return ps1->iPos - ps2->iPos;
+}
+
+int AVCBinReadTableRecordsAt(AVCBinFile *psFile, AVCTableDecoder *psDecoder,
+                             int numRows, const int *paiRows,
+                             void **papDest, int iFirstDest)
+{
+    AVCRawBinFile *psRaw = psFile->psRawBinFile;
+    AVCBinRowPos  *pasPos;
+    int     i, nRecSize = psDecoder->nRecordSize, numRead = 0;
+    int     numRecords = psFile->hdr.psTableDef->numRecords, *panRecs;
+    GIntBig nStartPos;
+    GByte   abyRecBuf[AVCRAWBIN_READBUFSIZE], *pabyRec, *pabyAlloc=NULL;
+
+    if (psFile->eFileType != AVCFileTABLE || psRaw == NULL || nRecSize <= 0)
+        return -1;
+
+    for(i=0; i<numRows; i++)
+    {
+        if (paiRows[i] < 1 || paiRows[i] > numRecords)
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "AVCBinReadTableRecordsAt(): Record %d not in %s.",
+                     paiRows[i], psFile->pszFilename);
+            return -1;
+        }
+    }
+
+    if (numRows <= 0)
+        return 0;
+
+    /* The whole file is in the buffer: records are taken from it */
+    if (psRaw->nOffset == 0 && 
+        psRaw->nCurSize >= (GIntBig)numRecords*nRecSize)
+    {
+        panRecs = (int*)CPLMalloc(numRows*sizeof(int));
+        for(i=0; i<numRows; i++)
+            panRecs[i] = paiRows[i]-1;
+
+        _AVCBinDecodeTableBlock(psRaw->pabyBuf, numRows, panRecs, 
+                                psDecoder, papDest, iFirstDest);
+        CPLFree(panRecs);
+
+        return numRows;
+    }
+
+    pasPos = (AVCBinRowPos*)CPLMalloc(numRows*sizeof(AVCBinRowPos));
+    for(i=0; i<numRows; i++)
+    {
+        pasPos[i].iRow = paiRows[i];
+        pasPos[i].iPos = i;
+    }
+
+    qsort(pasPos, numRows, sizeof(AVCBinRowPos), _AVCBinCompareRowPos);
+
+    if (nRecSize > AVCRAWBIN_READBUFSIZE)
+        pabyAlloc = (GByte*)CPLMalloc(nRecSize);
+    pabyRec = (pabyAlloc ? pabyAlloc : abyRecBuf);
+
+    for(i=0; i<numRows; i++)
+    {
+        /* A repeated row is decoded again from the same bytes */
+        if (i == 0 || pasPos[i].iRow != pasPos[i-1].iRow)
+        {
+            nStartPos = (GIntBig)(pasPos[i].iRow-1)*nRecSize;
+            AVCRawBinFSeek(psRaw, nStartPos, SEEK_SET);
+            AVCRawBinReadBytes(psRaw, nRecSize, pabyRec);
+
+            if (psRaw->nOffset + psRaw->nCurPos - nStartPos < nRecSize)
+            {
+                numRead = -1;
+                break;
+            }
+        }
+
+        _AVCBinDecodeTableBlock(pabyRec, 1, NULL, psDecoder, papDest, 
+                                iFirstDest + pasPos[i].iPos);
+        numRead++;
+    }
+
+    CPLFree(pabyAlloc);
+    CPLFree(pasPos);
+
+    return numRead;
+}
+
 
@@ -87,9 +87,7 @@ AVCBinFile *AVCBinWriteCreate(const char *pszPath, const char *pszName,
                               AVCFileType eType, int nPrecision)
 {
     AVCBinFile   *psFile;
-    char         *pszFname = NULL, *pszExt;
-    GBool        bCreateIndex = FALSE;
-    int          nLen;
+    char         *pszFname = NULL;
 
     /*-----------------------------------------------------------------
      * Make sure precision value is valid (AVC_DEFAULT_PREC is NOT valid)
@@ -154,41 +152,9 @@ AVCBinFile *AVCBinWriteCreate(const char *pszPath, const char *pszName,
 
     /*-----------------------------------------------------------------
      * Create an Index file if applicable for current file type.
-     * Yep, we'll have a problem if filenames come in as uppercase, but
-     * this should not happen in a normal situation.
      *----------------------------------------------------------------*/
-    pszFname = CPLStrdup(psFile->pszFilename);
-    nLen = strlen(pszFname);
-    if (eType == AVCFileARC &&
-        ( (nLen>=4 && EQUALN((pszExt=pszFname+nLen-3)-1, ".arc", 4)) ||
-          (nLen>=7 && EQUALN((pszExt=pszFname+nLen-7), "arc.adf", 7)) ) )
-    {
-        memcpy(pszExt, "arx", 3);
-        bCreateIndex = TRUE;
-    }
-    else if ((eType == AVCFilePAL || eType == AVCFileRPL) &&
-             ( (nLen>=4 && EQUALN((pszExt=pszFname+nLen-3)-1, ".pal", 4)) ||
-               (nLen>=7 && EQUALN((pszExt=pszFname+nLen-7), "pal.adf", 7)) ) )
-    {
-        memcpy(pszExt, "pax", 3);
-        bCreateIndex = TRUE;
-    }
-    else if (eType == AVCFileCNT &&
-             ( (nLen>=4 && EQUALN((pszExt=pszFname+nLen-3)-1, ".cnt", 4)) ||
-               (nLen>=7 && EQUALN((pszExt=pszFname+nLen-7), "cnt.adf", 7)) ) )
-    {
-        memcpy(pszExt, "cnx", 3);
-        bCreateIndex = TRUE;
-    }
-    else if ((eType == AVCFileTXT || eType == AVCFileTX6) &&
-             ( (nLen>=4 && EQUALN((pszExt=pszFname+nLen-3)-1, ".txt", 4)) ||
-               (nLen>=7 && EQUALN((pszExt=pszFname+nLen-7), "txt.adf", 7)) ) )
-    {
-        memcpy(pszExt, "txx", 3);
-        bCreateIndex = TRUE;
-    }
-
-    if (bCreateIndex)
+    pszFname = _AVCBinGetIndexFilename(psFile->pszFilename, eType);
+    if (pszFname)
     {
         psFile->psIndexFile = AVCRawBinOpen(pszFname, "w");
     }
@@ -352,9 +318,9 @@ void    AVCBinWriteClose(AVCBinFile *psFile)
           psFile->nPrecision == AVC_DOUBLE_PREC) ) )
     {
         GInt32 n32Size;
-        n32Size = psFile->psRawBinFile->nCurPos/2;
+        n32Size = (GInt32)(psFile->psRawBinFile->nOffset/2);
 
-        VSIFSeek(psFile->psRawBinFile->fp, 24, SEEK_SET);
+        VSIFSeekL(psFile->psRawBinFile->fp, 24, SEEK_SET);
         AVCRawBinWriteInt32(psFile->psRawBinFile, n32Size);
     }
         
@@ -367,9 +333,9 @@ void    AVCBinWriteClose(AVCBinFile *psFile)
     if (psFile->psIndexFile)
     {
         GInt32 n32Size;
-        n32Size = psFile->psIndexFile->nCurPos/2;
+        n32Size = (GInt32)(psFile->psIndexFile->nOffset/2);
 
-        VSIFSeek(psFile->psIndexFile->fp, 24, SEEK_SET);
+        VSIFSeekL(psFile->psIndexFile->fp, 24, SEEK_SET);
         AVCRawBinWriteInt32(psFile->psIndexFile, n32Size);
 
         AVCRawBinClose(psFile->psIndexFile);
@@ -489,7 +455,7 @@ int _AVCBinWriteArc(AVCRawBinFile *psFile, AVCArc *psArc,
 {
     int         i, nRecSize, nCurPos;
 
-    nCurPos = psFile->nCurPos/2;  /* Value in 2 byte words */
+    nCurPos = (int)(psFile->nOffset/2);  /* Value in 2 byte words */
 
     AVCRawBinWriteInt32(psFile, psArc->nArcId);
     if (CPLGetLastErrorNo() != 0)
@@ -588,7 +554,7 @@ int _AVCBinWritePal(AVCRawBinFile *psFile, AVCPal *psPal,
 {
     int i, nRecSize, nCurPos;
 
-    nCurPos = psFile->nCurPos/2;  /* Value in 2 byte words */
+    nCurPos = (int)(psFile->nOffset/2);  /* Value in 2 byte words */
 
     AVCRawBinWriteInt32(psFile, psPal->nPolyId);
     if (CPLGetLastErrorNo() != 0)
@@ -683,7 +649,7 @@ int _AVCBinWriteCnt(AVCRawBinFile *psFile, AVCCnt *psCnt,
 {
     int i, nRecSize, nCurPos;
 
-    nCurPos = psFile->nCurPos/2;  /* Value in 2 byte words */
+    nCurPos = (int)(psFile->nOffset/2);  /* Value in 2 byte words */
 
     AVCRawBinWriteInt32(psFile, psCnt->nPolyId);
     if (CPLGetLastErrorNo() != 0)
@@ -956,7 +922,7 @@ int _AVCBinWriteTxt(AVCRawBinFile *psFile, AVCTxt *psTxt,
 {
     int i, nRecSize, nCurPos, nStrLen, numVertices;
 
-    nCurPos = psFile->nCurPos/2;  /* Value in 2 byte words */
+    nCurPos = (int)(psFile->nOffset/2);  /* Value in 2 byte words */
 
     AVCRawBinWriteInt32(psFile, psTxt->nTxtId);
     if (CPLGetLastErrorNo() != 0)
@@ -1310,7 +1276,7 @@ int _AVCBinWriteCreateArcDirEntry(const char *pszArcDirFile,
      * ARC.DIR does not have a header and we will close it right away.
      *----------------------------------------------------------------*/
     if (bFound)
-        VSIFSeek(hRawBinFile->fp, iEntry*380, SEEK_SET);
+        VSIFSeekL(hRawBinFile->fp, (vsi_l_offset)iEntry*380, SEEK_SET);
     else
     {
         /* Not found... Use the next logical table index */
@@ -0,0 +1,686 @@
+/**********************************************************************
+ * Name:     avc_e00compr.c
+ * Project:  Arc/Info vector coverage (AVC)  E00->BIN conversion library
+ * Language: ANSI C
+ * Purpose:  Read the lines of an E00 file, expanding them on the fly
+ *           if the file is compressed (EXP  1), and compress E00 lines.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************
+ *
+ * In a compressed E00 file, the header line ("EXP  1 ...") is followed
+ * by a stream of characters cut in physical lines of 80 characters,
+ * whose ends mean nothing.  The lines of the E00 file are encoded in
+ * this stream with escape sequences that start with '~':
+ *
+ *   "~}"        the end of a line.
+ *   "~ c"       (c - ' ') spaces.
+ *   "~~", "~-"  a '~' or a '-'.
+ *   "~c..."     with c from '!' to 'z', a number (below).  It ends
+ *               with a ' ' or a '~', which are not part of it.  After
+ *               a number, "~c" is just c, unless c is ' ' or '}'.
+ *
+ * For a number, (c - '!') % 15 is the position of the decimal point
+ * in its digits (0 if there is none), and (c - '!') / 15 tells if the
+ * last two digits are an exponent ("E+" if it is 1 or 4, "E-" if 2 or
+ * 5) and if the number of digits is odd (3 to 5): the last one of the
+ * pairs is then dropped.  Each of the next characters is a pair of
+ * digits, from '!' (00) to '|' (91), or '}' followed by the pair minus
+ * 92 ('!' for 92 to '(' for 99).
+ *
+ * Nothing is expanded in a file that is not compressed: its lines are
+ * returned as they are, from the blocks in which the file is read.
+ *
+ * The compressor encodes as numbers the runs of digits (with a decimal
+ * point and a two digit exponent, if any) that are shorter that way,
+ * and the runs of more than two spaces.
+ **********************************************************************/
+
+#include "avc.h"
+
+#include <ctype.h>      /* isdigit() */
+#include <limits.h>     /* for INT_MAX */
+
+/* Size of the blocks in which the E00 file is read, which grow if a
+ * line does not fit in one
+ */
+#define AVC_E00_INPUT_BLOCK_SIZE    (1024*1024)
+
+static char _AVCE00InputGetChar(AVCE00InputPtr psInfo);
+
+/**********************************************************************
+ *                          AVCE00InputOpen()
+ *
+ * Start reading the lines of the E00 file fp, which has to stay open
+ * (and is not closed) until AVCE00InputClose() is called.  Whether the
+ * file is compressed is found when its first line is read.  The file
+ * is read ahead by blocks: it must not be read by anything else in the
+ * meantime.
+ *
+ * The handle will eventually have to be released with
+ * AVCE00InputClose().
+ **********************************************************************/
+AVCE00InputPtr AVCE00InputOpen(VSILFILE *fp)
+{
+    AVCE00InputPtr psInfo;
+
+    psInfo = (AVCE00InputPtr)CPLCalloc(1, sizeof(struct AVCE00InputInfo_t));
+    psInfo->fp = fp;
+
+    psInfo->nBlockSize = AVC_E00_INPUT_BLOCK_SIZE;
+    psInfo->pszBlock = (char *)CPLMalloc(psInfo->nBlockSize);
+
+    return psInfo;
+}
+
+/**********************************************************************
+ *                          AVCE00InputClose()
+ **********************************************************************/
+void AVCE00InputClose(AVCE00InputPtr psInfo)
+{
+    CPLFree(psInfo->pszBlock);
+    CPLFree(psInfo);
+}
+
+/**********************************************************************
+ *                          _AVCE00InputFillBlock()
+ *
+ * Read more of the file after the bytes of the block that are not
+ * returned yet, which are first moved to its start.  The block is
+ * made larger when they fill it.  bFileEOF is set when nothing more
+ * can be read.
+ *
+ * Returns FALSE if the line would not fit in memory (a CPLError() is
+ * then produced).
+ **********************************************************************/
+static GBool _AVCE00InputFillBlock(AVCE00InputPtr psInfo)
+{
+    int nRead;
+
+    if (psInfo->iBlockPos > 0)
+    {
+        memmove(psInfo->pszBlock, psInfo->pszBlock + psInfo->iBlockPos,
+                psInfo->nBlockLen - psInfo->iBlockPos);
+        psInfo->nBlockLen -= psInfo->iBlockPos;
+        psInfo->iBlockPos = 0;
+    }
+
+    /* One byte is kept for the '\0' of a last line without its end
+     */
+    if (psInfo->nBlockLen + 1 >= psInfo->nBlockSize)
+    {
+        if (psInfo->nBlockSize > INT_MAX / 2)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Line %d of the E00 file is too long.",
+                     psInfo->nLineNo + 1);
+            return FALSE;
+        }
+        psInfo->nBlockSize *= 2;
+        psInfo->pszBlock = (char *)CPLRealloc(psInfo->pszBlock,
+                                              psInfo->nBlockSize);
+    }
+
+    nRead = (int)VSIFReadL(psInfo->pszBlock + psInfo->nBlockLen, 1,
+                           psInfo->nBlockSize - psInfo->nBlockLen - 1,
+                           psInfo->fp);
+    psInfo->nBlockLen += nRead;
+    if (nRead == 0)
+        psInfo->bFileEOF = TRUE;
+
+    return TRUE;
+}
+
+/**********************************************************************
+ *                          _AVCE00InputReadLine()
+ *
+ * Return the next physical line of the file, without its end (a CR, a
+ * LF or both, as with CPLReadLineL()), and set *pnLen to its length.
+ *
+ * The line is found with memchr() in the current block and its end is
+ * replaced by a '\0' there: it is not copied, and is valid until the
+ * next call.  Returns NULL at the end of the file.
+ **********************************************************************/
+static const char *_AVCE00InputReadLine(AVCE00InputPtr psInfo, int *pnLen)
+{
+    char       *pszLine, *pszLF, *pszCR, *pszEnd;
+    int         nAvail;
+
+    for ( ; ; )
+    {
+        pszLine = psInfo->pszBlock + psInfo->iBlockPos;
+        nAvail = psInfo->nBlockLen - psInfo->iBlockPos;
+
+        pszLF = (char *)memchr(pszLine, '\n', nAvail);
+        pszEnd = pszLF ? pszLF : pszLine + nAvail;
+        pszCR = (char *)memchr(pszLine, '\r', pszEnd - pszLine);
+
+        /* A CR that is the last byte read may be followed by a LF in
+         * the next block: it is only taken when more has been read
+         */
+        if (pszCR != NULL &&
+            (pszCR + 1 < pszLine + nAvail || psInfo->bFileEOF))
+        {
+            pszEnd = pszCR;
+            psInfo->iBlockPos += (int)(pszCR - pszLine) + 1;
+            if (pszCR + 1 == pszLF)
+                psInfo->iBlockPos++;
+            break;
+        }
+        else if (pszLF != NULL)
+        {
+            psInfo->iBlockPos += (int)(pszLF - pszLine) + 1;
+            break;
+        }
+        else if (psInfo->bFileEOF)
+        {
+            if (nAvail == 0)
+                return NULL;
+            psInfo->iBlockPos = psInfo->nBlockLen;
+            break;
+        }
+        else if (!_AVCE00InputFillBlock(psInfo))
+        {
+            return NULL;
+        }
+    }
+
+    *pszEnd = '\0';
+    *pnLen = (int)(pszEnd - pszLine);
+
+    return pszLine;
+}
+
+/**********************************************************************
+ *                          _AVCE00InputGetChar()
+ *
+ * Return the next character of the compressed stream, reading its
+ * next physical line when needed, or '\0' at the end of the file.
+ **********************************************************************/
+static char _AVCE00InputGetChar(AVCE00InputPtr psInfo)
+{
+    int nLen;
+
+    while (!psInfo->bEOF &&
+           (psInfo->pszInBuf == NULL ||
+            psInfo->pszInBuf[psInfo->iInBufPtr] == '\0'))
+    {
+        /* The line stays in the block until the next call */
+        psInfo->pszInBuf = _AVCE00InputReadLine(psInfo, &nLen);
+        psInfo->iInBufPtr = 0;
+        if (psInfo->pszInBuf == NULL)
+            psInfo->bEOF = TRUE;
+    }
+
+    if (psInfo->bEOF)
+        return '\0';
+
+    return psInfo->pszInBuf[psInfo->iInBufPtr++];
+}
+
+/**********************************************************************
+ *                          _AVCE00InputUncompressLine()
+ *
+ * Expand the next line of a compressed E00 file into szOutBuf, and
+ * set *pnLen to its length.
+ *
+ * Returns NULL at the end of the file, or if the stream is invalid (a
+ * CPLError() is then produced).
+ **********************************************************************/
+static const char *_AVCE00InputUncompressLine(AVCE00InputPtr psInfo,
+                                              int *pnLen)
+{
+    char       *pszOut = psInfo->szOutBuf;
+    char        c;
+    const char *pszExp;
+    int         iOut = 0, i, n, nDotPos, nDigits, iDigit;
+    GBool       bEOL = FALSE, bOddDigits, bPrevNumeric = FALSE;
+
+    while (!bEOL && (c = _AVCE00InputGetChar(psInfo)) != '\0')
+    {
+        /* The longest code adds 5 characters (a pair of digits, a
+         * decimal point and an exponent sign)
+         */
+        if (iOut > AVC_E00_MAX_LINE_LEN - 5)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Line %d of the compressed E00 file is too long.",
+                     psInfo->nLineNo + 1);
+            return NULL;
+        }
+
+        if (c != '~')
+        {
+            pszOut[iOut++] = c;
+            bPrevNumeric = FALSE;
+            continue;
+        }
+
+        c = _AVCE00InputGetChar(psInfo);
+
+        if (c == '\0')
+        {
+            break;
+        }
+        else if (c == ' ')
+        {
+            /* "~ c": (c - ' ') spaces
+             */
+            n = _AVCE00InputGetChar(psInfo) - ' ';
+            if (n < 0 || iOut + n > AVC_E00_MAX_LINE_LEN)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Invalid run of spaces in line %d of the "
+                         "compressed E00 file.", psInfo->nLineNo + 1);
+                return NULL;
+            }
+            for (i = 0; i < n; i++)
+                pszOut[iOut++] = ' ';
+            bPrevNumeric = FALSE;
+        }
+        else if (c == '}')
+        {
+            bEOL = TRUE;
+        }
+        else if (bPrevNumeric || c == '~' || c == '-')
+        {
+            /* A '~' after a number only ends it
+             */
+            pszOut[iOut++] = c;
+            bPrevNumeric = FALSE;
+        }
+        else if (c >= '!' && c <= 'z')
+        {
+            /*---------------------------------------------------------
+             * A number: its format, then its pairs of digits
+             *--------------------------------------------------------*/
+            n = c - '!';
+            nDotPos = n % 15;
+            bOddDigits = (n / 45 == 1);
+            pszExp = (n / 15) % 3 == 1 ? "E+" :
+                     (n / 15) % 3 == 2 ? "E-" : NULL;
+
+            nDigits = 0;
+            while ((c = _AVCE00InputGetChar(psInfo)) != '\0' &&
+                   c != ' ' && c != '~')
+            {
+                n = c - '!';
+                if (n == 92 && (c = _AVCE00InputGetChar(psInfo)) != '\0')
+                    n += c - '!';
+                if (n < 0 || n > 99 || iOut > AVC_E00_MAX_LINE_LEN - 6)
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Invalid number in line %d of the "
+                             "compressed E00 file.", psInfo->nLineNo + 1);
+                    return NULL;
+                }
+
+                for (iDigit = 0; iDigit < 2; iDigit++)
+                {
+                    pszOut[iOut++] = (char)('0' + (iDigit == 0 ? n / 10
+                                                               : n % 10));
+                    if (++nDigits == nDotPos)
+                        pszOut[iOut++] = '.';
+                }
+            }
+
+            /* The ' ' or '~' that ended the number is read again
+             */
+            if (c != '\0')
+            {
+                psInfo->iInBufPtr--;
+                bPrevNumeric = TRUE;
+            }
+
+            if (bOddDigits)
+            {
+                nDigits--;
+                iOut--;
+            }
+
+            if (nDigits < (pszExp ? 2 : 0) || iOut < 0)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Invalid number in line %d of the "
+                         "compressed E00 file.", psInfo->nLineNo + 1);
+                return NULL;
+            }
+
+            /* The exponent is made of the last two digits
+             */
+            if (pszExp)
+            {
+                pszOut[iOut+1] = pszOut[iOut-1];
+                pszOut[iOut] = pszOut[iOut-2];
+                pszOut[iOut-2] = pszExp[0];
+                pszOut[iOut-1] = pszExp[1];
+                iOut += 2;
+            }
+        }
+        else
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid code \"~%c\" in line %d of the compressed "
+                     "E00 file.", c, psInfo->nLineNo + 1);
+            return NULL;
+        }
+    }
+
+    /* The last line may not have its "~}"
+     */
+    if (!bEOL && iOut == 0)
+        return NULL;
+
+    pszOut[iOut] = '\0';
+    *pnLen = iOut;
+
+    return pszOut;
+}
+
+/**********************************************************************
+ *                          AVCE00InputNextLine()
+ *
+ * Return the next line of the E00 file, expanded if the file is
+ * compressed, in which case its header line says "EXP  0" in place of
+ * "EXP  1": the lines can be passed to AVCE00WriteNextLine() as those
+ * of any E00 file, with their length, which is set in *pnLineLen.
+ *
+ * The line belongs to the handle and is valid until the next call.
+ * Returns NULL at the end of the file, or if a compressed line is
+ * invalid (a CPLError() is then produced).
+ **********************************************************************/
+const char *AVCE00InputNextLine(AVCE00InputPtr psInfo, int *pnLineLen)
+{
+    const char *pszLine;
+    int         nLen;
+
+    if (psInfo->nLineNo == 0)
+    {
+        if ((pszLine = _AVCE00InputReadLine(psInfo, &nLen)) == NULL)
+            return NULL;
+
+        psInfo->nLineNo++;
+        psInfo->bCompressed = EQUALN(pszLine, "EXP  1", 6);
+        if (!psInfo->bCompressed)
+        {
+            *pnLineLen = nLen;
+            return pszLine;
+        }
+
+        nLen = MIN(nLen, AVC_E00_MAX_LINE_LEN);
+        memcpy(psInfo->szOutBuf, pszLine, nLen);
+        psInfo->szOutBuf[nLen] = '\0';
+        psInfo->szOutBuf[5] = '0';
+
+        *pnLineLen = nLen;
+        return psInfo->szOutBuf;
+    }
+
+    if (!psInfo->bCompressed)
+        pszLine = _AVCE00InputReadLine(psInfo, &nLen);
+    else
+        pszLine = _AVCE00InputUncompressLine(psInfo, &nLen);
+
+    if (pszLine != NULL)
+    {
+        psInfo->nLineNo++;
+        *pnLineLen = nLen;
+    }
+
+    return pszLine;
+}
+
+/**********************************************************************
+ *                          AVCE00CompressorAlloc()
+ *
+ * Allocate a compressor, which takes E00 lines with
+ * AVCE00CompressLine() and returns the lines of the compressed E00
+ * file with AVCE00CompressNextLine().
+ *
+ * The structure will eventually have to be freed with
+ * AVCE00CompressorFree().
+ **********************************************************************/
+AVCE00Compressor *AVCE00CompressorAlloc()
+{
+    return (AVCE00Compressor *)CPLCalloc(1, sizeof(AVCE00Compressor));
+}
+
+/**********************************************************************
+ *                          AVCE00CompressorFree()
+ **********************************************************************/
+void AVCE00CompressorFree(AVCE00Compressor *psInfo)
+{
+    if (psInfo)
+    {
+        CPLFree(psInfo->pszBuf);
+        CPLFree(psInfo);
+    }
+}
+
+/**********************************************************************
+ *                          AVCE00CompressorReset()
+ *
+ * Forget the lines not yet returned, to start a new file.
+ **********************************************************************/
+void AVCE00CompressorReset(AVCE00Compressor *psInfo)
+{
+    psInfo->nLines = 0;
+    psInfo->bHeader = FALSE;
+    psInfo->nBufLen = 0;
+}
+
+/**********************************************************************
+ *                          _AVCE00CompressAppend()
+ *
+ * Append nLen characters to the compressed stream.
+ **********************************************************************/
+static void _AVCE00CompressAppend(AVCE00Compressor *psInfo,
+                                  const char *pszCode, int nLen)
+{
+    if (psInfo->nBufLen + nLen > psInfo->nBufSize)
+    {
+        psInfo->nBufSize = MAX(2*psInfo->nBufSize,
+                               psInfo->nBufLen + nLen + 256);
+        psInfo->pszBuf = (char*)CPLRealloc(psInfo->pszBuf,
+                                           psInfo->nBufSize);
+    }
+
+    memcpy(psInfo->pszBuf + psInfo->nBufLen, pszCode, nLen);
+    psInfo->nBufLen += nLen;
+}
+
+/**********************************************************************
+ *                          _AVCE00CompressNumber()
+ *
+ * Encode the number that starts with the digit at pszNum into
+ * pszCode, if that makes it shorter.
+ *
+ * Returns the number of characters of the number that were encoded,
+ * with the length of the code in *pnCodeLen, or 0 if the number is
+ * better left as it is.  *pnRawLen is set in any case to the length
+ * of the number.
+ **********************************************************************/
+static int _AVCE00CompressNumber(const char *pszNum, char *pszCode,
+                                 int *pnCodeLen, int *pnRawLen)
+{
+    char    szDigits[AVC_E00_COMPR_LINE_LEN+2];
+    int     nLen = 0, nDigits = 0, nDotPos = 0, nExp = 0, nCodeLen, i, n;
+
+    for ( ; isdigit((unsigned char)pszNum[nLen]) &&
+            nDigits < AVC_E00_COMPR_LINE_LEN; nLen++)
+        szDigits[nDigits++] = pszNum[nLen];
+
+    if (pszNum[nLen] == '.' && nDigits < 15)
+    {
+        nDotPos = nDigits;
+        for (nLen++; isdigit((unsigned char)pszNum[nLen]) &&
+                     nDigits < AVC_E00_COMPR_LINE_LEN; nLen++)
+            szDigits[nDigits++] = pszNum[nLen];
+    }
+
+    if (pszNum[nLen] == 'E' &&
+        (pszNum[nLen+1] == '+' || pszNum[nLen+1] == '-') &&
+        isdigit((unsigned char)pszNum[nLen+2]) &&
+        isdigit((unsigned char)pszNum[nLen+3]) &&
+        !isdigit((unsigned char)pszNum[nLen+4]))
+    {
+        nExp = (pszNum[nLen+1] == '+') ? 1 : 2;
+        szDigits[nDigits++] = pszNum[nLen+2];
+        szDigits[nDigits++] = pszNum[nLen+3];
+        nLen += 4;
+    }
+
+    *pnRawLen = nLen;
+
+    /* A '}' after the number would be taken as part of it, and so
+     * would a digit if the number was cut
+     */
+    if (pszNum[nLen] == '}' || isdigit((unsigned char)pszNum[nLen]))
+        return 0;
+
+    if (nDigits % 2 == 1)
+        szDigits[nDigits] = '0';
+
+    pszCode[0] = '~';
+    pszCode[1] = (char)('!' + nDotPos + 15*(nExp + 3*(nDigits % 2)));
+    nCodeLen = 2;
+    for (i = 0; i < nDigits; i += 2)
+    {
+        n = (szDigits[i] - '0')*10 + (szDigits[i+1] - '0');
+        if (n < 92)
+        {
+            pszCode[nCodeLen++] = (char)('!' + n);
+        }
+        else
+        {
+            pszCode[nCodeLen++] = '}';
+            pszCode[nCodeLen++] = (char)('!' + n - 92);
+        }
+    }
+
+    if (nCodeLen >= nLen)
+        return 0;
+
+    *pnCodeLen = nCodeLen;
+
+    return nLen;
+}
+
+/**********************************************************************
+ *                          AVCE00CompressLine()
+ *
+ * Add the next E00 line to the compressed stream.  The first line,
+ * "EXP  0 ...", is returned alone, as "EXP  1 ...".
+ **********************************************************************/
+void AVCE00CompressLine(AVCE00Compressor *psInfo, const char *pszLine)
+{
+    char    szCode[2*AVC_E00_COMPR_LINE_LEN+8];
+    int     nCodeLen, nRawLen, nSpaces, i;
+    GBool   bPrevNumeric = FALSE;
+
+    if (psInfo->nLines++ == 0 && EQUALN(pszLine, "EXP  0", 6))
+    {
+        strncpy(psInfo->szLine, pszLine, AVC_E00_MAX_LINE_LEN);
+        psInfo->szLine[AVC_E00_MAX_LINE_LEN] = '\0';
+        psInfo->szLine[5] = '1';
+        psInfo->bHeader = TRUE;
+        return;
+    }
+
+    for (i = 0; pszLine[i] != '\0'; )
+    {
+        if (pszLine[i] == ' ')
+        {
+            for (nSpaces = 1; pszLine[i+nSpaces] == ' ' &&
+                              nSpaces < AVC_E00_COMPR_LINE_LEN; nSpaces++) {}
+
+            if (nSpaces > 2)
+            {
+                szCode[0] = '~';
+                szCode[1] = ' ';
+                szCode[2] = (char)(' ' + nSpaces);
+                _AVCE00CompressAppend(psInfo, szCode, 3);
+            }
+            else
+            {
+                _AVCE00CompressAppend(psInfo, pszLine + i, nSpaces);
+            }
+            i += nSpaces;
+            bPrevNumeric = FALSE;
+        }
+        else if (isdigit((unsigned char)pszLine[i]) &&
+                 _AVCE00CompressNumber(pszLine + i, szCode, &nCodeLen,
+                                       &nRawLen) > 0)
+        {
+            _AVCE00CompressAppend(psInfo, szCode, nCodeLen);
+            i += nRawLen;
+            bPrevNumeric = TRUE;
+        }
+        else
+        {
+            /* A number left as it is, or another character.  After a
+             * number, anything but a space needs a '~'
+             */
+            if (!isdigit((unsigned char)pszLine[i]))
+                nRawLen = 1;
+
+            if (bPrevNumeric || pszLine[i] == '~')
+                _AVCE00CompressAppend(psInfo, "~", 1);
+            _AVCE00CompressAppend(psInfo, pszLine + i, nRawLen);
+            i += nRawLen;
+            bPrevNumeric = FALSE;
+        }
+    }
+
+    _AVCE00CompressAppend(psInfo, "~}", 2);
+}
+
+/**********************************************************************
+ *                          AVCE00CompressNextLine()
+ *
+ * Return the next line of the compressed E00 file, or NULL if there
+ * is not yet a whole line to return.  With bFlush, the last line is
+ * returned even if it is shorter.
+ *
+ * The line belongs to the compressor and is valid until the next call.
+ **********************************************************************/
+const char *AVCE00CompressNextLine(AVCE00Compressor *psInfo, GBool bFlush)
+{
+    int     nLen;
+
+    if (psInfo->bHeader)
+    {
+        psInfo->bHeader = FALSE;
+        return psInfo->szLine;
+    }
+
+    if (psInfo->nBufLen == 0 ||
+        (psInfo->nBufLen < AVC_E00_COMPR_LINE_LEN && !bFlush))
+        return NULL;
+
+    nLen = MIN(psInfo->nBufLen, AVC_E00_COMPR_LINE_LEN);
+    memcpy(psInfo->szLine, psInfo->pszBuf, nLen);
+    psInfo->szLine[nLen] = '\0';
+
+    psInfo->nBufLen -= nLen;
+    memmove(psInfo->pszBuf, psInfo->pszBuf + nLen, psInfo->nBufLen);
+
+    return psInfo->szLine;
+}
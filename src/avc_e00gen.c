@@ -126,13 +126,13 @@ void    AVCE00GenReset(AVCE00GenInfo  *psInfo)
 static int  _PrintRealValue(char *pszBuf, int nPrecision, AVCFileType eType,
                             double dValue)
 {
-    static int numExpDigits=-1;
+    static CPL_THREADLOCAL int numExpDigits=-1;
     int        nLen = 0;
 
     /* WIN32 systems' printf for floating point output generates 3
      * digits exponents (ex: 1.23E+012), but E00 files must have 2 digits
      * exponents (ex: 1.23E+12).
-     * Run a test (only once per prg execution) to establish the number
+     * Run a test (only once per thread) to establish the number
      * of exponent digits on the current platform.
      */
     if (numExpDigits == -1)
@@ -54,6 +54,7 @@
 #include "avc.h"
 
 #include <ctype.h>      /* toupper() */
+#include <locale.h>     /* localeconv() */
 
 
 /**********************************************************************
@@ -64,28 +65,138 @@
  * takes only the specified number of characters... so it can handle the 
  * case of 2 numbers that are part of the same string but are not separated 
  * by a space.
+ *
+ * The string is read up to numChars characters or its '\0', and is not
+ * modified.
  **********************************************************************/
 int    AVCE00Str2Int(const char *pszStr, int numChars)
 {
-    int nValue = 0;
+    if (pszStr == NULL)
+        return 0;
+
+    return _AVCParseFixInt(pszStr, numChars);
+}
+
+/**********************************************************************
+ *                          AVCE00Str2Dbl()
+ *
+ * Convert a real value of an E00 line to a double.  The values are
+ * written with "%10.7E", "%17.14E" or "%20.17E" after a sign or a
+ * space, so numChars is 14, 21 or 24, and the next value may follow
+ * without a space.
+ *
+ * The string is read up to numChars characters or its '\0', and is not
+ * modified.  The result is the same as strtod() on a copy of those
+ * characters in the "C" locale, whatever the current locale is.
+ *
+ * As in _AVCParseFixNum(), the digits of the mantissa are accumulated
+ * in an integer and scaled by _AVCScalePow10(), so the result is 
+ * correctly rounded as strtod()'s.  The other values (most of the 18 
+ * digits of "%20.17E", exponents out of range, ...) go through strtod().
+ **********************************************************************/
+double AVCE00Str2Dbl(const char *pszStr, int numChars)
+{
+    int         i = 0, j, bNeg = FALSE, bExpNeg, numMantChars = 0;
+    int         numDigits = 0, numDecimals = 0, numExpDigits, nExp = 0;
+    GUIntBig    nMantissa = 0;
+    char        szBuf[100], *pszBuf, *pszDot;
+    const char *pszPoint;
+    double      dValue;
+
+    if (pszStr == NULL)
+        return 0.0;
+
+    while (i < numChars && pszStr[i] != '\0' && 
+           isspace((unsigned char)pszStr[i]))
+        i++;
+
+    if (i < numChars && (pszStr[i] == '-' || pszStr[i] == '+'))
+        bNeg = (pszStr[i++] == '-');
+
+    /* numDigits counts the digits from the first one that is not 0,
+     * which are accumulated while they cannot overflow
+     */
+    for( ; i < numChars && pszStr[i] >= '0' && pszStr[i] <= '9'; i++)
+    {
+        if (numDigits > 0 || pszStr[i] != '0')
+            numDigits++;
+        if (numDigits <= 19)
+            nMantissa = nMantissa*10 + (pszStr[i] - '0');
+        numMantChars++;
+    }
+
+    if (i < numChars && pszStr[i] == '.')
+    {
+        for(i++; i < numChars && pszStr[i] >= '0' && pszStr[i] <= '9'; i++)
+        {
+            if (numDigits > 0 || pszStr[i] != '0')
+                numDigits++;
+            if (numDigits <= 19)
+                nMantissa = nMantissa*10 + (pszStr[i] - '0');
+            numMantChars++;
+            numDecimals++;
+        }
+    }
 
-    if (pszStr && numChars >= (int)strlen(pszStr))
-        return atoi(pszStr);
-    else if (pszStr)
+    /* An exponent without digits is not part of the number
+     */
+    if (numMantChars > 0 && i < numChars &&
+        (pszStr[i] == 'E' || pszStr[i] == 'e'))
     {
-        char cNextDigit;
-        char *pszTmp;
+        j = i + 1;
+        bExpNeg = FALSE;
+        if (j < numChars && (pszStr[j] == '-' || pszStr[j] == '+'))
+            bExpNeg = (pszStr[j++] == '-');
 
-        /* Get rid of const */
-        pszTmp = (char*)pszStr;
+        for(numExpDigits = 0;
+            j < numChars && pszStr[j] >= '0' && pszStr[j] <= '9';
+            j++, numExpDigits++)
+        {
+            if (nExp < 10000)
+                nExp = nExp*10 + (pszStr[j] - '0');
+        }
 
-        cNextDigit = pszTmp[numChars];
-        pszTmp[numChars] = '\0';
-        nValue = atoi(pszTmp);
-        pszTmp[numChars] = cNextDigit;
+        if (numExpDigits > 0)
+        {
+            i = j;
+            nExp = bExpNeg ? -nExp : nExp;
+        }
     }
 
-    return nValue;
+    /* The number must end where strtod() would stop: at the end of the
+     * field, or at the start of the next value.
+     */
+    if (numMantChars > 0 && numDigits <= 19 &&
+        (i == numChars || pszStr[i] == '\0' || pszStr[i] == ' ' ||
+         pszStr[i] == '-' || pszStr[i] == '+') &&
+        _AVCScalePow10(nMantissa, nExp - numDecimals, &dValue))
+    {
+        return bNeg ? -dValue : dValue;
+    }
+
+    /*-----------------------------------------------------------------
+     * Slow path: strtod() on a copy, with the decimal point of the
+     * locale
+     *----------------------------------------------------------------*/
+    if (numChars < (int)sizeof(szBuf))
+        pszBuf = szBuf;
+    else
+        pszBuf = (char*)CPLMalloc(numChars+1);
+
+    strncpy(pszBuf, pszStr, numChars);
+    pszBuf[numChars] = '\0';
+
+    pszPoint = localeconv()->decimal_point;
+    if (pszPoint[0] != '.' && pszPoint[0] != '\0' && pszPoint[1] == '\0' &&
+        (pszDot = strchr(pszBuf, '.')) != NULL)
+        *pszDot = pszPoint[0];
+
+    dValue = strtod(pszBuf, NULL);
+
+    if (pszBuf != szBuf)
+        CPLFree(pszBuf);
+
+    return dValue;
 }
 
 /**********************************************************************
@@ -390,7 +501,7 @@ AVCFileType  AVCE00ParseSectionHeader(AVCE00ParseInfo  *psInfo,
          *        sure we don't catch that second line as the beginning
          *        of a new RPL sub-section.
          *------------------------------------------------------------*/
-        if (strlen(pszLine) > 0 && !isspace(pszLine[0]) && 
+        if (pszLine[0] != '\0' && !isspace(pszLine[0]) && 
             !EQUALN(pszLine, "JABBERWOCKY", 11) &&
             !EQUALN(pszLine, "EOI", 3) &&
             ! ( psInfo->eSuperSectionType == AVCFileRPL &&
@@ -535,6 +646,11 @@ GBool  AVCE00ParseSectionEnd(AVCE00ParseInfo  *psInfo, const char *pszLine,
  *
  * Take the next line of E00 input and parse it.
  *
+ * nLineLen is the length of pszLine, which must still be terminated by
+ * a '\0' (the PRJ lines are copied as strings).  It is passed down to
+ * the AVCE00ParseNext*Line() functions below so that none of them has
+ * to call strlen() on every line.
+ *
  * Returns NULL if the current object is not complete yet (expecting
  * more lines of input) or a reference to a complete object if it
  * is complete.
@@ -553,7 +669,8 @@ GBool  AVCE00ParseSectionEnd(AVCE00ParseInfo  *psInfo, const char *pszLine,
  * psInfo->bForceEndOfSection flag will be set to TRUE since there is
  * no explicit "end of table" line in E00.
  **********************************************************************/
-void   *AVCE00ParseNextLine(AVCE00ParseInfo  *psInfo, const char *pszLine)
+void   *AVCE00ParseNextLine(AVCE00ParseInfo  *psInfo, const char *pszLine,
+                            int nLineLen)
 {
     void *psObj = NULL;
 
@@ -561,38 +678,40 @@ void   *AVCE00ParseNextLine(AVCE00ParseInfo  *psInfo, const char *pszLine)
     switch(psInfo->eFileType)
     {
       case AVCFileARC:
-        psObj = (void*)AVCE00ParseNextArcLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextArcLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFilePAL:
       case AVCFileRPL:
-        psObj = (void*)AVCE00ParseNextPalLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextPalLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFileCNT:
-        psObj = (void*)AVCE00ParseNextCntLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextCntLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFileLAB:
-        psObj = (void*)AVCE00ParseNextLabLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextLabLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFileTOL:
-        psObj = (void*)AVCE00ParseNextTolLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextTolLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFilePRJ:
-        psObj = (void*)AVCE00ParseNextPrjLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextPrjLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFileTXT:
-        psObj = (void*)AVCE00ParseNextTxtLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextTxtLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFileTX6:
-        psObj = (void*)AVCE00ParseNextTx6Line(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextTx6Line(psInfo, pszLine, nLineLen);
         break;
       case AVCFileRXP:
-        psObj = (void*)AVCE00ParseNextRxpLine(psInfo, pszLine);
+        psObj = (void*)AVCE00ParseNextRxpLine(psInfo, pszLine, nLineLen);
         break;
       case AVCFileTABLE:
         if ( ! psInfo->bTableHdrComplete )
-            psObj = (void*)AVCE00ParseNextTableDefLine(psInfo, pszLine);
+            psObj = (void*)AVCE00ParseNextTableDefLine(psInfo, pszLine,
+                                                       nLineLen);
         else
-            psObj = (void*)AVCE00ParseNextTableRecLine(psInfo, pszLine);
+            psObj = (void*)AVCE00ParseNextTableRecLine(psInfo, pszLine,
+                                                       nLineLen);
         break;
       default:
         CPLError(CE_Failure, CPLE_NotSupported,
@@ -619,7 +738,8 @@ void   *AVCE00ParseNextLine(AVCE00ParseInfo  *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCArc   *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCArc   *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCArc *psArc;
     int     nLen;
@@ -628,7 +748,7 @@ AVCArc   *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psArc = psInfo->cur.psArc;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -674,12 +794,15 @@ AVCArc   *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine)
          * Single precision ARCs: 2 pairs of X,Y values per line
          * Except on the last line with an odd number of vertices)
          *------------------------------------------------------------*/
-        psArc->pasVertices[psInfo->iCurItem].x = atof(pszLine);
-        psArc->pasVertices[psInfo->iCurItem++].y = atof(pszLine+14);
+        psArc->pasVertices[psInfo->iCurItem].x = AVCE00Str2Dbl(pszLine, 14);
+        psArc->pasVertices[psInfo->iCurItem++].y =
+                                            AVCE00Str2Dbl(pszLine+14, 14);
         if (psInfo->iCurItem < psInfo->numItems && nLen >= 56)
         {
-            psArc->pasVertices[psInfo->iCurItem].x = atof(pszLine+28);
-            psArc->pasVertices[psInfo->iCurItem++].y = atof(pszLine+42);
+            psArc->pasVertices[psInfo->iCurItem].x =
+                                            AVCE00Str2Dbl(pszLine+28, 14);
+            psArc->pasVertices[psInfo->iCurItem++].y =
+                                            AVCE00Str2Dbl(pszLine+42, 14);
         }
     }
     else if (psInfo->iCurItem < psInfo->numItems && 
@@ -689,8 +812,9 @@ AVCArc   *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine)
         /*-------------------------------------------------------------
          * Double precision ARCs: 1 pair of X,Y values per line
          *------------------------------------------------------------*/
-        psArc->pasVertices[psInfo->iCurItem].x = atof(pszLine);
-        psArc->pasVertices[psInfo->iCurItem++].y = atof(pszLine+21);
+        psArc->pasVertices[psInfo->iCurItem].x = AVCE00Str2Dbl(pszLine, 21);
+        psArc->pasVertices[psInfo->iCurItem++].y =
+                                            AVCE00Str2Dbl(pszLine+21, 21);
     }
     else
     {
@@ -731,7 +855,8 @@ AVCArc   *AVCE00ParseNextArcLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCPal   *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCPal   *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCPal *psPal;
     int     nLen;
@@ -741,7 +866,7 @@ AVCPal   *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psPal = psInfo->cur.psPal;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -780,15 +905,15 @@ AVCPal   *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
             if (psInfo->nPrecision == AVC_SINGLE_PREC)
             {
-                psPal->sMin.x = atof(pszLine + 10);
-                psPal->sMin.y = atof(pszLine + 24);
-                psPal->sMax.x = atof(pszLine + 38);
-                psPal->sMax.y = atof(pszLine + 52);
+                psPal->sMin.x = AVCE00Str2Dbl(pszLine + 10, 14);
+                psPal->sMin.y = AVCE00Str2Dbl(pszLine + 24, 14);
+                psPal->sMax.x = AVCE00Str2Dbl(pszLine + 38, 14);
+                psPal->sMax.y = AVCE00Str2Dbl(pszLine + 52, 14);
             }
             else
             {
-                psPal->sMin.x = atof(pszLine + 10);
-                psPal->sMin.y = atof(pszLine + 31);
+                psPal->sMin.x = AVCE00Str2Dbl(pszLine + 10, 21);
+                psPal->sMin.y = AVCE00Str2Dbl(pszLine + 31, 21);
                 /* Set psInfo->iCurItem = -1 since we still have 2 values
                  * from the header to read on the next line.
                  */
@@ -799,8 +924,8 @@ AVCPal   *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine)
     }
     else if (psInfo->iCurItem == -1 && nLen >= 42)
     {
-        psPal->sMax.x = atof(pszLine);
-        psPal->sMax.y = atof(pszLine + 21);
+        psPal->sMax.x = AVCE00Str2Dbl(pszLine, 21);
+        psPal->sMax.y = AVCE00Str2Dbl(pszLine + 21, 21);
         psInfo->iCurItem++;
     }
     else if (psInfo->iCurItem < psInfo->numItems && 
@@ -867,7 +992,8 @@ AVCPal   *AVCE00ParseNextPalLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCCnt   *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCCnt   *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCCnt *psCnt;
     int     nLen;
@@ -876,7 +1002,7 @@ AVCCnt   *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psCnt = psInfo->cur.psCnt;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -911,13 +1037,13 @@ AVCCnt   *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
             if (psInfo->nPrecision == AVC_SINGLE_PREC)
             {
-                psCnt->sCoord.x = atof(pszLine + 10);
-                psCnt->sCoord.y = atof(pszLine + 24);
+                psCnt->sCoord.x = AVCE00Str2Dbl(pszLine + 10, 14);
+                psCnt->sCoord.y = AVCE00Str2Dbl(pszLine + 24, 14);
             }
             else
             {
-                psCnt->sCoord.x = atof(pszLine + 10);
-                psCnt->sCoord.y = atof(pszLine + 31);
+                psCnt->sCoord.x = AVCE00Str2Dbl(pszLine + 10, 21);
+                psCnt->sCoord.y = AVCE00Str2Dbl(pszLine + 31, 21);
             }
 
             /* psInfo->iCurItem is the index of the last label that was read.
@@ -981,7 +1107,8 @@ AVCCnt   *AVCE00ParseNextCntLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCLab   *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCLab   *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCLab *psLab;
     int     nLen;
@@ -990,7 +1117,7 @@ AVCLab   *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psLab = psInfo->cur.psLab;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -1011,13 +1138,13 @@ AVCLab   *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
             if (psInfo->nPrecision == AVC_SINGLE_PREC)
             {
-                psLab->sCoord1.x = atof(pszLine + 20);
-                psLab->sCoord1.y = atof(pszLine + 34);
+                psLab->sCoord1.x = AVCE00Str2Dbl(pszLine + 20, 14);
+                psLab->sCoord1.y = AVCE00Str2Dbl(pszLine + 34, 14);
             }
             else
             {
-                psLab->sCoord1.x = atof(pszLine + 20);
-                psLab->sCoord1.y = atof(pszLine + 41);
+                psLab->sCoord1.x = AVCE00Str2Dbl(pszLine + 20, 21);
+                psLab->sCoord1.y = AVCE00Str2Dbl(pszLine + 41, 21);
             }
 
             /* psInfo->iCurItem is the index of the last X,Y pair we read.
@@ -1032,24 +1159,24 @@ AVCLab   *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine)
     else if (psInfo->iCurItem == 1 && psInfo->nPrecision == AVC_SINGLE_PREC &&
              nLen >= 56 )
     {
-        psLab->sCoord2.x = atof(pszLine);
-        psLab->sCoord2.y = atof(pszLine + 14);
-        psLab->sCoord3.x = atof(pszLine + 28);
-        psLab->sCoord3.y = atof(pszLine + 42);
+        psLab->sCoord2.x = AVCE00Str2Dbl(pszLine, 14);
+        psLab->sCoord2.y = AVCE00Str2Dbl(pszLine + 14, 14);
+        psLab->sCoord3.x = AVCE00Str2Dbl(pszLine + 28, 14);
+        psLab->sCoord3.y = AVCE00Str2Dbl(pszLine + 42, 14);
         psInfo->iCurItem += 2;
     }
     else if (psInfo->iCurItem == 1 && psInfo->nPrecision == AVC_DOUBLE_PREC &&
              nLen >= 42 )
     {
-        psLab->sCoord2.x = atof(pszLine);
-        psLab->sCoord2.y = atof(pszLine + 21);
+        psLab->sCoord2.x = AVCE00Str2Dbl(pszLine, 21);
+        psLab->sCoord2.y = AVCE00Str2Dbl(pszLine + 21, 21);
         psInfo->iCurItem++;
     }
     else if (psInfo->iCurItem == 2 && psInfo->nPrecision == AVC_DOUBLE_PREC &&
              nLen >= 42 )
     {
-        psLab->sCoord3.x = atof(pszLine);
-        psLab->sCoord3.y = atof(pszLine + 21);
+        psLab->sCoord3.x = AVCE00Str2Dbl(pszLine, 21);
+        psLab->sCoord3.y = AVCE00Str2Dbl(pszLine + 21, 21);
         psInfo->iCurItem++;
     }
     else
@@ -1093,7 +1220,8 @@ AVCLab   *AVCE00ParseNextLabLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCTol   *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCTol   *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCTol *psTol;
     int     nLen;
@@ -1102,7 +1230,7 @@ AVCTol   *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psTol = psInfo->cur.psTol;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (nLen >= 34)
     {
@@ -1113,7 +1241,7 @@ AVCTol   *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine)
         psTol->nIndex = AVCE00Str2Int(pszLine, 10);
         psTol->nFlag  = AVCE00Str2Int(pszLine + 10, 10);
 
-        psTol->dValue = atof(pszLine + 20);
+        psTol->dValue = AVCE00Str2Dbl(pszLine + 20, nLen - 20);
     }
     else
     {
@@ -1160,7 +1288,8 @@ AVCTol   *AVCE00ParseNextTolLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-char  **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+char  **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                               int nLineLen)
 {
     CPLAssert(psInfo->eFileType == AVCFilePRJ);
 
@@ -1188,7 +1317,7 @@ char  **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine)
          *------------------------------------------------------------*/
         psInfo->cur.papszPrj = CSLAddString(psInfo->cur.papszPrj, pszLine);
     }
-    else if ( strlen(pszLine) > 1 )
+    else if ( nLineLen > 1 )
     {
         /*-------------------------------------------------------------
          * '~' is a line continuation char.  Append what follows the '~'
@@ -1197,7 +1326,7 @@ char  **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine)
         int  iLastLine, nNewLen;
 
         iLastLine = CSLCount(psInfo->cur.papszPrj) - 1;
-        nNewLen = strlen(psInfo->cur.papszPrj[iLastLine])+strlen(pszLine)-1+1;
+        nNewLen = strlen(psInfo->cur.papszPrj[iLastLine])+nLineLen-1+1;
         if (iLastLine >= 0)
         {
             psInfo->cur.papszPrj[iLastLine] = 
@@ -1228,7 +1357,8 @@ char  **AVCE00ParseNextPrjLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCTxt *psTxt;
     int     i, nLen;
@@ -1237,7 +1367,7 @@ AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psTxt = psInfo->cur.psTxt;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -1340,7 +1470,8 @@ AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
             if (iCurCoord < 4 && 
                 (iVertex = iCurCoord % 4) < psTxt->numVerticesLine-1)
             {
-                psTxt->pasVertices[iVertex+1].x = atof(pszLine+i*nItemSize);
+                psTxt->pasVertices[iVertex+1].x =
+                            AVCE00Str2Dbl(pszLine+i*nItemSize, nItemSize);
                 /* The first vertex is always duplicated */
                 if (iVertex == 0)
                     psTxt->pasVertices[0].x = psTxt->pasVertices[1].x;
@@ -1348,7 +1479,8 @@ AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
             else if (iCurCoord >= 4 && iCurCoord < 8 &&
                      (iVertex = iCurCoord % 4) < psTxt->numVerticesLine-1)
             {
-                psTxt->pasVertices[iVertex+1].y = atof(pszLine+i*nItemSize);
+                psTxt->pasVertices[iVertex+1].y =
+                            AVCE00Str2Dbl(pszLine+i*nItemSize, nItemSize);
                 /* The first vertex is always duplicated */
                 if (iVertex == 0)
                     psTxt->pasVertices[0].y = psTxt->pasVertices[1].y;
@@ -1357,17 +1489,17 @@ AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
                      (iVertex = (iCurCoord-8) % 3) < psTxt->numVerticesArrow)
             {
                 psTxt->pasVertices[iVertex+psTxt->numVerticesLine].x =
-                                                    atof(pszLine+i*nItemSize);
+                            AVCE00Str2Dbl(pszLine+i*nItemSize, nItemSize);
             }
             else if (iCurCoord >= 11 && iCurCoord < 14 &&
                      (iVertex = (iCurCoord-8) % 3) < psTxt->numVerticesArrow)
             {
                 psTxt->pasVertices[iVertex+psTxt->numVerticesLine].y =
-                                                    atof(pszLine+i*nItemSize);
+                            AVCE00Str2Dbl(pszLine+i*nItemSize, nItemSize);
             }
             else if (iCurCoord == 14)
             {
-                psTxt->dHeight = atof(pszLine+i*nItemSize);
+                psTxt->dHeight = AVCE00Str2Dbl(pszLine+i*nItemSize, nItemSize);
             }
 
         }
@@ -1379,7 +1511,7 @@ AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
         /*-------------------------------------------------------------
          * Line with a -1.000E+02 value, ALWAYS SINGLE PRECISION !!!
          *------------------------------------------------------------*/
-        psTxt->f_1e2 = (float)atof(pszLine);
+        psTxt->f_1e2 = (float)AVCE00Str2Dbl(pszLine, 14);
 
         psInfo->iCurItem++;
     }
@@ -1433,7 +1565,8 @@ AVCTxt   *AVCE00ParseNextTxtLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCTxt *psTxt;
     int     i, nLen;
@@ -1442,7 +1575,7 @@ AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psTxt = psInfo->cur.psTxt;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -1524,7 +1657,7 @@ AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine)
         /*-------------------------------------------------------------
          * Line with a -1.000E+02 value, ALWAYS SINGLE PRECISION !!!
          *------------------------------------------------------------*/
-        psTxt->f_1e2 = (float)atof(pszLine);
+        psTxt->f_1e2 = (float)AVCE00Str2Dbl(pszLine, 14);
         psInfo->iCurItem++;
     }
     else if (psInfo->iCurItem < psInfo->numItems && 
@@ -1533,16 +1666,17 @@ AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine)
         /*-------------------------------------------------------------
          * Line with 3 values, 1st value is text height.
          *------------------------------------------------------------*/
-        psTxt->dHeight = atof(pszLine);
         if (psInfo->nPrecision == AVC_SINGLE_PREC)
         {
-            psTxt->dV2     = atof(pszLine+14);
-            psTxt->dV3     = atof(pszLine+28);
+            psTxt->dHeight = AVCE00Str2Dbl(pszLine, 14);
+            psTxt->dV2     = AVCE00Str2Dbl(pszLine+14, 14);
+            psTxt->dV3     = AVCE00Str2Dbl(pszLine+28, 14);
         }
         else
         {
-            psTxt->dV2     = atof(pszLine+21);
-            psTxt->dV3     = atof(pszLine+42);
+            psTxt->dHeight = AVCE00Str2Dbl(pszLine, 21);
+            psTxt->dV2     = AVCE00Str2Dbl(pszLine+21, 21);
+            psTxt->dV3     = AVCE00Str2Dbl(pszLine+42, 21);
         }
 
         psInfo->iCurItem++;
@@ -1552,11 +1686,17 @@ AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine)
         /*-------------------------------------------------------------
          * One line for each pair of X,Y coordinates
          *------------------------------------------------------------*/
-        psTxt->pasVertices[ psInfo->iCurItem-8 ].x = atof(pszLine);
+        int nItemSize;
+
         if (psInfo->nPrecision == AVC_SINGLE_PREC)
-            psTxt->pasVertices[ psInfo->iCurItem-8 ].y = atof(pszLine+14);
+            nItemSize = 14;
         else
-            psTxt->pasVertices[ psInfo->iCurItem-8 ].y = atof(pszLine+21);
+            nItemSize = 21;
+
+        psTxt->pasVertices[ psInfo->iCurItem-8 ].x =
+                                        AVCE00Str2Dbl(pszLine, nItemSize);
+        psTxt->pasVertices[ psInfo->iCurItem-8 ].y =
+                            AVCE00Str2Dbl(pszLine+nItemSize, nItemSize);
 
         psInfo->iCurItem++;
     }
@@ -1611,7 +1751,8 @@ AVCTxt   *AVCE00ParseNextTx6Line(AVCE00ParseInfo *psInfo, const char *pszLine)
  * will be generated.  CPLGetLastErrorNo() should be called to check
  * that the line was parsed succesfully.
  **********************************************************************/
-AVCRxp   *AVCE00ParseNextRxpLine(AVCE00ParseInfo *psInfo, const char *pszLine)
+AVCRxp   *AVCE00ParseNextRxpLine(AVCE00ParseInfo *psInfo, const char *pszLine,
+                                 int nLineLen)
 {
     AVCRxp *psRxp;
     int     nLen;
@@ -1620,7 +1761,7 @@ AVCRxp   *AVCE00ParseNextRxpLine(AVCE00ParseInfo *psInfo, const char *pszLine)
 
     psRxp = psInfo->cur.psRxp;
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (nLen >= 20)
     {
@@ -1676,7 +1817,7 @@ AVCRxp   *AVCE00ParseNextRxpLine(AVCE00ParseInfo *psInfo, const char *pszLine)
  * that the line was parsed succesfully.
  **********************************************************************/
 AVCTableDef   *AVCE00ParseNextTableDefLine(AVCE00ParseInfo *psInfo, 
-                                           const char *pszLine)
+                                           const char *pszLine, int nLineLen)
 {
     AVCTableDef *psTableDef;
     int     nLen;
@@ -1685,7 +1826,7 @@ AVCTableDef   *AVCE00ParseNextTableDefLine(AVCE00ParseInfo *psInfo,
 
     psTableDef = psInfo->hdr.psTableDef;  /* May be NULL on first call */
 
-    nLen = strlen(pszLine);
+    nLen = nLineLen;
 
     if (psInfo->numItems == 0)
     {
@@ -1841,7 +1982,7 @@ static AVCField   *_AVCE00ParseTableRecord(AVCE00ParseInfo *psInfo)
     AVCFieldInfo *pasDef;
     AVCTableDef *psTableDef;
     int         i, nType, nSize;
-    char        *pszBuf, szTmp[30];
+    char        *pszBuf;
 
     pasFields =  psInfo->cur.pasFields;
     psTableDef = psInfo->hdr.psTableDef;
@@ -1868,8 +2009,9 @@ static AVCField   *_AVCE00ParseTableRecord(AVCE00ParseInfo *psInfo)
              * E00 tables, even in double precision coverages.
              */
             const char *pszTmpStr;
-            strncpy(szTmp, pszBuf, 14);
-            szTmp[14] = '\0';
+            double      dValue;
+
+            dValue = AVCE00Str2Dbl(pszBuf, 14);
             pszBuf += 14;
 
             /* We use nSize and nFmtPrec for the format because nFmtWidth can
@@ -1877,7 +2019,7 @@ static AVCField   *_AVCE00ParseTableRecord(AVCE00ParseInfo *psInfo)
              * is the actual size of the field in memory.
              */
             pszTmpStr = CPLSPrintf("%*.*f", 
-                                   nSize, pasDef[i].nFmtPrec, atof(szTmp));
+                                   nSize, pasDef[i].nFmtPrec, dValue);
 
             /* If value is bigger than size, then it's too bad... we 
              * truncate it... but this should never happen in clean datasets.
@@ -1903,9 +2045,7 @@ static AVCField   *_AVCE00ParseTableRecord(AVCE00ParseInfo *psInfo)
              * defined by its binary size, not by the coverage's
              * precision.
              */
-            strncpy(szTmp, pszBuf, 14);
-            szTmp[14] = '\0';
-            pasFields[i].fFloat = (float)atof(szTmp);
+            pasFields[i].fFloat = (float)AVCE00Str2Dbl(pszBuf, 14);
             pszBuf += 14;
         }
         else if (nType == AVC_FT_BINFLOAT && pasDef[i].nSize == 8)
@@ -1914,9 +2054,7 @@ static AVCField   *_AVCE00ParseTableRecord(AVCE00ParseInfo *psInfo)
              * defined by its binary size, not by the coverage's
              * precision.
              */
-            strncpy(szTmp, pszBuf, 24);
-            szTmp[24] = '\0';
-            pasFields[i].dDouble = atof(szTmp);
+            pasFields[i].dDouble = AVCE00Str2Dbl(pszBuf, 24);
             pszBuf += 24;
         }
         else
@@ -1954,7 +2092,7 @@ static AVCField   *_AVCE00ParseTableRecord(AVCE00ParseInfo *psInfo)
  * that the line was parsed succesfully.
  **********************************************************************/
 AVCField   *AVCE00ParseNextTableRecLine(AVCE00ParseInfo *psInfo, 
-                                        const char *pszLine)
+                                        const char *pszLine, int nLineLen)
 {
     AVCField    *pasFields = NULL;
     AVCTableDef *psTableDef;
@@ -2053,7 +2191,7 @@ AVCField   *AVCE00ParseNextTableRecLine(AVCE00ParseInfo *psInfo,
          *------------------------------------------------------------*/
         int nSrcLen, nLenToCopy;
 
-        nSrcLen = strlen(pszLine);
+        nSrcLen = nLineLen;
         nLenToCopy = MIN(80, MIN(nSrcLen,(psInfo->numItems-psInfo->iCurItem)));
         strncpy(psInfo->pszBuf+psInfo->iCurItem, pszLine, nLenToCopy);
 
@@ -66,6 +66,7 @@
 
 static GBool _AVCFileExists(const char *pszPath, const char *pszName);
 static int _AVCE00ReadBuildSqueleton(AVCE00ReadPtr psInfo);
+static const char *_AVCE00ReadNextE00Line(AVCE00ReadPtr psInfo);
 
 
 /**********************************************************************
@@ -92,7 +93,7 @@ AVCE00ReadPtr  AVCE00ReadOpen(const char *pszCoverPath)
 {
     AVCE00ReadPtr   psInfo;
     int             i, nLen, nCoverPrecision;
-    VSIStatBuf      sStatBuf;
+    VSIStatBufL     sStatBuf;
     
     CPLErrorReset();
 
@@ -101,7 +102,7 @@ AVCE00ReadPtr  AVCE00ReadOpen(const char *pszCoverPath)
      * file name.
      *----------------------------------------------------------------*/
     if (pszCoverPath == NULL || strlen(pszCoverPath) == 0 ||
-        VSIStat(pszCoverPath, &sStatBuf) == -1)
+        VSIStatL(pszCoverPath, &sStatBuf) == -1)
     {
         CPLError(CE_Failure, CPLE_OpenFailed, 
                  "Invalid coverage path: %s.", 
@@ -270,6 +271,9 @@ void AVCE00ReadClose(AVCE00ReadPtr psInfo)
     if (psInfo->hGenInfo)
         AVCE00GenInfoFree(psInfo->hGenInfo);
 
+    if (psInfo->hCompressor)
+        AVCE00CompressorFree(psInfo->hCompressor);
+
     if (psInfo->pasSections)
     {
         int i;
@@ -290,23 +294,23 @@ void AVCE00ReadClose(AVCE00ReadPtr psInfo)
  * Returns TRUE if a file with the specified name exists in the
  * specified directory.
  *
- * For now I simply try to fopen() the file ... would it be more
+ * For now I simply try to open the file ... would it be more
  * efficient to use stat() ???
  **********************************************************************/
 static GBool _AVCFileExists(const char *pszPath, const char *pszName)
 {
     char        *pszBuf;
     GBool       bFileExists = FALSE;
-    FILE        *fp;
+    VSILFILE    *fp;
 
     pszBuf = (char*)CPLMalloc((strlen(pszPath)+strlen(pszName)+1)*
                               sizeof(char));
     sprintf(pszBuf, "%s%s", pszPath, pszName);
 
-    if ((fp = VSIFOpen(pszBuf, "rb")) != NULL)
+    if ((fp = VSIFOpenL(pszBuf, "rb")) != NULL)
     {
         bFileExists = TRUE;
-        VSIFClose(fp);
+        VSIFCloseL(fp);
     }
 
     CPLFree(pszBuf);
@@ -475,7 +479,7 @@ static int _AVCE00ReadBuildSqueleton(AVCE00ReadPtr psInfo)
     char        cPrecisionCode = '2';
     
 
-    papszCoverDir = CPLReadDir(psInfo->pszCoverPath);
+    papszCoverDir = VSIReadDir(psInfo->pszCoverPath);
 
     psInfo->numSections = 0;
     psInfo->pasSections = NULL;
@@ -838,7 +842,7 @@ static const char *_AVCE00ReadNextTableLine(AVCE00ReadPtr psInfo)
             psInfo->iCurSection = psInfo->numSections;
         psInfo->iCurStep = AVC_GEN_NOTSTARTED;
 
-        pszLine = AVCE00ReadNextLine(psInfo);
+        pszLine = _AVCE00ReadNextE00Line(psInfo);
     }
 
     /*-----------------------------------------------------------------
@@ -861,6 +865,9 @@ static const char *_AVCE00ReadNextTableLine(AVCE00ReadPtr psInfo)
  * The returned line is a null-terminated string, and it does not
  * include a newline character.
  *
+ * If AVCE00ReadSetCompressed() was called, the lines are those of the
+ * compressed E00 file (EXP  1), each one made of several E00 lines.
+ *
  * Call CPLGetLastErrorNo() after calling AVCE00ReadNextLine() to 
  * make sure that the line was generated succesfully.
  *
@@ -870,6 +877,39 @@ static const char *_AVCE00ReadNextTableLine(AVCE00ReadPtr psInfo)
  * not attempt to free() the returned pointer.
  **********************************************************************/
 const char *AVCE00ReadNextLine(AVCE00ReadPtr psInfo)
+{
+    const char *pszLine;
+
+    if (psInfo->hCompressor == NULL)
+        return _AVCE00ReadNextE00Line(psInfo);
+
+    /*-----------------------------------------------------------------
+     * Compress E00 lines until there is a whole compressed line, or
+     * until the end, where the rest of the stream is returned.
+     *----------------------------------------------------------------*/
+    while ((pszLine = AVCE00CompressNextLine(psInfo->hCompressor,
+                                             FALSE)) == NULL)
+    {
+        if ((pszLine = _AVCE00ReadNextE00Line(psInfo)) == NULL)
+        {
+            if (CPLGetLastErrorNo() != 0)
+                return NULL;
+
+            return AVCE00CompressNextLine(psInfo->hCompressor, TRUE);
+        }
+
+        AVCE00CompressLine(psInfo->hCompressor, pszLine);
+    }
+
+    return pszLine;
+}
+
+/**********************************************************************
+ *                          _AVCE00ReadNextE00Line()
+ *
+ * Generate the next line of E00 for AVCE00ReadNextLine().
+ **********************************************************************/
+static const char *_AVCE00ReadNextE00Line(AVCE00ReadPtr psInfo)
 {
     const char *pszLine = NULL;
     AVCE00Section *psSect;
@@ -1111,7 +1151,7 @@ const char *AVCE00ReadNextLine(AVCE00ReadPtr psInfo)
                 psInfo->iCurSection = psInfo->numSections;
             psInfo->iCurStep = AVC_GEN_NOTSTARTED;
 
-            pszLine = AVCE00ReadNextLine(psInfo);
+            pszLine = _AVCE00ReadNextE00Line(psInfo);
         }
     }
 
@@ -1212,6 +1252,9 @@ int AVCE00ReadGotoSection(AVCE00ReadPtr psInfo, AVCE00Section *psSect,
     psInfo->iCurSection = iSect;
     psInfo->iCurStep = AVC_GEN_NOTSTARTED;
 
+    if (psInfo->hCompressor)
+        AVCE00CompressorReset(psInfo->hCompressor);
+
     return 0;
 }
 
@@ -1229,3 +1272,24 @@ int  AVCE00ReadRewind(AVCE00ReadPtr psInfo)
 
     return AVCE00ReadGotoSection(psInfo, &(psInfo->pasSections[0]), TRUE);
 }
+
+/**********************************************************************
+ *                         AVCE00ReadSetCompressed()
+ *
+ * With bCompressed=TRUE, AVCE00ReadNextLine() returns the lines of a
+ * compressed E00 file (EXP  1) in place of those of the E00 file.  It
+ * should be called before the first line is read, or right after 
+ * AVCE00ReadRewind().
+ **********************************************************************/
+void AVCE00ReadSetCompressed(AVCE00ReadPtr psInfo, GBool bCompressed)
+{
+    if (bCompressed && psInfo->hCompressor == NULL)
+    {
+        psInfo->hCompressor = AVCE00CompressorAlloc();
+    }
+    else if (!bCompressed && psInfo->hCompressor != NULL)
+    {
+        AVCE00CompressorFree(psInfo->hCompressor);
+        psInfo->hCompressor = NULL;
+    }
+}
@@ -569,9 +569,14 @@ void  _AVCE00WriteCloseCoverFile(AVCE00WritePtr psInfo)
  * So the coverage that will be created will be only as good as the 
  * E00 input that is used to generate it.
  *
+ * nLineLen is the length of pszLine, which must also end with a '\0'.
+ * The lines of AVCE00InputNextLine() come with their length, which
+ * then does not have to be found again by the parser.
+ *
  * Returns 0 on success or -1 on error.
  **********************************************************************/
-int     AVCE00WriteNextLine(AVCE00WritePtr psInfo, const char *pszLine)
+int     AVCE00WriteNextLine(AVCE00WritePtr psInfo, const char *pszLine,
+                            int nLineLen)
 {
     int nStatus = 0;
 
@@ -630,7 +635,7 @@ int     AVCE00WriteNextLine(AVCE00WritePtr psInfo, const char *pszLine)
              * line to the parser and wait until the whole header has 
              * been read.
              *--------------------------------------------------------*/
-            AVCE00ParseNextLine(psInfo->hParseInfo, pszLine); 
+            AVCE00ParseNextLine(psInfo->hParseInfo, pszLine, nLineLen); 
         }
         else if (psInfo->eCurFileType != AVCFileUnknown)
         {
@@ -660,7 +665,7 @@ int     AVCE00WriteNextLine(AVCE00WritePtr psInfo, const char *pszLine)
          *------------------------------------------------------------*/
         AVCTableDef *psTableDef;
         psTableDef = (AVCTableDef*)AVCE00ParseNextLine(psInfo->hParseInfo, 
-                                                       pszLine); 
+                                                       pszLine, nLineLen); 
         if (psTableDef)
         {
             nStatus = _AVCE00WriteCreateCoverFile(psInfo, 
@@ -690,7 +695,8 @@ int     AVCE00WriteNextLine(AVCE00WritePtr psInfo, const char *pszLine)
          *------------------------------------------------------------*/
         {
             void *psObj;
-            psObj = AVCE00ParseNextLine(psInfo->hParseInfo, pszLine);
+            psObj = AVCE00ParseNextLine(psInfo->hParseInfo, pszLine,
+                                        nLineLen);
 
             if (psObj)
                 AVCBinWriteObject(psInfo->hFile, psObj);
@@ -739,7 +745,7 @@ int     AVCE00DeleteCoverage(const char *pszCoverToDelete)
     const char *pszFname;
     char **papszTables=NULL, **papszFiles=NULL;
     AVCE00ReadPtr   psInfo;
-    VSIStatBuf      sStatBuf;
+    VSIStatBufL     sStatBuf;
 
     CPLErrorReset();
 
@@ -807,7 +813,7 @@ int     AVCE00DeleteCoverage(const char *pszCoverToDelete)
 
             /* Delete the .DAT file */
             pszFname = CPLSPrintf("%s%s.dat", pszInfoPath, papszFiles[i]);
-            if ( VSIStat(pszFname, &sStatBuf) != -1 &&
+            if ( VSIStatL(pszFname, &sStatBuf) != -1 &&
                  unlink(pszFname) != 0)
             {
                 CPLError(CE_Failure, CPLE_FileIO, 
@@ -819,7 +825,7 @@ int     AVCE00DeleteCoverage(const char *pszCoverToDelete)
 
             /* Delete the .DAT file */
             pszFname = CPLSPrintf("%s%s.nit", pszInfoPath, papszFiles[i]);
-            if ( VSIStat(pszFname, &sStatBuf) != -1 &&
+            if ( VSIStatL(pszFname, &sStatBuf) != -1 &&
                  unlink(pszFname) != 0)
             {
                 CPLError(CE_Failure, CPLE_FileIO, 
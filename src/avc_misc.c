@@ -44,6 +44,9 @@
 
 #include "avc.h"
 
+#include <ctype.h>
+#include <float.h>      /* FLT_EVAL_METHOD */
+
 
 /**********************************************************************
  *                          AVCE00ComputeRecSize()
@@ -162,3 +165,141 @@ AVCTableDef *_AVCDupTableDef(AVCTableDef *psSrcDef)
 
    return psNewDef;
 }
+
+
+/**********************************************************************
+ *                          _AVCParseFixInt()
+ *
+ * Convert the nSize chars of a FIXINT field (a right-justified integer
+ * stored as text) to an integer, with the same result as atoi() on a
+ * '\0'-terminated copy of the field, but without the copy.
+ **********************************************************************/
+GInt32 _AVCParseFixInt(const char *pszStr, int nSize)
+{
+    int         i = 0, bNeg = FALSE;
+    GUInt32     nValue = 0;
+
+    while (i < nSize && pszStr[i] != '\0' && 
+           isspace((unsigned char)pszStr[i]))
+        i++;
+
+    if (i < nSize && (pszStr[i] == '-' || pszStr[i] == '+'))
+        bNeg = (pszStr[i++] == '-');
+
+    while (i < nSize && pszStr[i] >= '0' && pszStr[i] <= '9')
+        nValue = nValue*10 + (pszStr[i++] - '0');
+
+    return (GInt32)(bNeg ? 0U - nValue : nValue);
+}
+
+/**********************************************************************
+ *                          _AVCScalePow10()
+ *
+ * Compute nMantissa * 10^nExp in *pdValue when it can be done with a 
+ * single rounding, as strtod() does: nMantissa up to 2^53 is exact as a
+ * double, and so are the powers of 10 up to 1e22, so the only rounding
+ * is the one of the multiplication or division.  With the extended
+ * precision of the x87 (FLT_EVAL_METHOD != 0) the result would be
+ * rounded twice, so it is never computed there.
+ *
+ * Returns TRUE if *pdValue was set, or FALSE if the caller must convert
+ * the string with strtod() or atof().
+ **********************************************************************/
+GBool _AVCScalePow10(GUIntBig nMantissa, int nExp, double *pdValue)
+{
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    static const double adfPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+                                      1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+                                      1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+                                      1e19, 1e20, 1e21, 1e22};
+
+    if (nMantissa > ((GUIntBig)1 << 53) || nExp < -22 || nExp > 22)
+        return FALSE;
+
+    if (nExp >= 0)
+        *pdValue = (double)nMantissa * adfPow10[nExp];
+    else
+        *pdValue = (double)nMantissa / adfPow10[-nExp];
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/**********************************************************************
+ *                          _AVCParseFixNum()
+ *
+ * Convert the nSize chars of a FIXNUM field (a number with a fixed 
+ * number of decimals stored as text) to a double, with the same result
+ * as atof() on a '\0'-terminated copy of the field.
+ *
+ * The usual values ([-]digits[.digits], with up to 15 significant 
+ * digits) are converted directly: the digits are accumulated in an
+ * integer and scaled by _AVCScalePow10(), so the result is correctly
+ * rounded as atof()'s.  Anything else (exponents, more digits, ...) 
+ * goes through atof().
+ **********************************************************************/
+double _AVCParseFixNum(const char *pszStr, int nSize)
+{
+    int         i = 0, bNeg = FALSE, numChars = 0, numDigits = 0;
+    int         numDecimals = 0;
+    GUIntBig    nMantissa = 0;
+    char        szBuf[100], *pszBuf;
+    double      dValue;
+
+    while (i < nSize && pszStr[i] != '\0' && 
+           isspace((unsigned char)pszStr[i]))
+        i++;
+
+    if (i < nSize && (pszStr[i] == '-' || pszStr[i] == '+'))
+        bNeg = (pszStr[i++] == '-');
+
+    for( ; i < nSize && pszStr[i] >= '0' && pszStr[i] <= '9'; i++)
+    {
+        nMantissa = nMantissa*10 + (pszStr[i] - '0');
+        numChars++;
+        if (nMantissa) 
+            numDigits++;
+    }
+
+    if (i < nSize && pszStr[i] == '.')
+    {
+        for(i++; i < nSize && pszStr[i] >= '0' && pszStr[i] <= '9'; i++)
+        {
+            nMantissa = nMantissa*10 + (pszStr[i] - '0');
+            numChars++;
+            numDecimals++;
+            if (nMantissa) 
+                numDigits++;
+        }
+    }
+
+    /* Only trailing spaces are allowed after the number */
+    while (i < nSize && pszStr[i] == ' ')
+        i++;
+
+    if ((i == nSize || pszStr[i] == '\0') && numChars > 0 && 
+        numDigits <= 15 && _AVCScalePow10(nMantissa, -numDecimals, &dValue))
+    {
+        return bNeg ? -dValue : dValue;
+    }
+
+    /*-----------------------------------------------------------------
+     * Slow path
+     *----------------------------------------------------------------*/
+    if (nSize < (int)sizeof(szBuf))
+        pszBuf = szBuf;
+    else
+        pszBuf = (char*)CPLMalloc(nSize+1);
+
+    strncpy(pszBuf, pszStr, nSize);
+    pszBuf[nSize] = '\0';
+
+    dValue = atof(pszBuf);
+
+    if (pszBuf != szBuf)
+        CPLFree(pszBuf);
+
+    return dValue;
+}
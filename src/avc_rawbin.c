@@ -61,10 +61,340 @@
 
 #include "avc.h"
 
+/*---------------------------------------------------------------------
+ * Files opened in read-only mode are memory-mapped when the platform
+ * supports it, and the read functions then work directly on the 
+ * mapping.  Define AVC_NO_MMAP to always use the stdio buffering.
+ *--------------------------------------------------------------------*/
+#if !defined(WIN32) && !defined(AVC_NO_MMAP)
+#  define AVC_USE_MMAP
+#endif
+
+/*---------------------------------------------------------------------
+ * Files that are not mapped are read ahead by a background thread, 
+ * unless AVC_NO_THREADS is defined (see AVCRAWBIN_READAHEADSIZE).
+ *
+ * The thread, its blocks and fp are only released by AVCRawBinClose().
+ * When CPLError() does not return (in R it calls error(), that jumps
+ * out of the call), a close that follows a failed read is skipped and
+ * the thread waits forever.  The callers must then keep the open files
+ * where they are always closed: the R glue puts them in external 
+ * pointers whose finalizers close them (see file_pointer() in 
+ * RArcInfo.c), and coverage handles, iterators and lazy vectors close
+ * theirs in their own finalizers.
+ *--------------------------------------------------------------------*/
+#if !defined(WIN32) && !defined(AVC_NO_THREADS)
+#  include <pthread.h>
+#  define AVC_USE_READAHEAD
+#endif
+
+/* After a seek, the read-ahead starts again once this many buffers 
+ * have been read in sequence, so that random reads are not slowed down
+ * by reading blocks they do not need.
+ */
+#define AVCRAWBIN_READAHEAD_RESTART 4
+
+/*---------------------------------------------------------------------
+ * Byte shuffles used by the AVCRawBinDecode<datatype>Array() functions
+ * when the compiler targets those instruction sets.
+ *--------------------------------------------------------------------*/
+#if defined(CPL_LSB) && defined(__AVX2__)
+#  include <immintrin.h>
+#  define AVC_USE_AVX2
+#endif
+#if defined(CPL_LSB) && (defined(__SSSE3__) || defined(__AVX2__))
+#  include <tmmintrin.h>
+#  define AVC_USE_SSSE3
+#endif
+
 /*=====================================================================
  * Stuff related to buffered reading of raw binary files
  *====================================================================*/
 
+#ifdef AVC_USE_READAHEAD
+/*---------------------------------------------------------------------
+ * Read-ahead of a file by a background thread: while the blocks of one
+ * buffer are decoded, the thread reads the next block into the other.
+ * The thread owns fp while bRunning is TRUE, and it is paused by
+ * AVCRawBinFSeek() before fp is used again by the reader.
+ *--------------------------------------------------------------------*/
+struct AVCRawBinReadAhead_t
+{
+    pthread_t       hThread;
+    pthread_mutex_t hMutex;
+    pthread_cond_t  hCond;
+    GBool           bThread;        /* hThread has been created         */
+
+    VSILFILE        *fp;
+    int             nBlockSize;
+    GByte           *apabyBlock[2];
+    int             anBlockBytes[2];/* Bytes in each block, -1 if empty */
+    int             iFill;          /* Next block filled by the thread  */
+    int             iRead;          /* Next block used by the reader    */
+
+    GBool           bRunning;       /* Set by the reader                */
+    GBool           bPaused;        /* Set by the thread when !bRunning */
+    GBool           bEOF;           /* Last block read by the thread    */
+    GBool           bQuit;
+    int             nSeqRefills;    /* Buffers read since the last seek */
+};
+
+/**********************************************************************
+ *                          _AVCRawBinReadAheadThread()
+ *
+ * Fill the empty blocks one after the other, until the reader pauses
+ * the read-ahead or closes the file.
+ **********************************************************************/
+static void *_AVCRawBinReadAheadThread(void *pArg)
+{
+    AVCRawBinReadAhead *psRA = (AVCRawBinReadAhead *)pArg;
+    int     i, nBytes;
+
+    CPLSetWorkerThread();
+
+    pthread_mutex_lock(&psRA->hMutex);
+
+    while(!psRA->bQuit)
+    {
+        if (!psRA->bRunning || psRA->bEOF || 
+            psRA->anBlockBytes[psRA->iFill] >= 0)
+        {
+            psRA->bPaused = !psRA->bRunning;
+            pthread_cond_broadcast(&psRA->hCond);
+            pthread_cond_wait(&psRA->hCond, &psRA->hMutex);
+            continue;
+        }
+
+        /* The reader does not touch an empty block or fp meanwhile */
+        i = psRA->iFill;
+        pthread_mutex_unlock(&psRA->hMutex);
+        nBytes = (int)VSIFReadL(psRA->apabyBlock[i], sizeof(GByte),
+                                psRA->nBlockSize, psRA->fp);
+        pthread_mutex_lock(&psRA->hMutex);
+
+        psRA->anBlockBytes[i] = nBytes;
+        psRA->iFill = 1-i;
+        if (nBytes < psRA->nBlockSize)
+            psRA->bEOF = TRUE;
+        pthread_cond_broadcast(&psRA->hCond);
+    }
+
+    pthread_mutex_unlock(&psRA->hMutex);
+
+    return NULL;
+}
+
+/**********************************************************************
+ *                          _AVCRawBinNewReadAhead()
+ *
+ * Set up the read-ahead of a file opened for reading that is not 
+ * mapped, if it is larger than one block.  The thread and the blocks
+ * are only created when the file is first read in sequence.
+ **********************************************************************/
+static void _AVCRawBinNewReadAhead(AVCRawBinFile *psFile)
+{
+    AVCRawBinReadAhead *psRA;
+    VSIStatBufL sStat;
+    const char  *pszSize;
+    int         nBlockSize = AVCRAWBIN_READAHEADSIZE;
+
+    if ((pszSize = getenv("AVC_READAHEAD")) != NULL)
+        nBlockSize = atoi(pszSize);
+
+    if (nBlockSize <= AVCRAWBIN_READBUFSIZE ||
+        VSIStatL(psFile->pszFname, &sStat) != 0 || 
+        sStat.st_size <= nBlockSize)
+        return;
+
+    psRA = (AVCRawBinReadAhead*)CPLCalloc(1, sizeof(AVCRawBinReadAhead));
+    psRA->fp = psFile->fp;
+    psRA->nBlockSize = nBlockSize;
+    psRA->nSeqRefills = AVCRAWBIN_READAHEAD_RESTART;
+
+    pthread_mutex_init(&psRA->hMutex, NULL);
+    pthread_cond_init(&psRA->hCond, NULL);
+
+    psFile->psReadAhead = psRA;
+}
+
+/**********************************************************************
+ *                          _AVCRawBinFreeReadAhead()
+ **********************************************************************/
+static void _AVCRawBinFreeReadAhead(AVCRawBinFile *psFile)
+{
+    AVCRawBinReadAhead *psRA = psFile->psReadAhead;
+
+    if (psRA->bThread)
+    {
+        pthread_mutex_lock(&psRA->hMutex);
+        psRA->bQuit = TRUE;
+        pthread_cond_broadcast(&psRA->hCond);
+        pthread_mutex_unlock(&psRA->hMutex);
+
+        pthread_join(psRA->hThread, NULL);
+    }
+
+    pthread_mutex_destroy(&psRA->hMutex);
+    pthread_cond_destroy(&psRA->hCond);
+    CPLFree(psRA->apabyBlock[0]);
+    CPLFree(psRA->apabyBlock[1]);
+    CPLFree(psRA);
+
+    psFile->psReadAhead = NULL;
+    psFile->pabyBuf = psFile->abyBuf;
+}
+
+/**********************************************************************
+ *                          _AVCRawBinStartReadAhead()
+ *
+ * Start reading ahead from the current position of fp, which must be
+ * the end of the (empty) buffer.  
+ *
+ * Returns FALSE if the thread could not be started, in which case the
+ * file is only read with stdio from then on.
+ **********************************************************************/
+static GBool _AVCRawBinStartReadAhead(AVCRawBinFile *psFile)
+{
+    AVCRawBinReadAhead *psRA = psFile->psReadAhead;
+
+    CPLAssert(psFile->pabyBuf == psFile->abyBuf);
+
+    if (!psRA->bThread)
+    {
+        psRA->apabyBlock[0] = (GByte*)VSIMalloc(psRA->nBlockSize);
+        psRA->apabyBlock[1] = (GByte*)VSIMalloc(psRA->nBlockSize);
+
+        if (psRA->apabyBlock[0] == NULL || psRA->apabyBlock[1] == NULL ||
+            pthread_create(&psRA->hThread, NULL, 
+                           _AVCRawBinReadAheadThread, psRA) != 0)
+        {
+            _AVCRawBinFreeReadAhead(psFile);
+            return FALSE;
+        }
+        psRA->bThread = TRUE;
+    }
+
+    pthread_mutex_lock(&psRA->hMutex);
+    psRA->anBlockBytes[0] = psRA->anBlockBytes[1] = -1;
+    psRA->iFill = psRA->iRead = 0;
+    psRA->bEOF = FALSE;
+    psRA->bPaused = FALSE;
+    psRA->bRunning = TRUE;
+    pthread_cond_broadcast(&psRA->hCond);
+    pthread_mutex_unlock(&psRA->hMutex);
+
+    return TRUE;
+}
+
+/**********************************************************************
+ *                          _AVCRawBinPauseReadAhead()
+ *
+ * Stop the read-ahead before the reader moves fp, and drop the blocks
+ * read so far.  The read-ahead starts again after 
+ * AVCRAWBIN_READAHEAD_RESTART sequential reads.
+ **********************************************************************/
+static void _AVCRawBinPauseReadAhead(AVCRawBinFile *psFile)
+{
+    AVCRawBinReadAhead *psRA = psFile->psReadAhead;
+
+    if (psRA == NULL)
+        return;
+
+    psRA->nSeqRefills = 0;
+
+    if (!psRA->bRunning)
+        return;
+
+    pthread_mutex_lock(&psRA->hMutex);
+    psRA->bRunning = FALSE;
+    pthread_cond_broadcast(&psRA->hCond);
+    while(!psRA->bPaused)
+        pthread_cond_wait(&psRA->hCond, &psRA->hMutex);
+    pthread_mutex_unlock(&psRA->hMutex);
+
+    psFile->pabyBuf = psFile->abyBuf;
+}
+
+/**********************************************************************
+ *                          _AVCRawBinNextBlock()
+ *
+ * Give back the block that was read, if any, and make the next block
+ * of the read-ahead the buffer of the file.  The whole buffer must 
+ * have been read.  At EOF the buffer is left empty.
+ **********************************************************************/
+static void _AVCRawBinNextBlock(AVCRawBinFile *psFile)
+{
+    AVCRawBinReadAhead *psRA = psFile->psReadAhead;
+
+    CPLAssert(psFile->nCurPos == psFile->nCurSize);
+
+    pthread_mutex_lock(&psRA->hMutex);
+
+    if (psFile->pabyBuf != psFile->abyBuf)
+    {
+        psRA->anBlockBytes[psRA->iRead] = -1;
+        psRA->iRead = 1-psRA->iRead;
+        pthread_cond_broadcast(&psRA->hCond);
+    }
+
+    while(psRA->anBlockBytes[psRA->iRead] < 0 && !psRA->bEOF)
+        pthread_cond_wait(&psRA->hCond, &psRA->hMutex);
+
+    psFile->nOffset += psFile->nCurSize;
+    psFile->nCurPos = 0;
+    if (psRA->anBlockBytes[psRA->iRead] < 0)
+    {
+        psFile->pabyBuf = psFile->abyBuf;
+        psFile->nCurSize = 0;
+    }
+    else
+    {
+        psFile->pabyBuf = psRA->apabyBlock[psRA->iRead];
+        psFile->nCurSize = psRA->anBlockBytes[psRA->iRead];
+    }
+
+    pthread_mutex_unlock(&psRA->hMutex);
+}
+
+/**********************************************************************
+ *                          _AVCRawBinReadAheadRunning()
+ *
+ * Return TRUE if fp belongs to the read-ahead thread.
+ **********************************************************************/
+static GBool _AVCRawBinReadAheadRunning(AVCRawBinFile *psFile)
+{
+    return (psFile->psReadAhead != NULL && psFile->psReadAhead->bRunning);
+}
+#endif /* AVC_USE_READAHEAD */
+
+/**********************************************************************
+ *                          _AVCRawBinReadAheadRefill()
+ *
+ * Called when the buffer of a file that is not mapped has been read.
+ * If the file is read ahead, the next block becomes the buffer, 
+ * possibly after starting the read-ahead again, and TRUE is returned.
+ * Otherwise the caller reads the file itself.
+ **********************************************************************/
+static GBool _AVCRawBinReadAheadRefill(AVCRawBinFile *psFile)
+{
+#ifdef AVC_USE_READAHEAD
+    AVCRawBinReadAhead *psRA = psFile->psReadAhead;
+
+    if (psRA == NULL)
+        return FALSE;
+
+    if (!psRA->bRunning &&
+        (psRA->nSeqRefills++ < AVCRAWBIN_READAHEAD_RESTART ||
+         !_AVCRawBinStartReadAhead(psFile)))
+        return FALSE;
+
+    _AVCRawBinNextBlock(psFile);
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
 /**********************************************************************
  *                          AVCRawBinOpen()
  *
@@ -93,22 +423,22 @@ AVCRawBinFile *AVCRawBinOpen(const char *pszFname, const char *pszAccess)
     if (EQUALN(pszAccess, "r+", 2))
     {
         psFile->eAccess = AVCReadWrite;
-        psFile->fp = VSIFOpen(pszFname, "r+b");
+        psFile->fp = VSIFOpenL(pszFname, "r+b");
     }
     else if (EQUALN(pszAccess, "r", 1))
     {
         psFile->eAccess = AVCRead;
-        psFile->fp = VSIFOpen(pszFname, "rb");
+        psFile->fp = VSIFOpenL(pszFname, "rb");
     }
     else if (EQUALN(pszAccess, "w", 1))
     {
         psFile->eAccess = AVCWrite;
-        psFile->fp = VSIFOpen(pszFname, "wb");
+        psFile->fp = VSIFOpenL(pszFname, "wb");
     }
     else if (EQUALN(pszAccess, "a", 1))
     {
         psFile->eAccess = AVCWrite;
-        psFile->fp = VSIFOpen(pszFname, "ab");
+        psFile->fp = VSIFOpenL(pszFname, "ab");
     }
     else
     {
@@ -123,11 +453,31 @@ AVCRawBinFile *AVCRawBinOpen(const char *pszFname, const char *pszAccess)
      *----------------------------------------------------------------*/
     if (psFile->fp)
     {
-        /* The psFile structure should be initialized here... 
-         * but there is nothing to initialize for now.
+        psFile->pszFname = CPLStrdup(pszFname);
+        psFile->pabyBuf = psFile->abyBuf;
+
+#ifdef AVC_USE_MMAP
+        /* In read-only mode, try to map the whole file in memory.  
+         * The mapping then acts as one big buffer that starts at 
+         * offset 0, and we never have to call VSIFRead().
+         * If mapping fails then we just keep using stdio.
          */
+        if (psFile->eAccess == AVCRead &&
+            (psFile->pabyMap = (GByte*)VSIFMapL(psFile->fp, 
+                                                &(psFile->nMapSize))) != NULL)
+        {
+            psFile->pabyBuf = psFile->pabyMap;
+            psFile->nCurSize = (int)psFile->nMapSize;
+        }
+#endif
+#ifdef AVC_USE_READAHEAD
+        if (psFile->eAccess == AVCRead && psFile->pabyMap == NULL)
+            _AVCRawBinNewReadAhead(psFile);
+#endif
 
-        psFile->pszFname = CPLStrdup(pszFname);
+        if (psFile->eAccess == AVCRead)
+            VSIFAdviseSequentialL(psFile->fp, psFile->pabyMap, 
+                                  psFile->nMapSize);
     }
     else
     {
@@ -150,8 +500,14 @@ void AVCRawBinClose(AVCRawBinFile *psFile)
 {
     if (psFile)
     {
+#ifdef AVC_USE_READAHEAD
+        if (psFile->psReadAhead)
+            _AVCRawBinFreeReadAhead(psFile);
+#endif
+        if (psFile->pabyMap)
+            VSIFUnmapL(psFile->fp, psFile->pabyMap, psFile->nMapSize);
         if (psFile->fp)
-            VSIFClose(psFile->fp);
+            VSIFCloseL(psFile->fp);
         CPLFree(psFile->pszFname);
         CPLFree(psFile);
     }
@@ -163,8 +519,6 @@ void AVCRawBinClose(AVCRawBinFile *psFile)
  * Copy the number of bytes from the input file to the specified 
  * memory location.
  **********************************************************************/
-static GBool bDisableReadBytesEOFError = FALSE;
-
 void AVCRawBinReadBytes(AVCRawBinFile *psFile, int nBytesToRead, GByte *pBuf)
 {
     /* Make sure file is opened with Read access
@@ -182,7 +536,7 @@ void AVCRawBinReadBytes(AVCRawBinFile *psFile, int nBytesToRead, GByte *pBuf)
      */
     if (psFile->nCurPos + nBytesToRead <= psFile->nCurSize)
     {
-        memcpy(pBuf, psFile->abyBuf+psFile->nCurPos, nBytesToRead);
+        memcpy(pBuf, psFile->pabyBuf+psFile->nCurPos, nBytesToRead);
         psFile->nCurPos += nBytesToRead;
         return;
     }
@@ -193,26 +547,49 @@ void AVCRawBinReadBytes(AVCRawBinFile *psFile, int nBytesToRead, GByte *pBuf)
     while(nBytesToRead > 0)
     {
         /* If we reached the end of our memory buffer then read another
-         * chunk from the file
+         * chunk from the file (a mapped file has no other chunk to load),
+         * unless the read-ahead thread has it ready.
          */
         CPLAssert(psFile->nCurPos <= psFile->nCurSize);
-        if (psFile->nCurPos == psFile->nCurSize)
+        if (psFile->nCurPos == psFile->nCurSize && psFile->pabyMap == NULL &&
+            !_AVCRawBinReadAheadRefill(psFile))
         {
+            if (nBytesToRead >= AVCRAWBIN_READBUFSIZE)
+            {
+                /* Large reads go straight from the file to the 
+                 * destination, the buffer is left empty as after 
+                 * AVCRawBinFSeek().
+                 */
+                int nBytes;
+                psFile->nOffset += psFile->nCurSize;
+                nBytes = VSIFReadL(pBuf, sizeof(GByte), nBytesToRead, 
+                                   psFile->fp);
+                psFile->nOffset += nBytes;
+                psFile->nCurSize = 0;
+                psFile->nCurPos = 0;
+                pBuf += nBytes;
+                nBytesToRead -= nBytes;
+
+                if (nBytesToRead == 0)
+                    break;
+            }
+
             psFile->nOffset += psFile->nCurSize;
-            psFile->nCurSize = VSIFRead(psFile->abyBuf, sizeof(GByte),
-                                        AVCRAWBIN_READBUFSIZE, psFile->fp);
+            psFile->nCurSize = VSIFReadL(psFile->abyBuf, sizeof(GByte),
+                                         AVCRAWBIN_READBUFSIZE, psFile->fp);
             psFile->nCurPos = 0;
         }
 
-        if (psFile->nCurSize == 0)
+        if (psFile->nCurPos >= psFile->nCurSize)
         {
             /* Attempt to read past EOF... generate an error.
              *
              * Note: AVCRawBinEOF() can set bDisableReadBytesEOFError=TRUE
              *       to disable the error message whils it is testing
-             *       for EOF.
+             *       for EOF.  The flag is kept in psFile so that threads
+             *       reading other files do not see it.
              */
-            if (bDisableReadBytesEOFError == FALSE)
+            if (psFile->bDisableReadBytesEOFError == FALSE)
                 CPLError(CE_Failure, CPLE_FileIO,
                          "Attempt to read past EOF in %s.", psFile->pszFname);
             return;
@@ -226,7 +603,7 @@ void AVCRawBinReadBytes(AVCRawBinFile *psFile, int nBytesToRead, GByte *pBuf)
         {
             int nBytes;
             nBytes = psFile->nCurSize-psFile->nCurPos;
-            memcpy(pBuf, psFile->abyBuf+psFile->nCurPos, nBytes);
+            memcpy(pBuf, psFile->pabyBuf+psFile->nCurPos, nBytes);
             psFile->nCurPos += nBytes;
             pBuf += nBytes;
             nBytesToRead -= nBytes;
@@ -236,7 +613,7 @@ void AVCRawBinReadBytes(AVCRawBinFile *psFile, int nBytesToRead, GByte *pBuf)
             /* All the requested bytes are now in the buffer... 
              * simply copy them and return.
              */
-            memcpy(pBuf, psFile->abyBuf+psFile->nCurPos, nBytesToRead);
+            memcpy(pBuf, psFile->pabyBuf+psFile->nCurPos, nBytesToRead);
             psFile->nCurPos += nBytesToRead;
 
             nBytesToRead = 0;   /* Terminate the loop */
@@ -253,9 +630,9 @@ void AVCRawBinReadBytes(AVCRawBinFile *psFile, int nBytesToRead, GByte *pBuf)
  * beginning of the file (SEEK_SET), or the current position (SEEK_CUR).
  * SEEK_END is not supported.
  **********************************************************************/
-void AVCRawBinFSeek(AVCRawBinFile *psFile, int nOffset, int nFrom)
+void AVCRawBinFSeek(AVCRawBinFile *psFile, GIntBig nOffset, int nFrom)
 {
-    int  nTarget = 0;
+    GIntBig nTarget = 0;
 
     CPLAssert(nFrom == SEEK_SET || nFrom == SEEK_CUR);
 
@@ -272,14 +649,35 @@ void AVCRawBinFSeek(AVCRawBinFile *psFile, int nOffset, int nFrom)
     else if (nFrom == SEEK_CUR)
         nTarget = nOffset + psFile->nCurPos;
 
+#ifdef AVC_USE_READAHEAD
+    /* A short skip forward goes on with the blocks of the read-ahead,
+     * which has them ready or is reading them anyway.
+     */
+    while (_AVCRawBinReadAheadRunning(psFile) && nTarget > psFile->nCurSize &&
+           nTarget - psFile->nCurSize <= psFile->psReadAhead->nBlockSize &&
+           psFile->nCurSize > 0)
+    {
+        nTarget -= psFile->nCurSize;
+        psFile->nCurPos = psFile->nCurSize;
+        _AVCRawBinNextBlock(psFile);
+    }
+#endif
+
+    if (psFile->pabyMap)
+    {
+        /* With a mapped file the whole file is in memory... just move 
+         * the read pointer, a position past EOF is the same as EOF.
+         */
+        psFile->nCurPos = (int)MAX(0, MIN(nTarget, psFile->nCurSize));
+    }
     /* Is the destination located inside the current buffer?
      */
-    if (nTarget > 0 && nTarget <= psFile->nCurSize)
+    else if (nTarget > 0 && nTarget <= psFile->nCurSize)
     {
         /* Requested location is already in memory... just move the 
          * read pointer
          */
-        psFile->nCurPos = nTarget;
+        psFile->nCurPos = (int)nTarget;
     }
     else
     {
@@ -287,7 +685,11 @@ void AVCRawBinFSeek(AVCRawBinFile *psFile, int nOffset, int nFrom)
          * move the FILE * to the right location and be ready to 
          * read from there.
          */
-        VSIFSeek(psFile->fp, psFile->nOffset+nTarget, SEEK_SET);
+#ifdef AVC_USE_READAHEAD
+        _AVCRawBinPauseReadAhead(psFile);
+#endif
+        VSIFSeekL(psFile->fp, (vsi_l_offset)(psFile->nOffset+nTarget), 
+                  SEEK_SET);
         psFile->nCurPos = 0;
         psFile->nCurSize = 0;
         psFile->nOffset = psFile->nOffset+nTarget;
@@ -312,6 +714,20 @@ GBool AVCRawBinEOF(AVCRawBinFile *psFile)
     if (psFile->eAccess != AVCRead && psFile->eAccess != AVCReadWrite)
         return TRUE;
 
+    if (psFile->pabyMap)
+        return (psFile->nCurPos >= psFile->nCurSize);
+
+#ifdef AVC_USE_READAHEAD
+    /* fp belongs to the read-ahead thread: EOF is an empty next block */
+    if (_AVCRawBinReadAheadRunning(psFile))
+    {
+        if (psFile->nCurPos == psFile->nCurSize)
+            _AVCRawBinNextBlock(psFile);
+
+        return (psFile->nCurPos >= psFile->nCurSize);
+    }
+#endif
+
     /* If the file pointer has been moved by AVCRawBinFSeek(), then
      * we may be at a position past EOF, but VSIFeof() would still
      * return FALSE.
@@ -327,19 +743,40 @@ GBool AVCRawBinEOF(AVCRawBinFile *psFile)
         /* Set bDisableReadBytesEOFError=TRUE to temporarily disable 
          * the EOF error message from AVCRawBinReadBytes().
          */
-        bDisableReadBytesEOFError = TRUE;
+        psFile->bDisableReadBytesEOFError = TRUE;
         AVCRawBinReadBytes(psFile, 1, (GByte *) (&c) );
-        bDisableReadBytesEOFError = FALSE;
+        psFile->bDisableReadBytesEOFError = FALSE;
 
         if (psFile->nCurPos > 0)
             AVCRawBinFSeek(psFile, -1, SEEK_CUR);
     }
 
     return (psFile->nCurPos == psFile->nCurSize && 
-            VSIFEof(psFile->fp));
+            VSIFEofL(psFile->fp));
 }
 
 
+/**********************************************************************
+ *                          _AVCRawBinReadValue()
+ *
+ * Fetch the bytes of a single value: they are copied directly from the
+ * current buffer (or from the file mapping) when they are all there,
+ * otherwise we go through AVCRawBinReadBytes().
+ **********************************************************************/
+static void _AVCRawBinReadValue(AVCRawBinFile *psFile, int nBytes, 
+                                void *pValue)
+{
+    if (psFile != NULL && psFile->nCurPos + nBytes <= psFile->nCurSize)
+    {
+        memcpy(pValue, psFile->pabyBuf + psFile->nCurPos, nBytes);
+        psFile->nCurPos += nBytes;
+    }
+    else
+    {
+        AVCRawBinReadBytes(psFile, nBytes, (GByte*)pValue);
+    }
+}
+
 /**********************************************************************
  *                          AVCRawBinRead<datatype>()
  *
@@ -350,59 +787,197 @@ GBool AVCRawBinEOF(AVCRawBinFile *psFile)
  **********************************************************************/
 GInt16  AVCRawBinReadInt16(AVCRawBinFile *psFile)
 {
-    GInt16 n16Value;
+    GByte abyValue[2] = {0, 0};
 
-    AVCRawBinReadBytes(psFile, 2, (GByte*)(&n16Value));
+    _AVCRawBinReadValue(psFile, 2, abyValue);
 
-#ifdef CPL_LSB
-    return (GInt16)CPL_SWAP16(n16Value);
-#else
-    return n16Value;
-#endif
+    return AVCRawBinDecodeInt16(abyValue);
 }
 
 GInt32  AVCRawBinReadInt32(AVCRawBinFile *psFile)
 {
-    GInt32 n32Value;
+    GByte abyValue[4] = {0, 0, 0, 0};
 
-    AVCRawBinReadBytes(psFile, 4, (GByte*)(&n32Value));
+    _AVCRawBinReadValue(psFile, 4, abyValue);
 
-#ifdef CPL_LSB
-    return (GInt32)CPL_SWAP32(n32Value);
-#else
-    return n32Value;
-#endif
+    return AVCRawBinDecodeInt32(abyValue);
 }
 
 float   AVCRawBinReadFloat(AVCRawBinFile *psFile)
 {
-    float fValue;
-    GUInt32 foo;
+    GByte abyValue[4] = {0, 0, 0, 0};
 
-    AVCRawBinReadBytes(psFile, 4, (GByte*)(&fValue));
+    _AVCRawBinReadValue(psFile, 4, abyValue);
 
-/*
-#ifdef CPL_LSB
-    *(GUInt32*)(&fValue) = CPL_SWAP32(*(GUInt32*)(&fValue));
-#endif
-*/
+    return AVCRawBinDecodeFloat(abyValue);
+}
 
-#ifdef CPL_LSB
-    memcpy(&foo, &fValue, sizeof(fValue));
-    *(&foo) = CPL_SWAP32(*(&foo));
-    memcpy(&fValue, &foo, sizeof(fValue));
-#endif
+double  AVCRawBinReadDouble(AVCRawBinFile *psFile)
+{
+    GByte abyValue[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    _AVCRawBinReadValue(psFile, 8, abyValue);
+
+    return AVCRawBinDecodeDouble(abyValue);
+}
+
+/**********************************************************************
+ *                          _AVCRawBinReadArray()
+ *
+ * Read numValues values of type eType (AVC_DEC_*) and store them
+ * in pabyDst, in the byte order of the current platform.
+ *
+ * Whatever is available in the current buffer (or in the file mapping)
+ * is decoded in place in one pass, and only the values that overlap 
+ * the buffer boundaries go through AVCRawBinReadBytes().
+ *
+ * If EOF is reached then the error is reported by AVCRawBinReadBytes()
+ * and the values that could not be read are set to 0.
+ **********************************************************************/
+#define AVC_DEC_INT32           0
+#define AVC_DEC_FLOAT2DOUBLE    1
+#define AVC_DEC_DOUBLE          2
+
+static void _AVCRawBinDecodeArray(int eType, const GByte *pabySrc, 
+                                  int numValues, GByte *pabyDst)
+{
+    if (eType == AVC_DEC_INT32)
+        AVCRawBinDecodeInt32Array(pabySrc, numValues, (GInt32*)pabyDst);
+    else if (eType == AVC_DEC_FLOAT2DOUBLE)
+        AVCRawBinDecodeFloatArrayToDouble(pabySrc, numValues, 
+                                          (double*)pabyDst);
+    else
+        AVCRawBinDecodeDoubleArray(pabySrc, numValues, (double*)pabyDst);
+}
+
+static void _AVCRawBinReadArray(AVCRawBinFile *psFile, int eType,
+                                int numValues, GByte *pabyDst)
+{
+    int nSrcSize, nDstSize, nValues, nAvail;
+
+    if (psFile == NULL || 
+        (psFile->eAccess != AVCRead && psFile->eAccess != AVCReadWrite))
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                "AVCRawBinRead<type>Array(): call not compatible with access "
+                 "mode.");
+        return;
+    }
+
+    nSrcSize = (eType == AVC_DEC_DOUBLE) ? 8 : 4;
+    nDstSize = (eType == AVC_DEC_INT32) ? 4 : 8;
+
+    while(numValues > 0)
+    {
+        nAvail = (psFile->nCurSize - psFile->nCurPos) / nSrcSize;
+
+        if (nAvail > 0)
+        {
+            /* Decode directly from the buffer as many values as we can
+             */
+            nValues = MIN(nAvail, numValues);
+            _AVCRawBinDecodeArray(eType, psFile->pabyBuf+psFile->nCurPos,
+                                  nValues, pabyDst);
+            psFile->nCurPos += nValues*nSrcSize;
+        }
+        else
+        {
+            /* The next value is not entirely in memory... 
+             * AVCRawBinReadBytes() will load the next chunk of the file.
+             */
+            GByte   abyValue[8];
+            GIntBig nPos;
+
+            nPos = psFile->nOffset + psFile->nCurPos;
+            AVCRawBinReadBytes(psFile, nSrcSize, abyValue);
+
+            if (psFile->nOffset + psFile->nCurPos - nPos < nSrcSize)
+            {
+                memset(pabyDst, 0, numValues*nDstSize);
+                return;
+            }
+
+            nValues = 1;
+            _AVCRawBinDecodeArray(eType, abyValue, nValues, pabyDst);
+        }
+
+        pabyDst += nValues*nDstSize;
+        numValues -= nValues;
+    }
+}
+
+/**********************************************************************
+ *                          AVCRawBinRead<datatype>Array()
+ *
+ * Read an array of numValues values from the input file and store them
+ * in the user's array with the bytes ordered properly for the current
+ * platform.  AVCRawBinReadFloatArrayToDouble() also converts the single 
+ * precision values to double.
+ *
+ * These are much faster than calling AVCRawBinRead<datatype>() for 
+ * each value, and should be used for long runs of values like vertices.
+ **********************************************************************/
+void    AVCRawBinReadInt32Array(AVCRawBinFile *psFile, int numValues,
+                                GInt32 *panValues)
+{
+    _AVCRawBinReadArray(psFile, AVC_DEC_INT32, numValues, 
+                        (GByte*)panValues);
+}
+
+void    AVCRawBinReadFloatArrayToDouble(AVCRawBinFile *psFile, 
+                                        int numValues, double *padValues)
+{
+    _AVCRawBinReadArray(psFile, AVC_DEC_FLOAT2DOUBLE, numValues, 
+                        (GByte*)padValues);
+}
+
+void    AVCRawBinReadDoubleArray(AVCRawBinFile *psFile, int numValues,
+                                 double *padValues)
+{
+    _AVCRawBinReadArray(psFile, AVC_DEC_DOUBLE, numValues, 
+                        (GByte*)padValues);
+}
+
+/*=====================================================================
+ * Decoding of big-endian values already in memory
+ *====================================================================*/
+
+/**********************************************************************
+ *                          AVCRawBinDecode<datatype>()
+ *
+ * Return the value stored in MSB first byte order at pabySrc, with
+ * the bytes ordered properly for the current platform.  pabySrc does 
+ * not have to be aligned.
+ **********************************************************************/
+GInt16  AVCRawBinDecodeInt16(const GByte *pabySrc)
+{
+    return (GInt16)(((GUInt16)pabySrc[0] << 8) | (GUInt16)pabySrc[1]);
+}
+
+GInt32  AVCRawBinDecodeInt32(const GByte *pabySrc)
+{
+    return (GInt32)(((GUInt32)pabySrc[0] << 24) | 
+                    ((GUInt32)pabySrc[1] << 16) |
+                    ((GUInt32)pabySrc[2] << 8)  | 
+                     (GUInt32)pabySrc[3]);
+}
+
+float   AVCRawBinDecodeFloat(const GByte *pabySrc)
+{
+    GUInt32 nValue;
+    float   fValue;
+
+    nValue = (GUInt32)AVCRawBinDecodeInt32(pabySrc);
+    memcpy(&fValue, &nValue, 4);
 
-    
     return fValue;
 }
 
-double  AVCRawBinReadDouble(AVCRawBinFile *psFile)
+double  AVCRawBinDecodeDouble(const GByte *pabySrc)
 {
     double dValue;
 
-    AVCRawBinReadBytes(psFile, 8, (GByte*)(&dValue));
-
+    memcpy(&dValue, pabySrc, 8);
 #ifdef CPL_LSB
     CPL_SWAPDOUBLE(&dValue);
 #endif
@@ -410,6 +985,129 @@ double  AVCRawBinReadDouble(AVCRawBinFile *psFile)
     return dValue;
 }
 
+/**********************************************************************
+ *                          AVCRawBinDecode<datatype>Array()
+ *
+ * Same as AVCRawBinDecode<datatype>() for numValues consecutive values.
+ *
+ * When the compiler targets AVX2 or SSSE3 (e.g. -mavx2), the bulk of 
+ * the array is byte-swapped (and widened) 8 or 4 values at a time with 
+ * byte shuffles, and the remaining values go through the plain C loop.
+ * Without them, the plain C loop is simple enough to be vectorized by 
+ * most compilers.
+ **********************************************************************/
+void    AVCRawBinDecodeInt32Array(const GByte *pabySrc, int numValues,
+                                  GInt32 *panValues)
+{
+    int i = 0;
+
+#ifdef AVC_USE_AVX2
+    {
+        const __m256i mask = _mm256_setr_epi8(3,2,1,0, 7,6,5,4, 
+                                              11,10,9,8, 15,14,13,12,
+                                              3,2,1,0, 7,6,5,4, 
+                                              11,10,9,8, 15,14,13,12);
+        for( ; i+8 <= numValues; i+=8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(pabySrc+4*i));
+            _mm256_storeu_si256((__m256i*)(panValues+i), 
+                                _mm256_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+#ifdef AVC_USE_SSSE3
+    {
+        const __m128i mask = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 
+                                           11,10,9,8, 15,14,13,12);
+        for( ; i+4 <= numValues; i+=4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(pabySrc+4*i));
+            _mm_storeu_si128((__m128i*)(panValues+i), 
+                             _mm_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+
+    for( ; i<numValues; i++)
+        panValues[i] = AVCRawBinDecodeInt32(pabySrc+4*i);
+}
+
+void    AVCRawBinDecodeFloatArrayToDouble(const GByte *pabySrc, 
+                                          int numValues, double *padValues)
+{
+    int i = 0;
+
+#ifdef AVC_USE_AVX2
+    {
+        const __m256i mask = _mm256_setr_epi8(3,2,1,0, 7,6,5,4, 
+                                              11,10,9,8, 15,14,13,12,
+                                              3,2,1,0, 7,6,5,4, 
+                                              11,10,9,8, 15,14,13,12);
+        for( ; i+8 <= numValues; i+=8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(pabySrc+4*i));
+            __m256  f = _mm256_castsi256_ps(_mm256_shuffle_epi8(v, mask));
+            _mm256_storeu_pd(padValues+i, 
+                             _mm256_cvtps_pd(_mm256_castps256_ps128(f)));
+            _mm256_storeu_pd(padValues+i+4, 
+                             _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)));
+        }
+    }
+#endif
+#ifdef AVC_USE_SSSE3
+    {
+        const __m128i mask = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 
+                                           11,10,9,8, 15,14,13,12);
+        for( ; i+4 <= numValues; i+=4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(pabySrc+4*i));
+            __m128  f = _mm_castsi128_ps(_mm_shuffle_epi8(v, mask));
+            _mm_storeu_pd(padValues+i, _mm_cvtps_pd(f));
+            _mm_storeu_pd(padValues+i+2, _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+        }
+    }
+#endif
+
+    for( ; i<numValues; i++)
+        padValues[i] = AVCRawBinDecodeFloat(pabySrc+4*i);
+}
+
+void    AVCRawBinDecodeDoubleArray(const GByte *pabySrc, int numValues,
+                                   double *padValues)
+{
+    int i = 0;
+
+#ifdef AVC_USE_AVX2
+    {
+        const __m256i mask = _mm256_setr_epi8(7,6,5,4,3,2,1,0, 
+                                              15,14,13,12,11,10,9,8,
+                                              7,6,5,4,3,2,1,0, 
+                                              15,14,13,12,11,10,9,8);
+        for( ; i+4 <= numValues; i+=4)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(pabySrc+8*i));
+            _mm256_storeu_si256((__m256i*)(padValues+i), 
+                                _mm256_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+#ifdef AVC_USE_SSSE3
+    {
+        const __m128i mask = _mm_setr_epi8(7,6,5,4,3,2,1,0, 
+                                           15,14,13,12,11,10,9,8);
+        for( ; i+2 <= numValues; i+=2)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(pabySrc+8*i));
+            _mm_storeu_si128((__m128i*)(padValues+i), 
+                             _mm_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+
+    for( ; i<numValues; i++)
+        padValues[i] = AVCRawBinDecodeDouble(pabySrc+8*i);
+}
+
 
 
 /**********************************************************************
@@ -434,15 +1132,16 @@ void AVCRawBinWriteBytes(AVCRawBinFile *psFile, int nBytesToWrite, GByte *pBuf)
         return;
     }
 
-    if (VSIFWrite(pBuf, nBytesToWrite, 1, psFile->fp) != 1)
+    if (VSIFWriteL(pBuf, nBytesToWrite, 1, psFile->fp) != 1)
         CPLError(CE_Failure, CPLE_FileIO,
                  "Writing to %s failed.", psFile->pszFname);
 
     /*----------------------------------------------------------------
      * In write mode, we keep track of current file position ( =nbr of
-     * bytes written) through psFile->nCurPos
+     * bytes written) through psFile->nOffset, which does not overflow
+     * past 2 GB (nCurPos stays 0)
      *---------------------------------------------------------------*/
-    psFile->nCurPos += nBytesToWrite;
+    psFile->nOffset += nBytesToWrite;
 }
 
 
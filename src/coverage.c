@@ -0,0 +1,210 @@
+#include<stdio.h>
+#include"RArcInfo.h"
+#include"avc.h"
+
+#include<R.h>
+#include<Rinternals.h>
+
+/*
+Coverage handles. A handle keeps the files of a coverage (and the INFO
+tables, with their definitions) open between calls, so that many queries
+against the same coverage only pay the open cost once. The files are
+closed by close_coverage() or, if it is not called, by the finalizer when
+the handle is garbage collected.
+*/
+
+/*An open file of the coverage or an INFO table*/
+typedef struct cov_file
+{
+	char *pszName;
+	AVCFileType eType;
+	AVCBinFile *psFile;
+	struct cov_file *next;
+} cov_file;
+
+typedef struct
+{
+	char szPath[PATH];	/*Coverage directory, ending with a slash*/
+	char szInfoPath[PATH];	/*INFO directory, ending with a slash*/
+	int nPrecision;	/*Precision of the coverage (AVC_*_PREC)*/
+	cov_file *files;
+} cov_handle;
+
+
+static void free_coverage(SEXP ptr)
+{
+	cov_handle *h=(cov_handle *)R_ExternalPtrAddr(ptr);
+	cov_file *f, *next;
+
+	if(!h)
+		return;
+
+	for(f=h->files;f;f=next)
+	{
+		next=f->next;
+		AVCBinReadClose(f->psFile);
+		CPLFree(f->pszName);
+		CPLFree(f);
+	}
+
+	CPLFree(h);
+
+	R_ClearExternalPtr(ptr);
+}
+
+/*Tag of the external pointers of the coverage handles*/
+#define COVERAGE_TAG "RArcInfo_coverage"
+
+/*It returns TRUE if x is a coverage handle*/
+int is_coverage_handle(SEXP x)
+{
+	return TYPEOF(x)==EXTPTRSXP && 
+		R_ExternalPtrTag(x)==install(COVERAGE_TAG);
+}
+
+static cov_handle *get_handle(SEXP x)
+{
+	cov_handle *h;
+
+	if(!is_coverage_handle(x))
+		error("Not a coverage handle");
+
+	h=(cov_handle *)R_ExternalPtrAddr(x);
+	if(!h)
+		error("The coverage has been closed");
+
+	return h;
+}
+
+/*It returns the path to the INFO directory of the coverage, ending with a
+slash*/
+const char *coverage_info_path(SEXP handle)
+{
+	return get_handle(handle)->szInfoPath;
+}
+
+/*It opens a new copy of a file of the coverage (or an INFO table, for
+AVCFileTABLE), that is not kept in the handle. It returns NULL if the file
+cannot be opened*/
+AVCBinFile *coverage_open_file(SEXP handle, const char *pszName, 
+	AVCFileType eType)
+{
+	cov_handle *h=get_handle(handle);
+
+	if(eType==AVCFileTABLE)
+		return AVCBinReadOpen(h->szInfoPath, pszName, eType);
+
+	return AVCBinReadOpen(h->szPath, pszName, eType);
+}
+
+/*
+It returns the file of the coverage (or the INFO table, for AVCFileTABLE)
+ready to read its first record. It is opened the first time and kept open
+in the handle, so it must not be closed by the caller. It returns NULL
+if the file cannot be opened.
+*/
+AVCBinFile *coverage_file(SEXP handle, const char *pszName, AVCFileType eType)
+{
+	cov_handle *h=get_handle(handle);
+	cov_file *f;
+	AVCBinFile *psFile;
+
+	for(f=h->files;f;f=f->next)
+	{
+		if(f->eType==eType && !strcmp(f->pszName, pszName))
+		{
+			if(AVCBinReadRewind(f->psFile))
+				return NULL;
+
+			return f->psFile;
+		}
+	}
+
+	if(!(psFile=coverage_open_file(handle, pszName, eType)))
+		return NULL;
+
+	f=(cov_file *)CPLCalloc(1, sizeof(cov_file));
+	f->pszName=CPLStrdup(pszName);
+	f->eType=eType;
+	f->psFile=psFile;
+	f->next=h->files;
+	h->files=f;
+
+	if(eType!=AVCFileTABLE && eType!=AVCFileTOL && h->nPrecision<0)
+		h->nPrecision=psFile->nPrecision;
+
+	return psFile;
+}
+
+/*It opens a coverage. The files are opened when they are first read*/
+SEXP open_coverage(SEXP directory, SEXP coverage)
+{
+	cov_handle *h;
+	VSIStatBufL sStatBuf;
+	SEXP ptr;
+	const char *pszDir=CHAR(STRING_ELT(directory,0));
+	const char *pszCov=CHAR(STRING_ELT(coverage,0));
+
+	check_path(pszDir, pszCov);
+	check_path(pszDir, "info");
+
+	h=(cov_handle *)CPLCalloc(1, sizeof(cov_handle));
+	h->nPrecision=-1;
+
+	strcpy(h->szPath, pszDir);
+	strcpy(h->szInfoPath, h->szPath);
+	complete_path(h->szPath, (char *)pszCov, 1);
+	complete_path(h->szInfoPath, "info", 1);
+
+	/*The directory may be in memory (see vsimem.write())*/
+	if(VSIStatL(h->szPath, &sStatBuf)!=0 || !VSI_ISDIR(sStatBuf.st_mode))
+	{
+		CPLFree(h);
+		error("The coverage directory doesn't exist");
+	}
+
+	PROTECT(ptr=R_MakeExternalPtr(h, install(COVERAGE_TAG), R_NilValue));
+	R_RegisterCFinalizerEx(ptr, free_coverage, TRUE);
+	UNPROTECT(1);
+
+	return ptr;
+}
+
+/*It closes all the files of the coverage*/
+SEXP close_coverage(SEXP handle)
+{
+	if(!is_coverage_handle(handle))
+		error("Not a coverage handle");
+
+	free_coverage(handle);
+
+	return R_NilValue;
+}
+
+/*It returns the precision of the coverage (1 for single, 2 for double, or
+NA if no file has been read yet) and the number of open files*/
+SEXP coverage_info(SEXP handle)
+{
+	cov_handle *h=get_handle(handle);
+	cov_file *f;
+	SEXP aux;
+	int n;
+
+	for(n=0, f=h->files;f;f=f->next)
+		n++;
+
+	PROTECT(aux=NEW_INTEGER(2));
+
+	if(h->nPrecision==AVC_DOUBLE_PREC)
+		INTEGER(aux)[0]=2;
+	else if(h->nPrecision==AVC_SINGLE_PREC)
+		INTEGER(aux)[0]=1;
+	else
+		INTEGER(aux)[0]=NA_INTEGER;
+
+	INTEGER(aux)[1]=n;
+
+	UNPROTECT(1);
+
+	return aux;
+}
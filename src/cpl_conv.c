@@ -244,7 +244,11 @@ char *CPLStrdup( const char * pszString )
  * Note that CPLReadLine() uses VSIFGets(), so any hooking of VSI file
  * services should apply to CPLReadLine() as well.
  *
- * @param fp file pointer opened with VSIFOpen().
+ * Each thread has its own buffer.  Calling CPLReadLine() with a NULL
+ * file pointer frees the buffer of the calling thread, which a thread 
+ * should do before it ends.
+ *
+ * @param fp file pointer opened with VSIFOpen(), or NULL to free the buffer.
  * @return pointer to an internal buffer containing a line of text read
  * from the file or NULL if the end of file was encountered.
  */
@@ -252,10 +256,18 @@ char *CPLStrdup( const char * pszString )
 const char *CPLReadLine( FILE * fp )
 
 {
-    static char	*pszRLBuffer = NULL;
-    static int	nRLBufferSize = 0;
+    static CPL_THREADLOCAL char	*pszRLBuffer = NULL;
+    static CPL_THREADLOCAL int	nRLBufferSize = 0;
     int		nLength, nReadSoFar = 0;
 
+    if( fp == NULL )
+    {
+        VSIFree( pszRLBuffer );
+        pszRLBuffer = NULL;
+        nRLBufferSize = 0;
+        return NULL;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Loop reading chunks of the line till we get to the end of       */
 /*      the line.                                                       */
@@ -309,3 +321,86 @@ const char *CPLReadLine( FILE * fp )
     return( pszRLBuffer );
 }
 
+/************************************************************************/
+/*                            CPLReadLineL()                            */
+/************************************************************************/
+
+/**
+ * Same as CPLReadLine(), for a file opened with VSIFOpenL().
+ *
+ * The file is read by chunks, and the position is moved back to the
+ * start of the next line, so the file must support VSIFSeekL().  The
+ * line ends with a CR, a LF or both.
+ *
+ * @param fp file opened with VSIFOpenL(), or NULL to free the buffer.
+ * @return pointer to an internal buffer containing a line of text read
+ * from the file or NULL if the end of file was encountered.
+ */
+
+const char *CPLReadLineL( VSILFILE * fp )
+
+{
+    static CPL_THREADLOCAL char *pszRLLBuffer = NULL;
+    static CPL_THREADLOCAL int  nRLLBufferSize = 0;
+    char        szChunk[128];
+    int         i, nChunkSize, nLength = 0;
+    vsi_l_offset nChunkStart;
+
+    if( fp == NULL )
+    {
+        VSIFree( pszRLLBuffer );
+        pszRLLBuffer = NULL;
+        nRLLBufferSize = 0;
+        return NULL;
+    }
+
+    for( ; ; )
+    {
+        nChunkStart = VSIFTellL( fp );
+        nChunkSize = (int) VSIFReadL( szChunk, 1, sizeof(szChunk), fp );
+        if( nChunkSize == 0 && nLength == 0 )
+            return NULL;
+
+        for( i = 0; i < nChunkSize && szChunk[i] != 10 && szChunk[i] != 13;
+             i++ ) {}
+
+        if( nLength + i + 1 > nRLLBufferSize )
+        {
+            nRLLBufferSize = MAX( nRLLBufferSize*2 + 128, nLength + i + 1 );
+            pszRLLBuffer = (char *) VSIRealloc( pszRLLBuffer, nRLLBufferSize );
+            if( pszRLLBuffer == NULL )
+            {
+                nRLLBufferSize = 0;
+                return NULL;
+            }
+        }
+
+        memcpy( pszRLLBuffer + nLength, szChunk, i );
+        nLength += i;
+
+        if( i == nChunkSize && nChunkSize == (int) sizeof(szChunk) )
+            continue;
+
+        /* End of line or of file: skip the CR, LF or CR LF */
+        if( i < nChunkSize )
+        {
+            if( szChunk[i] == 13 && i+1 == nChunkSize )
+            {
+                char chNext;
+
+                if( VSIFReadL( &chNext, 1, 1, fp ) == 1 && chNext == 10 )
+                    i++;
+            }
+            else if( szChunk[i] == 13 && szChunk[i+1] == 10 )
+                i++;
+
+            VSIFSeekL( fp, nChunkStart + i + 1, SEEK_SET );
+        }
+        break;
+    }
+
+    pszRLLBuffer[nLength] = '\0';
+
+    return( pszRLLBuffer );
+}
+
@@ -61,6 +61,7 @@ char CPL_DLL *CPLStrdup( const char * );
 /*      Read a line from a text file, and strip of CR/LF.               */
 /* -------------------------------------------------------------------- */
 const char *CPLReadLine( FILE * );
+const char *CPLReadLineL( VSILFILE * );
 
 /* -------------------------------------------------------------------- */
 /*      Fetch a function from DLL / so.                                 */
@@ -80,13 +80,38 @@
 /* static buffer to store the last error message.  We'll assume that error
  * messages cannot be longer than 2000 chars... which is quite reasonable
  * (that's 25 lines of 80 chars!!!)
+ *
+ * Each thread has its own last error, so that an error in one thread is
+ * not seen (or reset) by the others.
  */
-static char gszCPLLastErrMsg[2000] = "";
-static int  gnCPLLastErrNo = 0;
+static CPL_THREADLOCAL char gszCPLLastErrMsg[2000] = "";
+static CPL_THREADLOCAL int  gnCPLLastErrNo = 0;
 
 static void CPLDefaultErrorHandler( CPLErr, int, const char *);
 static CPLErrorHandler gpfnCPLErrorHandler = CPLDefaultErrorHandler;
 
+/* Error handlers installed by CPLPushErrorHandler() in the current thread,
+ * used instead of gpfnCPLErrorHandler.  Handlers pushed past the size of
+ * the stack are counted, and the last one that fits is used for them.
+ */
+#define CPL_MAX_ERROR_HANDLERS 8
+static CPL_THREADLOCAL CPLErrorHandler gapfnCPLErrorHandlers[CPL_MAX_ERROR_HANDLERS];
+static CPL_THREADLOCAL int gnCPLErrorHandlers = 0;
+
+/* TRUE in the threads started by the library (see CPLSetWorkerThread()),
+ * where nothing may call back into R.
+ */
+static CPL_THREADLOCAL int gbCPLWorkerThread = FALSE;
+
+static CPLErrorHandler CPLGetErrorHandler()
+{
+    if( gnCPLErrorHandlers > 0 )
+        return gapfnCPLErrorHandlers[MIN(gnCPLErrorHandlers,
+                                         CPL_MAX_ERROR_HANDLERS) - 1];
+
+    return gpfnCPLErrorHandler;
+}
+
 /**********************************************************************
  *                          CPLError()
  **********************************************************************/
@@ -126,11 +151,12 @@ static CPLErrorHandler gpfnCPLErrorHandler = CPLDefaultErrorHandler;
 void    CPLError(CPLErr eErrClass, int err_no, const char *fmt, ...)
 {
     va_list args;
+    CPLErrorHandler pfnHandler = CPLGetErrorHandler();
 
     /* Expand the error message 
      */
     va_start(args, fmt);
-    vsprintf(gszCPLLastErrMsg, fmt, args);
+    vsnprintf(gszCPLLastErrMsg, sizeof(gszCPLLastErrMsg), fmt, args);
     va_end(args);
 
     /* If the user provided his own error handling function, then call
@@ -138,11 +164,16 @@ void    CPLError(CPLErr eErrClass, int err_no, const char *fmt, ...)
      */
     gnCPLLastErrNo = err_no;
 
-    if( gpfnCPLErrorHandler )
-        gpfnCPLErrorHandler(eErrClass, err_no, gszCPLLastErrMsg);
+    if( pfnHandler )
+        pfnHandler(eErrClass, err_no, gszCPLLastErrMsg);
 
+    /* R cannot be called to end a fatal error in a worker thread */
     if( eErrClass == CE_Fatal )
+    {
+        if( gbCPLWorkerThread )
+            abort();
         error("CPL fatal error");
+    }
 }
 
 /************************************************************************/
@@ -176,6 +207,7 @@ void CPLDebug( const char * pszCategory, const char * pszFormat, ... )
     char	*pszMessage;
     va_list args;
     const char      *pszDebug = getenv("CPL_DEBUG");
+    CPLErrorHandler pfnHandler;
 
 /* -------------------------------------------------------------------- */
 /*      Does this message pass our current criteria?                    */
@@ -215,8 +247,9 @@ void CPLDebug( const char * pszCategory, const char * pszFormat, ... )
 /*      If the user provided his own error handling function, then call */
 /*      it, otherwise print the error to stderr and return.             */
 /* -------------------------------------------------------------------- */
-    if( gpfnCPLErrorHandler )
-        gpfnCPLErrorHandler(CE_Debug, CPLE_None, pszMessage);
+    pfnHandler = CPLGetErrorHandler();
+    if( pfnHandler )
+        pfnHandler(CE_Debug, CPLE_None, pszMessage);
 
     VSIFree( pszMessage );
 }
@@ -305,6 +338,10 @@ static void CPLDefaultErrorHandler( CPLErr eErrClass, int nError,
         }
     } */
 
+    /* The message of a worker thread is only kept as its last error */
+    if( gbCPLWorkerThread )
+        return;
+
     if( eErrClass == CE_Debug )
         Rprintf("%s\n", pszErrorMsg );
     else if( eErrClass == CE_Warning )
@@ -354,6 +391,81 @@ CPLErrorHandler CPLSetErrorHandler( CPLErrorHandler pfnErrorHandler )
     return pfnOldHandler;
 }
 
+/**********************************************************************
+ *                          CPLPushErrorHandler()
+ **********************************************************************/
+
+/**
+ * Install an error handler for the current thread only.
+ *
+ * Until it is removed by CPLPopErrorHandler(), the errors reported in 
+ * the current thread go to pfnErrorHandler instead of the handler set by
+ * CPLSetErrorHandler().  Handlers can be nested, the last one pushed is 
+ * the one used.  Threads other than the main one must call 
+ * CPLSetWorkerThread() first, since the default handler reports the
+ * errors to R.
+ *
+ * @param pfnErrorHandler new error handler function.
+ */
+
+void CPLPushErrorHandler( CPLErrorHandler pfnErrorHandler )
+{
+    if( gnCPLErrorHandlers < CPL_MAX_ERROR_HANDLERS )
+        gapfnCPLErrorHandlers[gnCPLErrorHandlers] = pfnErrorHandler;
+
+    gnCPLErrorHandlers++;
+}
+
+/**********************************************************************
+ *                          CPLPopErrorHandler()
+ **********************************************************************/
+
+/**
+ * Remove the last error handler installed by CPLPushErrorHandler() in 
+ * the current thread.
+ */
+
+void CPLPopErrorHandler()
+{
+    if( gnCPLErrorHandlers > 0 )
+        gnCPLErrorHandlers--;
+}
+
+/**********************************************************************
+ *                          CPLSetWorkerThread()
+ **********************************************************************/
+
+/**
+ * Mark the calling thread as a worker thread of the library.
+ *
+ * This must be the first call of the threads started by the library.
+ * In such a thread, the default handler does not report the errors (they
+ * are only kept for CPLGetLastErrorNo() and CPLGetLastErrorMsg()), and a 
+ * CE_Fatal error ends in abort() instead of an R error, since R may only
+ * be called from its main thread.
+ */
+
+void CPLSetWorkerThread()
+{
+    gbCPLWorkerThread = TRUE;
+}
+
+/**********************************************************************
+ *                          CPLQuietErrorHandler()
+ **********************************************************************/
+
+/**
+ * Error handler that does not report anything.
+ *
+ * The error number and message are still kept for CPLGetLastErrorNo()
+ * and CPLGetLastErrorMsg().  CE_Fatal errors still end in CPLError().
+ */
+
+void CPLQuietErrorHandler( CPLErr eErrClass, int nError, 
+                           const char * pszErrorMsg )
+{
+}
+
 /************************************************************************/
 /*                             _CPLAssert()                             */
 /*                                                                      */
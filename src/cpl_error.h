@@ -101,6 +101,10 @@ const char CPL_DLL * CPLGetLastErrorMsg();
 
 typedef void (*CPLErrorHandler)(CPLErr, int, const char*);
 CPLErrorHandler CPL_DLL CPLSetErrorHandler(CPLErrorHandler);
+void CPL_DLL CPLPushErrorHandler(CPLErrorHandler);
+void CPL_DLL CPLPopErrorHandler();
+void CPL_DLL CPLSetWorkerThread();
+void CPL_DLL CPLQuietErrorHandler(CPLErr, int, const char*);
 
 void CPL_DLL CPLDebug( const char *, const char *, ... );
 void CPL_DLL _CPLAssert( const char *, const char *, int );
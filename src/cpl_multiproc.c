@@ -0,0 +1,153 @@
+/**********************************************************************
+ * Name:     cpl_multiproc.c
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Mutexes for the state that CPL and VSI share between threads.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "cpl_multiproc.h"
+#include "cpl_conv.h"
+
+#ifdef CPL_MULTIPROC_PTHREAD
+
+/*=====================================================================
+                      POSIX threads implementation
+ *====================================================================*/
+
+#include <pthread.h>
+
+/* Guards the creation of the mutexes of CPLCreateOrAcquireMutex() */
+static pthread_mutex_t hCreationMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**********************************************************************
+ *                          CPLCreateMutex()
+ *
+ * Create a mutex, which is returned already acquired by the calling
+ * thread.  Returns NULL if it could not be created.
+ **********************************************************************/
+void *CPLCreateMutex( void )
+{
+    pthread_mutex_t *phMutex;
+
+    phMutex = (pthread_mutex_t *) VSIMalloc( sizeof(pthread_mutex_t) );
+    if( phMutex == NULL )
+        return NULL;
+
+    if( pthread_mutex_init( phMutex, NULL ) != 0 )
+    {
+        VSIFree( phMutex );
+        return NULL;
+    }
+
+    pthread_mutex_lock( phMutex );
+
+    return phMutex;
+}
+
+/**********************************************************************
+ *                        CPLCreateOrAcquireMutex()
+ *
+ * Acquire the mutex in *phMutex, creating it on first use.  This is the
+ * way to use a mutex kept in a static variable, which cannot be created
+ * beforehand.
+ *
+ * Returns TRUE if the mutex was acquired.
+ **********************************************************************/
+int CPLCreateOrAcquireMutex( void **phMutex )
+{
+    int bCreated = FALSE;
+
+    pthread_mutex_lock( &hCreationMutex );
+    if( *phMutex == NULL )
+    {
+        *phMutex = CPLCreateMutex();
+        bCreated = TRUE;
+    }
+    pthread_mutex_unlock( &hCreationMutex );
+
+    if( *phMutex == NULL )
+        return FALSE;
+
+    return bCreated || CPLAcquireMutex( *phMutex );
+}
+
+/**********************************************************************
+ *                          CPLAcquireMutex()
+ *
+ * Returns TRUE if the mutex was acquired.
+ **********************************************************************/
+int CPLAcquireMutex( void *hMutex )
+{
+    return pthread_mutex_lock( (pthread_mutex_t *) hMutex ) == 0;
+}
+
+/**********************************************************************
+ *                          CPLReleaseMutex()
+ **********************************************************************/
+void CPLReleaseMutex( void *hMutex )
+{
+    pthread_mutex_unlock( (pthread_mutex_t *) hMutex );
+}
+
+/**********************************************************************
+ *                          CPLDestroyMutex()
+ **********************************************************************/
+void CPLDestroyMutex( void *hMutex )
+{
+    pthread_mutex_destroy( (pthread_mutex_t *) hMutex );
+    VSIFree( hMutex );
+}
+
+#else
+
+/*=====================================================================
+           Stub implementation, for a library used by one thread
+ *====================================================================*/
+
+static int nDummyMutex;
+
+void *CPLCreateMutex( void )
+{
+    return &nDummyMutex;
+}
+
+int CPLCreateOrAcquireMutex( void **phMutex )
+{
+    if( *phMutex == NULL )
+        *phMutex = CPLCreateMutex();
+
+    return TRUE;
+}
+
+int CPLAcquireMutex( void *hMutex )
+{
+    return TRUE;
+}
+
+void CPLReleaseMutex( void *hMutex )
+{
+}
+
+void CPLDestroyMutex( void *hMutex )
+{
+}
+
+#endif
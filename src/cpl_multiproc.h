@@ -0,0 +1,50 @@
+/**********************************************************************
+ * Name:     cpl_multiproc.h
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Mutexes for the state that CPL and VSI share between threads.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#ifndef CPL_MULTIPROC_H_INCLUDED
+#define CPL_MULTIPROC_H_INCLUDED
+
+#include "cpl_port.h"
+
+/*---------------------------------------------------------------------
+ * POSIX threads are used where the AVC library may start threads
+ * (see AVC_USE_THREADS in avc_bin.c).  Elsewhere, and if CPL_NO_THREADS
+ * is defined, the mutexes do nothing.
+ *--------------------------------------------------------------------*/
+#if !defined(WIN32) && !defined(CPL_NO_THREADS)
+#  define CPL_MULTIPROC_PTHREAD
+#endif
+
+CPL_C_START
+
+void CPL_DLL *CPLCreateMutex( void );
+int  CPL_DLL  CPLCreateOrAcquireMutex( void **phMutex );
+int  CPL_DLL  CPLAcquireMutex( void *hMutex );
+void CPL_DLL  CPLReleaseMutex( void *hMutex );
+void CPL_DLL  CPLDestroyMutex( void *hMutex );
+
+CPL_C_END
+
+#endif /* ndef CPL_MULTIPROC_H_INCLUDED */
@@ -144,6 +144,39 @@ typedef unsigned short  GUInt16;
 typedef unsigned char   GByte;
 typedef int             GBool;
 
+/*---------------------------------------------------------------------
+ *        types for 64 bits integers
+ *--------------------------------------------------------------------*/
+#if defined(_MSC_VER)
+typedef __int64          GIntBig;
+typedef unsigned __int64 GUIntBig;
+#else
+typedef long long        GIntBig;
+typedef unsigned long long GUIntBig;
+#endif
+
+
+/*---------------------------------------------------------------------
+ *        thread-local storage
+ *
+ * The state kept by the library between calls (last error, buffers of
+ * CPLReadLine() and CPLSPrintf(), ...) is declared CPL_THREADLOCAL so
+ * that each thread has its own copy.  Define CPL_NO_THREADLOCAL on 
+ * compilers without thread-local storage to get a single copy, in which
+ * case the library must be used from one thread at a time.
+ *--------------------------------------------------------------------*/
+#if defined(CPL_NO_THREADLOCAL)
+#  define CPL_THREADLOCAL
+#elif defined(_MSC_VER)
+#  define CPL_THREADLOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__) || defined(__SUNPRO_C)
+#  define CPL_THREADLOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#  define CPL_THREADLOCAL _Thread_local
+#else
+#  define CPL_THREADLOCAL
+#endif
+
 
 /* ==================================================================== */
 /*      Other standard services.                                        */
@@ -219,27 +219,25 @@ char    **CSLDuplicate(char **papszStrList)
  *
  * Load a test file into a stringlist.
  *
- * Lines are limited in length by the size fo the CPLReadLine() buffer.
+ * The file is read with CPLReadLineL(), so it can be in any of the
+ * file systems of VSIFOpenL().
  **********************************************************************/
 char **CSLLoad(const char *pszFname)
 {
-    FILE        *fp;
+    VSILFILE    *fp;
     const char  *pszLine;
     char        **papszStrList=NULL;
 
-    fp = VSIFOpen(pszFname, "rt");
+    fp = VSIFOpenL(pszFname, "rb");
 
     if (fp)
     {
-        while(!VSIFEof(fp))
+        while((pszLine = CPLReadLineL(fp)) != NULL)
         {
-            if ( (pszLine = CPLReadLine(fp)) != NULL )
-            {
-                papszStrList = CSLAddString(papszStrList, pszLine);
-            }
+            papszStrList = CSLAddString(papszStrList, pszLine);
         }
 
-        VSIFClose(fp);
+        VSIFCloseL(fp);
     }
     else
     {
@@ -668,9 +666,10 @@ char ** CSLTokenizeStringComplex( const char * pszString,
  * NOTE: This function should move to cpl_conv.cpp. 
  **********************************************************************/
 /* For now, assume that a 8000 chars buffer will be enough.
+ * Each thread has its own buffer.
  */
 #define CPLSPrintf_BUF_SIZE 8000
-static char gszCPLSPrintfBuffer[CPLSPrintf_BUF_SIZE];
+static CPL_THREADLOCAL char gszCPLSPrintfBuffer[CPLSPrintf_BUF_SIZE];
 
 const char *CPLSPrintf(char *fmt, ...)
 {
@@ -112,6 +112,10 @@ int CPL_DLL     VSIFPutc( int, FILE * );
 int CPL_DLL     VSIUngetc( int, FILE * );
 int CPL_DLL	VSIFEof( FILE * );
 
+void CPL_DLL   *VSIFMap( FILE *, size_t * );
+void CPL_DLL    VSIFUnmap( void *, size_t );
+void CPL_DLL    VSIFAdviseSequential( FILE *, void *, size_t );
+
 /* ==================================================================== */
 /*      VSIStat() related.                                              */
 /* ==================================================================== */
@@ -119,6 +123,49 @@ int CPL_DLL	VSIFEof( FILE * );
 typedef struct stat VSIStatBuf;
 int CPL_DLL	VSIStat( const char *, VSIStatBuf * );
 
+/* ==================================================================== */
+/*      Large file (64 bit offsets) versions of the above.  A long, or  */
+/*      the st_size of a struct stat, cannot hold the size of files     */
+/*      larger than 2 GB on all platforms.                              */
+/*                                                                      */
+/*      These go through the virtual file systems of cpl_vsil.c: the    */
+/*      files whose name starts with the prefix of a file system (such  */
+/*      as /vsimem/) are handled by it, the others by stdio.            */
+/* ==================================================================== */
+
+typedef GUIntBig vsi_l_offset;
+
+typedef struct VSIVirtualHandle_t VSILFILE;
+
+VSILFILE CPL_DLL *   VSIFOpenL( const char *, const char * );
+int CPL_DLL          VSIFCloseL( VSILFILE * );
+int CPL_DLL          VSIFSeekL( VSILFILE *, vsi_l_offset, int );
+vsi_l_offset CPL_DLL VSIFTellL( VSILFILE * );
+size_t CPL_DLL       VSIFReadL( void *, size_t, size_t, VSILFILE * );
+size_t CPL_DLL       VSIFWriteL( const void *, size_t, size_t, VSILFILE * );
+int CPL_DLL          VSIFEofL( VSILFILE * );
+
+void CPL_DLL        *VSIFMapL( VSILFILE *, size_t * );
+void CPL_DLL         VSIFUnmapL( VSILFILE *, void *, size_t );
+void CPL_DLL         VSIFAdviseSequentialL( VSILFILE *, void *, size_t );
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+typedef struct _stati64 VSIStatBufL;
+#else
+typedef struct stat VSIStatBufL;
+#endif
+int CPL_DLL     VSIStatL( const char *, VSIStatBufL * );
+int CPL_DLL     VSIUnlink( const char * );
+char CPL_DLL  **VSIReadDir( const char * );
+
+/* ==================================================================== */
+/*      In-memory files, under /vsimem/.                                */
+/* ==================================================================== */
+
+VSILFILE CPL_DLL *VSIFileFromMemBuffer( const char *, GByte *, 
+                                        vsi_l_offset, int );
+GByte CPL_DLL    *VSIGetMemFileBuffer( const char *, vsi_l_offset *, int );
+
 #ifdef _WIN32
 #  define VSI_ISLNK(x)	( 0 )            /* N/A on Windows */
 #  define VSI_ISREG(x)	((x) & S_IFREG)
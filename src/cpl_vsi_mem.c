@@ -0,0 +1,644 @@
+/**********************************************************************
+ * Name:     cpl_vsi_mem.c
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Virtual file system of the files kept in memory, whose
+ *           names start with /vsimem/.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************
+ *
+ * A file is made with VSIFileFromMemBuffer(), or by opening a name under
+ * /vsimem/ for writing.  Directories are not made: a directory exists as
+ * long as there are files under it.  Names are compared after turning
+ * backslashes into slashes and resolving "." and "..", so that the
+ * "../info/" paths built by the AVC library work.
+ *
+ * The list of files is shared by all the threads.  A file stays in
+ * memory until it is unlinked and all its handles are closed, so it can
+ * be replaced or unlinked while other threads read it.  A file must not
+ * be written while it is open elsewhere, though: its data may move.
+ **********************************************************************/
+
+#include "cpl_vsi_virtual.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_multiproc.h"
+
+#include <errno.h>
+#include <limits.h>
+
+#define VSIMEM_PREFIX       "/vsimem"
+
+typedef struct VSIMemFile_t
+{
+    char        *pszFilename;   /* Name, see VSIMemNormalize()          */
+    GByte       *pabyData;
+    vsi_l_offset nLength;
+    vsi_l_offset nAllocLength;
+    int         bOwnData;       /* pabyData is freed with the file      */
+    int         nRefCount;      /* The list of files and open handles   */
+    struct VSIMemFile_t *psNext;
+} VSIMemFile;
+
+typedef struct
+{
+    VSILFILE    sBase;
+    VSIMemFile  *psFile;
+    vsi_l_offset nOffset;
+    int         bUpdate;
+    int         bAppend;
+    int         bEOF;
+} VSIMemHandle;
+
+static VSIMemFile *psMemFiles = NULL;
+static void       *hMemFilesMutex = NULL;
+
+/**********************************************************************
+ *                          VSIMemNormalize()
+ *
+ * Return a copy of a file name as "/vsimem" for the root and
+ * "/vsimem/dir/name" for the others (see VSINormalizePath()).  It is
+ * freed with CPLFree().
+ **********************************************************************/
+static char *VSIMemNormalize( const char *pszFilename )
+{
+    return VSINormalizePath( pszFilename, strlen( VSIMEM_PREFIX ) );
+}
+
+/**********************************************************************
+ *                          VSIMemFind()
+ *
+ * Return the file with a (normalized) name, or NULL.  The caller holds
+ * hMemFilesMutex.
+ **********************************************************************/
+static VSIMemFile *VSIMemFind( const char *pszName )
+{
+    VSIMemFile *psFile;
+
+    for( psFile = psMemFiles; psFile != NULL; psFile = psFile->psNext )
+    {
+        if( strcmp( psFile->pszFilename, pszName ) == 0 )
+            return psFile;
+    }
+
+    return NULL;
+}
+
+/**********************************************************************
+ *                          VSIMemIsDir()
+ *
+ * Return TRUE if there are files under a (normalized) directory name.
+ * The caller holds hMemFilesMutex.
+ **********************************************************************/
+static int VSIMemIsDir( const char *pszName )
+{
+    VSIMemFile *psFile;
+    int         nLen = strlen( pszName );
+
+    if( strcmp( pszName, VSIMEM_PREFIX ) == 0 )
+        return TRUE;
+
+    for( psFile = psMemFiles; psFile != NULL; psFile = psFile->psNext )
+    {
+        if( strncmp( psFile->pszFilename, pszName, nLen ) == 0 &&
+            psFile->pszFilename[nLen] == '/' )
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**********************************************************************
+ *                          VSIMemRelease()
+ *
+ * Drop a reference to a file, and free it with the last one.  The
+ * caller holds hMemFilesMutex.
+ **********************************************************************/
+static void VSIMemRelease( VSIMemFile *psFile )
+{
+    if( --psFile->nRefCount > 0 )
+        return;
+
+    if( psFile->bOwnData )
+        CPLFree( psFile->pabyData );
+    CPLFree( psFile->pszFilename );
+    CPLFree( psFile );
+}
+
+/**********************************************************************
+ *                          VSIMemRemove()
+ *
+ * Take a file out of the list of files.  It is freed when its last
+ * handle is closed.  The caller holds hMemFilesMutex.
+ **********************************************************************/
+static void VSIMemRemove( VSIMemFile *psFile )
+{
+    VSIMemFile **ppsLink;
+
+    for( ppsLink = &psMemFiles; *ppsLink != NULL;
+         ppsLink = &((*ppsLink)->psNext) )
+    {
+        if( *ppsLink == psFile )
+        {
+            *ppsLink = psFile->psNext;
+            VSIMemRelease( psFile );
+            return;
+        }
+    }
+}
+
+/**********************************************************************
+ *                          VSIMemAdd()
+ *
+ * Add a new file to the list, in place of the one with the same name if
+ * there is one.  The caller holds hMemFilesMutex.
+ **********************************************************************/
+static void VSIMemAdd( VSIMemFile *psFile )
+{
+    VSIMemFile *psOld;
+
+    if( (psOld = VSIMemFind( psFile->pszFilename )) != NULL )
+        VSIMemRemove( psOld );
+
+    psFile->nRefCount = 1;
+    psFile->psNext = psMemFiles;
+    psMemFiles = psFile;
+}
+
+/**********************************************************************
+ *                          VSIMemNewHandle()
+ **********************************************************************/
+static VSILFILE *VSIMemNewHandle( VSIMemHandle *psHandle,
+                                  VSIMemFile *psFile, const char *pszAccess )
+{
+    psHandle->sBase.psFS = &sVSIMemFilesystemHandler;
+    psHandle->psFile = psFile;
+    psHandle->bUpdate = (strchr( pszAccess, 'w' ) != NULL ||
+                         strchr( pszAccess, 'a' ) != NULL ||
+                         strchr( pszAccess, '+' ) != NULL);
+    psHandle->bAppend = (strchr( pszAccess, 'a' ) != NULL);
+
+    return (VSILFILE *) psHandle;
+}
+
+/**********************************************************************
+ *                          VSIMemOpen()
+ **********************************************************************/
+static VSILFILE *VSIMemOpen( VSIFilesystemHandler *psFS,
+                             const char *pszFilename, const char *pszAccess )
+{
+    VSIMemHandle *psHandle;
+    VSIMemFile  *psFile, *psNewFile;
+    char        *pszName = VSIMemNormalize( pszFilename );
+
+    /* Everything that may fail is allocated before the mutex is taken */
+    psHandle = (VSIMemHandle *) CPLCalloc( 1, sizeof(VSIMemHandle) );
+    psNewFile = (VSIMemFile *) CPLCalloc( 1, sizeof(VSIMemFile) );
+    psNewFile->pszFilename = pszName;
+    psNewFile->bOwnData = TRUE;
+
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        CPLFree( psHandle );
+        CPLFree( psNewFile->pszFilename );
+        CPLFree( psNewFile );
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    psFile = VSIMemFind( pszName );
+
+    if( strchr( pszAccess, 'w' ) != NULL ||
+        (strchr( pszAccess, 'a' ) != NULL && psFile == NULL) )
+    {
+        VSIMemAdd( psNewFile );
+        psFile = psNewFile;
+        psNewFile = NULL;
+    }
+
+    if( psFile != NULL )
+        psFile->nRefCount++;
+
+    CPLReleaseMutex( hMemFilesMutex );
+
+    if( psNewFile != NULL )
+    {
+        CPLFree( psNewFile->pszFilename );
+        CPLFree( psNewFile );
+    }
+
+    if( psFile == NULL )
+    {
+        CPLFree( psHandle );
+        errno = ENOENT;
+        return NULL;
+    }
+
+    return VSIMemNewHandle( psHandle, psFile, pszAccess );
+}
+
+/**********************************************************************
+ *                          VSIMemStat()
+ **********************************************************************/
+static int VSIMemStat( VSIFilesystemHandler *psFS, const char *pszFilename,
+                       VSIStatBufL *psStatBuf )
+{
+    VSIMemFile  *psFile;
+    char        *pszName = VSIMemNormalize( pszFilename );
+    int         nRet = 0;
+
+    memset( psStatBuf, 0, sizeof(VSIStatBufL) );
+
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        CPLFree( pszName );
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if( (psFile = VSIMemFind( pszName )) != NULL )
+    {
+        psStatBuf->st_mode = S_IFREG;
+        psStatBuf->st_size = psFile->nLength;
+    }
+    else if( VSIMemIsDir( pszName ) )
+        psStatBuf->st_mode = S_IFDIR;
+    else
+        nRet = -1;
+
+    CPLReleaseMutex( hMemFilesMutex );
+
+    CPLFree( pszName );
+
+    if( nRet != 0 )
+        errno = ENOENT;
+
+    return nRet;
+}
+
+/**********************************************************************
+ *                          VSIMemUnlink()
+ **********************************************************************/
+static int VSIMemUnlink( VSIFilesystemHandler *psFS,
+                         const char *pszFilename )
+{
+    VSIMemFile  *psFile;
+    char        *pszName = VSIMemNormalize( pszFilename );
+
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        CPLFree( pszName );
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if( (psFile = VSIMemFind( pszName )) != NULL )
+        VSIMemRemove( psFile );
+
+    CPLReleaseMutex( hMemFilesMutex );
+
+    CPLFree( pszName );
+
+    if( psFile == NULL )
+    {
+        errno = ENOENT;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          VSIMemReadDir()
+ *
+ * The names of the files and directories right under a directory.
+ **********************************************************************/
+static char **VSIMemReadDir( VSIFilesystemHandler *psFS,
+                             const char *pszPath )
+{
+    VSIMemFile  *psFile;
+    char        *pszName = VSIMemNormalize( pszPath ), **papszDir = NULL;
+    char        **papszNames = NULL;
+    const char  *pszChild;
+    int         i, nLen = strlen( pszName ), nChildLen;
+
+    /* The names are copied first, CSLAddString() may fail */
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        CPLFree( pszName );
+        return NULL;
+    }
+
+    for( psFile = psMemFiles; psFile != NULL; psFile = psFile->psNext )
+    {
+        if( strncmp( psFile->pszFilename, pszName, nLen ) == 0 &&
+            psFile->pszFilename[nLen] == '/' )
+            papszNames = CSLAddString( papszNames,
+                                       psFile->pszFilename + nLen + 1 );
+    }
+
+    CPLReleaseMutex( hMemFilesMutex );
+
+    for( i = 0; papszNames != NULL && papszNames[i] != NULL; i++ )
+    {
+        pszChild = papszNames[i];
+        for( nChildLen = 0; pszChild[nChildLen] != '\0' &&
+                            pszChild[nChildLen] != '/'; nChildLen++ ) {}
+
+        papszNames[i][nChildLen] = '\0';
+        if( CSLFindString( papszDir, papszNames[i] ) == -1 )
+            papszDir = CSLAddString( papszDir, papszNames[i] );
+    }
+
+    CSLDestroy( papszNames );
+    CPLFree( pszName );
+
+    return papszDir;
+}
+
+/**********************************************************************
+ *                          VSIMemClose()
+ **********************************************************************/
+static int VSIMemClose( VSILFILE *fp )
+{
+    VSIMemHandle *psHandle = (VSIMemHandle *) fp;
+
+    /* Without the mutex the file keeps the reference of the handle */
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        CPLFree( psHandle );
+        errno = ENOMEM;
+        return -1;
+    }
+
+    VSIMemRelease( psHandle->psFile );
+    CPLReleaseMutex( hMemFilesMutex );
+
+    CPLFree( psHandle );
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          VSIMemSeek()
+ *
+ * As with fseek(), the position may be past the end of the file.
+ **********************************************************************/
+static int VSIMemSeek( VSILFILE *fp, vsi_l_offset nOffset, int nWhence )
+{
+    VSIMemHandle *psHandle = (VSIMemHandle *) fp;
+
+    if( nWhence == SEEK_CUR )
+        psHandle->nOffset += nOffset;
+    else if( nWhence == SEEK_END )
+        psHandle->nOffset = psHandle->psFile->nLength + nOffset;
+    else
+        psHandle->nOffset = nOffset;
+
+    psHandle->bEOF = FALSE;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          VSIMemTell()
+ **********************************************************************/
+static vsi_l_offset VSIMemTell( VSILFILE *fp )
+{
+    return ((VSIMemHandle *) fp)->nOffset;
+}
+
+/**********************************************************************
+ *                          VSIMemRead()
+ **********************************************************************/
+static size_t VSIMemRead( void *pBuffer, size_t nSize, size_t nCount,
+                          VSILFILE *fp )
+{
+    VSIMemHandle *psHandle = (VSIMemHandle *) fp;
+    VSIMemFile  *psFile = psHandle->psFile;
+    size_t      nBytes = nSize * nCount;
+
+    if( nBytes == 0 )
+        return 0;
+
+    if( psHandle->nOffset >= psFile->nLength )
+    {
+        psHandle->bEOF = TRUE;
+        return 0;
+    }
+
+    if( nBytes > psFile->nLength - psHandle->nOffset )
+    {
+        nBytes = (size_t) (psFile->nLength - psHandle->nOffset);
+        psHandle->bEOF = TRUE;
+    }
+
+    memcpy( pBuffer, psFile->pabyData + psHandle->nOffset, nBytes );
+    psHandle->nOffset += nBytes;
+
+    return nBytes / nSize;
+}
+
+/**********************************************************************
+ *                          VSIMemWrite()
+ *
+ * The data of the file grows as needed, unless it belongs to the
+ * caller of VSIFileFromMemBuffer().
+ **********************************************************************/
+static size_t VSIMemWrite( const void *pBuffer, size_t nSize,
+                           size_t nCount, VSILFILE *fp )
+{
+    VSIMemHandle *psHandle = (VSIMemHandle *) fp;
+    VSIMemFile  *psFile = psHandle->psFile;
+    size_t      nBytes = nSize * nCount;
+    vsi_l_offset nEnd, nNewAlloc;
+    GByte       *pabyNewData;
+
+    if( !psHandle->bUpdate )
+    {
+        errno = EBADF;
+        return 0;
+    }
+
+    if( psHandle->bAppend )
+        psHandle->nOffset = psFile->nLength;
+
+    nEnd = psHandle->nOffset + nBytes;
+
+    if( nEnd > psFile->nAllocLength )
+    {
+        nNewAlloc = MAX( nEnd, psFile->nAllocLength +
+                                   psFile->nAllocLength/2 + 1024 );
+        if( !psFile->bOwnData || nNewAlloc != (size_t) nNewAlloc ||
+            (pabyNewData = (GByte *) VSIRealloc( psFile->pabyData,
+                                        (size_t) nNewAlloc )) == NULL )
+        {
+            errno = ENOSPC;
+            return 0;
+        }
+
+        psFile->pabyData = pabyNewData;
+        psFile->nAllocLength = nNewAlloc;
+    }
+
+    /* Writing past the end leaves a hole of zeros, as in a file */
+    if( psHandle->nOffset > psFile->nLength )
+        memset( psFile->pabyData + psFile->nLength, 0,
+                (size_t) (psHandle->nOffset - psFile->nLength) );
+
+    memcpy( psFile->pabyData + psHandle->nOffset, pBuffer, nBytes );
+    psHandle->nOffset = nEnd;
+    psFile->nLength = MAX( psFile->nLength, nEnd );
+
+    return nCount;
+}
+
+/**********************************************************************
+ *                          VSIMemEof()
+ **********************************************************************/
+static int VSIMemEof( VSILFILE *fp )
+{
+    return ((VSIMemHandle *) fp)->bEOF;
+}
+
+/**********************************************************************
+ *                          VSIMemMap()
+ *
+ * The data of the file is used in place, with the limits of VSIFMap().
+ * Nothing has to be done to unmap it: the handle keeps it alive.
+ **********************************************************************/
+static void *VSIMemMap( VSILFILE *fp, size_t *pnSize )
+{
+    VSIMemFile  *psFile = ((VSIMemHandle *) fp)->psFile;
+
+    if( psFile->nLength == 0 || psFile->nLength > INT_MAX )
+        return NULL;
+
+    *pnSize = (size_t) psFile->nLength;
+
+    return psFile->pabyData;
+}
+
+VSIFilesystemHandler sVSIMemFilesystemHandler =
+{
+    VSIMemOpen, VSIMemStat, VSIMemUnlink, VSIMemReadDir,
+    VSIMemClose, VSIMemSeek, VSIMemTell, VSIMemRead, VSIMemWrite,
+    VSIMemEof,
+    VSIMemMap, NULL, NULL
+};
+
+/**********************************************************************
+ *                          VSIFileFromMemBuffer()
+ *
+ * Make a file under /vsimem/ with the nDataLength bytes of pabyData, in
+ * place of the file with the same name if there is one.  If
+ * bTakeOwnership is TRUE, pabyData was allocated with CPLMalloc() and it
+ * is freed with the file; otherwise the caller keeps it alive while the
+ * file exists, and the file cannot grow.  If pabyData is NULL the file
+ * is empty.
+ *
+ * Returns the file open for reading and writing, to be closed with
+ * VSIFCloseL(), or NULL if the name is not under /vsimem/ or the list
+ * of files cannot be locked.  pabyData is not taken on failure.
+ **********************************************************************/
+VSILFILE *VSIFileFromMemBuffer( const char *pszFilename, GByte *pabyData,
+                                vsi_l_offset nDataLength, int bTakeOwnership )
+{
+    VSIMemHandle *psHandle;
+    VSIMemFile  *psFile;
+
+    if( strncmp( pszFilename, VSIMEM_PREFIX "/",
+                 strlen( VSIMEM_PREFIX "/" ) ) != 0 )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "VSIFileFromMemBuffer(): %s is not under %s/.",
+                  pszFilename, VSIMEM_PREFIX );
+        return NULL;
+    }
+
+    psHandle = (VSIMemHandle *) CPLCalloc( 1, sizeof(VSIMemHandle) );
+    psFile = (VSIMemFile *) CPLCalloc( 1, sizeof(VSIMemFile) );
+    psFile->pszFilename = VSIMemNormalize( pszFilename );
+    psFile->pabyData = pabyData;
+    psFile->nLength = psFile->nAllocLength = (pabyData ? nDataLength : 0);
+    psFile->bOwnData = (pabyData == NULL || bTakeOwnership);
+
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        errno = ENOMEM;
+        CPLFree( psFile->pszFilename );
+        CPLFree( psFile );
+        CPLFree( psHandle );
+        return NULL;
+    }
+    VSIMemAdd( psFile );
+    psFile->nRefCount++;
+    CPLReleaseMutex( hMemFilesMutex );
+
+    return VSIMemNewHandle( psHandle, psFile, "r+" );
+}
+
+/**********************************************************************
+ *                          VSIGetMemFileBuffer()
+ *
+ * Return the data of a file under /vsimem/, and its length in
+ * *pnDataLength if it is not NULL.  If bUnlinkAndSeize is TRUE the file
+ * is unlinked and the data now belongs to the caller, who frees it with
+ * CPLFree(); this is only possible for data that belonged to the file,
+ * and while no handle of the file is open.
+ *
+ * Returns NULL if there is no such file (or if its data cannot be
+ * seized).
+ **********************************************************************/
+GByte *VSIGetMemFileBuffer( const char *pszFilename,
+                            vsi_l_offset *pnDataLength, int bUnlinkAndSeize )
+{
+    VSIMemFile  *psFile;
+    GByte       *pabyData = NULL;
+    char        *pszName = VSIMemNormalize( pszFilename );
+
+    if( !CPLCreateOrAcquireMutex( &hMemFilesMutex ) )
+    {
+        CPLFree( pszName );
+        return NULL;
+    }
+
+    /* The only reference to a file without open handles is the list */
+    psFile = VSIMemFind( pszName );
+    if( psFile != NULL && 
+        (!bUnlinkAndSeize || (psFile->bOwnData && psFile->nRefCount == 1)) )
+    {
+        pabyData = psFile->pabyData;
+        if( pnDataLength != NULL )
+            *pnDataLength = psFile->nLength;
+
+        if( bUnlinkAndSeize )
+        {
+            psFile->bOwnData = FALSE;
+            VSIMemRemove( psFile );
+        }
+    }
+
+    CPLReleaseMutex( hMemFilesMutex );
+
+    CPLFree( pszName );
+
+    return pabyData;
+}
@@ -0,0 +1,93 @@
+/**********************************************************************
+ * Name:     cpl_vsi_virtual.h
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Interface of the virtual file systems behind VSIFOpenL()
+ *           and the other large file functions of cpl_vsi.h.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#ifndef CPL_VSI_VIRTUAL_H_INCLUDED
+#define CPL_VSI_VIRTUAL_H_INCLUDED
+
+#include "cpl_vsi.h"
+
+CPL_C_START
+
+typedef struct VSIFilesystemHandler_t VSIFilesystemHandler;
+
+/*---------------------------------------------------------------------
+ * An open file.  Each file system returns its own structure, which
+ * starts with this one.
+ *--------------------------------------------------------------------*/
+struct VSIVirtualHandle_t
+{
+    VSIFilesystemHandler *psFS;     /* File system of the file          */
+};
+
+/*---------------------------------------------------------------------
+ * A file system: the functions on file names, and those on the files
+ * returned by pfnOpen().  They follow the calling pattern of the
+ * VSI*L() functions that call them.
+ *
+ * The functions marked as optional may be NULL: VSIFMapL() then
+ * returns NULL, VSIReadDir() returns NULL and the others do nothing.
+ *
+ * Several threads may open and read the files of a file system at
+ * once, so its functions on file names must be thread safe.  A file is
+ * only used by one thread at a time.
+ *--------------------------------------------------------------------*/
+struct VSIFilesystemHandler_t
+{
+    VSILFILE *  (*pfnOpen)( VSIFilesystemHandler *, const char *,
+                            const char * );
+    int         (*pfnStat)( VSIFilesystemHandler *, const char *,
+                            VSIStatBufL * );
+    int         (*pfnUnlink)( VSIFilesystemHandler *, const char * );
+    char **     (*pfnReadDir)( VSIFilesystemHandler *, const char * );
+
+    int         (*pfnClose)( VSILFILE * );
+    int         (*pfnSeek)( VSILFILE *, vsi_l_offset, int );
+    vsi_l_offset (*pfnTell)( VSILFILE * );
+    size_t      (*pfnRead)( void *, size_t, size_t, VSILFILE * );
+    size_t      (*pfnWrite)( const void *, size_t, size_t, VSILFILE * );
+    int         (*pfnEof)( VSILFILE * );
+
+    /* Optional: the whole file in memory, see VSIFMap() */
+    void *      (*pfnMap)( VSILFILE *, size_t * );
+    void        (*pfnUnmap)( VSILFILE *, void *, size_t );
+    void        (*pfnAdviseSequential)( VSILFILE *, void *, size_t );
+};
+
+void CPL_DLL VSIInstallFileHandler( const char *pszPrefix,
+                                    VSIFilesystemHandler *psFS );
+VSIFilesystemHandler CPL_DLL *VSIGetFileHandler( const char *pszPath );
+char CPL_DLL *VSINormalizePath( const char *pszFilename, int nPrefix );
+
+/* Built-in file systems (see cpl_vsil.c) */
+extern VSIFilesystemHandler sVSIStdioFilesystemHandler;
+extern VSIFilesystemHandler sVSIMemFilesystemHandler;
+extern VSIFilesystemHandler sVSIZipFilesystemHandler;
+extern VSIFilesystemHandler sVSIGZipFilesystemHandler;
+extern VSIFilesystemHandler sVSIZstdFilesystemHandler;
+
+CPL_C_END
+
+#endif /* ndef CPL_VSI_VIRTUAL_H_INCLUDED */
@@ -0,0 +1,305 @@
+/**********************************************************************
+ * Name:     cpl_vsil.c
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Large file functions of the Virtual System Interface, which
+ *           dispatch the calls to the virtual file systems.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "cpl_vsi_virtual.h"
+#include "cpl_conv.h"
+
+#include <errno.h>
+
+/*---------------------------------------------------------------------
+ * The file systems, looked up by the prefix of the file names.  Those
+ * installed by VSIInstallFileHandler() come after the built-in ones,
+ * and the names that match no prefix go to stdio.
+ *--------------------------------------------------------------------*/
+#define VSI_MAX_FILE_HANDLERS   16
+
+typedef struct
+{
+    const char           *pszPrefix;
+    VSIFilesystemHandler *psFS;
+} VSIFileHandlerEntry;
+
+static VSIFileHandlerEntry asFileHandlers[VSI_MAX_FILE_HANDLERS] =
+{
+    { "/vsimem/", &sVSIMemFilesystemHandler },
+    { "/vsizip/", &sVSIZipFilesystemHandler },
+    { "/vsigzip/", &sVSIGZipFilesystemHandler },
+    { "/vsizstd/", &sVSIZstdFilesystemHandler }
+};
+static int nFileHandlers = 4;
+
+/**********************************************************************
+ *                          VSIInstallFileHandler()
+ *
+ * Install a file system for the file names that start with pszPrefix,
+ * in place of the one that handled them, if any.  The handler must
+ * stay valid until the end of the program.
+ *
+ * The file systems are not protected by a mutex: they must be
+ * installed before the library is used from several threads.
+ **********************************************************************/
+void VSIInstallFileHandler( const char *pszPrefix,
+                            VSIFilesystemHandler *psFS )
+{
+    int i;
+
+    for( i = 0; i < nFileHandlers; i++ )
+    {
+        if( strcmp( asFileHandlers[i].pszPrefix, pszPrefix ) == 0 )
+        {
+            asFileHandlers[i].psFS = psFS;
+            return;
+        }
+    }
+
+    if( nFileHandlers == VSI_MAX_FILE_HANDLERS )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "VSIInstallFileHandler(): Too many file systems, "
+                  "%s cannot be installed.", pszPrefix );
+        return;
+    }
+
+    asFileHandlers[nFileHandlers].pszPrefix = CPLStrdup( pszPrefix );
+    asFileHandlers[nFileHandlers].psFS = psFS;
+    nFileHandlers++;
+}
+
+/**********************************************************************
+ *                          VSIGetFileHandler()
+ *
+ * Return the file system of a file name, the stdio one if its name
+ * matches no prefix.
+ **********************************************************************/
+VSIFilesystemHandler *VSIGetFileHandler( const char *pszPath )
+{
+    int i;
+
+    for( i = 0; i < nFileHandlers; i++ )
+    {
+        if( strncmp( pszPath, asFileHandlers[i].pszPrefix,
+                     strlen( asFileHandlers[i].pszPrefix ) ) == 0 )
+            return asFileHandlers[i].psFS;
+    }
+
+    return &sVSIStdioFilesystemHandler;
+}
+
+/**********************************************************************
+ *                          VSINormalizePath()
+ *
+ * Return a copy of a file name with slashes only, and without empty,
+ * "." and ".." components or a trailing slash after its first nPrefix
+ * characters, which are the root of a file system ("/vsimem" for
+ * instance).  A ".." never goes above that root.  The names built by
+ * the AVC library, like "cover/../info/arc.dir", can then be compared
+ * with those of the files.  It is freed with CPLFree().
+ **********************************************************************/
+char *VSINormalizePath( const char *pszFilename, int nPrefix )
+{
+    char    *pszName = CPLStrdup( pszFilename ), *pszComp;
+    int     i, nLen, nOut;
+
+    for( i = 0; pszName[i] != '\0'; i++ )
+    {
+        if( pszName[i] == '\\' )
+            pszName[i] = '/';
+    }
+
+    for( i = nOut = nPrefix; pszName[i] != '\0'; i += nLen )
+    {
+        if( pszName[i] == '/' )
+        {
+            nLen = 1;
+            continue;
+        }
+
+        pszComp = pszName + i;
+        for( nLen = 0; pszComp[nLen] != '\0' && pszComp[nLen] != '/';
+             nLen++ ) {}
+
+        if( nLen == 1 && pszComp[0] == '.' )
+            continue;
+
+        if( nLen == 2 && pszComp[0] == '.' && pszComp[1] == '.' )
+        {
+            while( nOut > nPrefix && pszName[nOut-1] != '/' )
+                nOut--;
+            if( nOut > nPrefix )
+                nOut--;
+            continue;
+        }
+
+        pszName[nOut++] = '/';
+        memmove( pszName + nOut, pszComp, nLen );
+        nOut += nLen;
+    }
+    pszName[nOut] = '\0';
+
+    return pszName;
+}
+
+
+/**********************************************************************
+ *                          VSIFOpenL()
+ *
+ * Open a file as fopen() does.  Returns NULL, with errno set, on
+ * failure.  Errors are not reported with CPLError().
+ **********************************************************************/
+VSILFILE *VSIFOpenL( const char *pszFilename, const char *pszAccess )
+{
+    VSIFilesystemHandler *psFS = VSIGetFileHandler( pszFilename );
+
+    return psFS->pfnOpen( psFS, pszFilename, pszAccess );
+}
+
+/**********************************************************************
+ *                          VSIFCloseL()
+ **********************************************************************/
+int VSIFCloseL( VSILFILE *fp )
+{
+    return fp->psFS->pfnClose( fp );
+}
+
+/**********************************************************************
+ *                          VSIFSeekL()
+ **********************************************************************/
+int VSIFSeekL( VSILFILE *fp, vsi_l_offset nOffset, int nWhence )
+{
+    return fp->psFS->pfnSeek( fp, nOffset, nWhence );
+}
+
+/**********************************************************************
+ *                          VSIFTellL()
+ **********************************************************************/
+vsi_l_offset VSIFTellL( VSILFILE *fp )
+{
+    return fp->psFS->pfnTell( fp );
+}
+
+/**********************************************************************
+ *                          VSIFReadL()
+ **********************************************************************/
+size_t VSIFReadL( void *pBuffer, size_t nSize, size_t nCount,
+                  VSILFILE *fp )
+{
+    return fp->psFS->pfnRead( pBuffer, nSize, nCount, fp );
+}
+
+/**********************************************************************
+ *                          VSIFWriteL()
+ **********************************************************************/
+size_t VSIFWriteL( const void *pBuffer, size_t nSize, size_t nCount,
+                   VSILFILE *fp )
+{
+    return fp->psFS->pfnWrite( pBuffer, nSize, nCount, fp );
+}
+
+/**********************************************************************
+ *                          VSIFEofL()
+ **********************************************************************/
+int VSIFEofL( VSILFILE *fp )
+{
+    return fp->psFS->pfnEof( fp );
+}
+
+/**********************************************************************
+ *                          VSIFMapL()
+ *
+ * Return the whole file in memory, as VSIFMap() does, or NULL if the
+ * file system cannot do it (the caller then uses VSIFReadL()).  The
+ * memory is released with VSIFUnmapL() before the file is closed.
+ **********************************************************************/
+void *VSIFMapL( VSILFILE *fp, size_t *pnSize )
+{
+    if( fp->psFS->pfnMap == NULL )
+        return NULL;
+
+    return fp->psFS->pfnMap( fp, pnSize );
+}
+
+/**********************************************************************
+ *                          VSIFUnmapL()
+ **********************************************************************/
+void VSIFUnmapL( VSILFILE *fp, void *pData, size_t nSize )
+{
+    if( fp->psFS->pfnUnmap != NULL )
+        fp->psFS->pfnUnmap( fp, pData, nSize );
+}
+
+/**********************************************************************
+ *                          VSIFAdviseSequentialL()
+ *
+ * See VSIFAdviseSequential().
+ **********************************************************************/
+void VSIFAdviseSequentialL( VSILFILE *fp, void *pData, size_t nSize )
+{
+    if( fp->psFS->pfnAdviseSequential != NULL )
+        fp->psFS->pfnAdviseSequential( fp, pData, nSize );
+}
+
+/**********************************************************************
+ *                          VSIStatL()
+ *
+ * Same as stat(), with a 64 bit st_size.
+ **********************************************************************/
+int VSIStatL( const char *pszFilename, VSIStatBufL *psStatBuf )
+{
+    VSIFilesystemHandler *psFS = VSIGetFileHandler( pszFilename );
+
+    return psFS->pfnStat( psFS, pszFilename, psStatBuf );
+}
+
+/**********************************************************************
+ *                          VSIUnlink()
+ **********************************************************************/
+int VSIUnlink( const char *pszFilename )
+{
+    VSIFilesystemHandler *psFS = VSIGetFileHandler( pszFilename );
+
+    if( psFS->pfnUnlink == NULL )
+    {
+        errno = ENOSYS;
+        return -1;
+    }
+
+    return psFS->pfnUnlink( psFS, pszFilename );
+}
+
+/**********************************************************************
+ *                          VSIReadDir()
+ *
+ * Same as CPLReadDir(), for the files of any file system.
+ **********************************************************************/
+char **VSIReadDir( const char *pszPath )
+{
+    VSIFilesystemHandler *psFS = VSIGetFileHandler( pszPath );
+
+    if( psFS->pfnReadDir == NULL )
+        return NULL;
+
+    return psFS->pfnReadDir( psFS, pszPath );
+}
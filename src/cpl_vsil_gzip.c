@@ -0,0 +1,1916 @@
+/**********************************************************************
+ * Name:     cpl_vsil_gzip.c
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Virtual file systems of compressed files: the members of
+ *           ZIP archives (/vsizip/), and gzip (/vsigzip/) and zstd
+ *           (/vsizstd/) files.
+ *
+ **********************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************
+ *
+ * A member is named as /vsizip/archive.zip/dir/name, where archive.zip
+ * is any file name that VSIFOpenL() accepts (/vsizip//abs/path.zip for
+ * an absolute path, /vsizip//vsimem/a.zip for an archive in memory).
+ * The archive is a directory, and so are the directories of its
+ * members, even if they have no entry of their own.
+ *
+ * /vsigzip/file.gz and /vsizstd/file.zst are the contents of a
+ * compressed file.  They are opened either for reading, as one stream
+ * even if the file has several gzip members or zstd frames, or for
+ * writing a new file.  Their size is not known until the end of the
+ * stream is read, so VSIStatL() gives that of the compressed file.
+ * zstd is only available if HAVE_ZSTD is defined (and libzstd linked).
+ *
+ * The files are read in place, without extracting them: the stored
+ * members straight from the archive, the others through zlib or zstd.
+ * Reading backwards means decompressing the stream again from its
+ * start, except for the last VSIGZIP_HISTORY bytes read, which are
+ * kept.  A whole ZIP member is decompressed at once when the raw
+ * binary layer maps it (see VSIFMapL()).
+ *
+ * Unless CPL_NO_THREADS is defined (see cpl_multiproc.h), streams are
+ * decompressed on a separate thread, up to VSIGZIP_NBLOCKS blocks ahead
+ * of the reader, and the data written is compressed on a separate
+ * thread while the next block is filled.
+ *
+ * The central directory of an archive is read once and shared by all
+ * the threads.  It is read again if the size or the time of the
+ * archive change.  Each handle has its own handle of the archive.
+ **********************************************************************/
+
+#include "cpl_vsi_virtual.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_multiproc.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#endif
+
+#ifdef CPL_MULTIPROC_PTHREAD
+#  include <pthread.h>
+#endif
+
+#define VSIZIP_PREFIX       "/vsizip/"
+#define VSIGZIP_PREFIX      "/vsigzip/"
+#define VSIZSTD_PREFIX      "/vsizstd/"
+
+#define VSIGZIP_BUFSIZE     65536   /* Compressed data read at once     */
+#define VSIGZIP_WINDOW      65536   /* Decompressed data kept           */
+#define VSIGZIP_HISTORY     4096    /* Kept for seeks backwards         */
+#define VSIGZIP_BLOCKSIZE   (VSIGZIP_WINDOW - VSIGZIP_HISTORY)
+#define VSIGZIP_NBLOCKS     4       /* Decompressed ahead of the reader */
+#define VSIGZIP_WRITESIZE   (1024*1024) /* Compressed at once          */
+
+/* Compression of a stream */
+#define VSIGZIP_STORED      0
+#define VSIGZIP_DEFLATE     1       /* Raw deflate, in ZIP archives     */
+#define VSIGZIP_GZIP        2
+#define VSIGZIP_ZSTD        3
+
+#define ZIP_LOCAL_HEADER_SIZE   30
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_EOCD_SIZE           22
+#define ZIP_EOCD64_SIZE         56
+#define ZIP_EOCD64_LOCATOR_SIZE 20
+
+/*---------------------------------------------------------------------
+ * Members and directories of an archive.  pszName has no leading or
+ * trailing slash.
+ *--------------------------------------------------------------------*/
+typedef struct
+{
+    char        *pszName;
+    int         bDir;
+    int         nFlags;
+    int         nMethod;        /* 0 stored, 8 deflated                 */
+    GUInt32     nCRC;
+    vsi_l_offset nCompressedSize;
+    vsi_l_offset nUncompressedSize;
+    vsi_l_offset nLocalHeaderOffset;
+} VSIZipEntry;
+
+typedef struct VSIZipArchive_t
+{
+    char        *pszFilename;
+    vsi_l_offset nFileSize;
+    time_t      nMTime;
+    int         nEntries;
+    VSIZipEntry *pasEntries;    /* Sorted by name                       */
+    int         nRefCount;      /* The cache and open handles           */
+    struct VSIZipArchive_t *psNext;
+} VSIZipArchive;
+
+typedef struct VSIGZipReadAhead_t VSIGZipReadAhead;
+typedef struct VSIGZipWriter_t VSIGZipWriter;
+
+/*---------------------------------------------------------------------
+ * A compressed (or stored) stream in a range of another file, read
+ * through a window of decompressed data, or a compressed file being
+ * written (psWriter).
+ *
+ * When the stream is decompressed by another thread, that thread is
+ * the only one that uses the fields from sStream to nOutOffset and
+ * fpBase, until VSIGZipStopReadAhead() is called.
+ *--------------------------------------------------------------------*/
+typedef struct
+{
+    VSILFILE    sBase;
+    char        *pszFilename;   /* For the error messages               */
+    VSILFILE    *fpBase;
+    vsi_l_offset nStart;        /* Of the stream in fpBase              */
+    vsi_l_offset nCompressedSize;
+    vsi_l_offset nUncompressedSize;
+    int         bSizeKnown;     /* Not until the end for gzip and zstd  */
+    int         nCodec;
+    int         bCheckSize;     /* With nUncompressedSize at the end    */
+    int         bCheckCRC;
+    GUInt32     nExpectedCRC;
+
+    z_stream    sStream;
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *psDStream;
+#endif
+    int         bStreamInit;
+    int         bStreamEnd;     /* Or broken                            */
+    const char  *pszError;      /* Why it is broken, not yet reported   */
+    vsi_l_offset nInOffset;     /* Compressed bytes read                */
+    GByte       *pabyIn;
+    size_t      nInSize;        /* Bytes in pabyIn                      */
+    size_t      nInPos;         /* Bytes of pabyIn already used         */
+    uLong       nCRC;           /* Of the bytes decompressed            */
+    vsi_l_offset nOutOffset;    /* Number of bytes decompressed         */
+
+    GByte       *pabyWindow;
+    vsi_l_offset nWindowOffset;
+    size_t      nWindowSize;
+    VSIGZipReadAhead *psReadAhead;
+
+    vsi_l_offset nOffset;
+    int         bEOF;
+
+    VSIGZipWriter *psWriter;
+    VSIZipArchive *psArchive;
+} VSIGZipHandle;
+
+static VSIZipArchive *psZipArchives = NULL;
+static void         *hZipArchivesMutex = NULL;
+
+static void VSIZipRelease( VSIZipArchive *psArchive );
+static void VSIZipUnref( VSIZipArchive *psArchive );
+
+/**********************************************************************
+ *                          VSIGZipInflate()
+ *
+ * Decompress up to nOutSize more bytes of the stream into pabyOut.
+ * Returns the number of bytes decompressed, less than nOutSize only at
+ * the end of the stream, or if it is broken: pszError then says why.
+ *
+ * This may run on the read-ahead thread, so errors are not reported
+ * here, but by VSIGZipReportError().
+ **********************************************************************/
+static size_t VSIGZipInflate( VSIGZipHandle *psHandle, GByte *pabyOut,
+                              size_t nOutSize )
+{
+    size_t      nOut = 0, nRead, nProduced = 0;
+    int         bFrameEnd = FALSE, bEnd = FALSE;
+    const char  *pszError = NULL;
+
+    if( psHandle->bStreamEnd )
+        return 0;
+
+    while( nOut < nOutSize && pszError == NULL )
+    {
+        if( psHandle->nInPos == psHandle->nInSize &&
+            psHandle->nInOffset < psHandle->nCompressedSize )
+        {
+            nRead = VSIFReadL( psHandle->pabyIn, 1,
+                               (size_t) MIN( (vsi_l_offset) VSIGZIP_BUFSIZE,
+                                             psHandle->nCompressedSize -
+                                             psHandle->nInOffset ),
+                               psHandle->fpBase );
+            if( nRead == 0 )
+            {
+                pszError = "truncated";
+                break;
+            }
+
+            psHandle->nInOffset += nRead;
+            psHandle->nInSize = nRead;
+            psHandle->nInPos = 0;
+        }
+
+        if( psHandle->nCodec == VSIGZIP_ZSTD )
+        {
+#ifdef HAVE_ZSTD
+            ZSTD_inBuffer   sIn;
+            ZSTD_outBuffer  sOut;
+            size_t          nRet;
+
+            sIn.src = psHandle->pabyIn;
+            sIn.size = psHandle->nInSize;
+            sIn.pos = psHandle->nInPos;
+            sOut.dst = pabyOut + nOut;
+            sOut.size = nOutSize - nOut;
+            sOut.pos = 0;
+
+            nRet = ZSTD_decompressStream( psHandle->psDStream, &sOut, &sIn );
+
+            psHandle->nInPos = sIn.pos;
+            nProduced = sOut.pos;
+            if( ZSTD_isError( nRet ) )
+                pszError = "corrupt";
+            else if( nRet == 0 )
+                bFrameEnd = TRUE;
+            else if( nProduced == 0 && sIn.pos == sIn.size &&
+                     psHandle->nInOffset >= psHandle->nCompressedSize )
+                pszError = "truncated";
+#endif
+        }
+        else
+        {
+            z_stream    *psStream = &(psHandle->sStream);
+            uInt        nChunk = (uInt) MIN( nOutSize - nOut,
+                                             (size_t) INT_MAX );
+            int         nRet;
+
+            psStream->next_in = psHandle->pabyIn + psHandle->nInPos;
+            psStream->avail_in = (uInt) (psHandle->nInSize -
+                                         psHandle->nInPos);
+            psStream->next_out = pabyOut + nOut;
+            psStream->avail_out = nChunk;
+
+            nRet = inflate( psStream, Z_NO_FLUSH );
+
+            psHandle->nInPos = psHandle->nInSize - psStream->avail_in;
+            nProduced = nChunk - psStream->avail_out;
+            if( nRet == Z_STREAM_END )
+                bFrameEnd = TRUE;
+            else if( nRet == Z_BUF_ERROR && psStream->avail_in == 0 &&
+                     psHandle->nInOffset >= psHandle->nCompressedSize )
+                pszError = "truncated";
+            else if( nRet != Z_OK && nRet != Z_BUF_ERROR )
+                pszError = "corrupt";
+        }
+
+        if( psHandle->bCheckCRC )
+            psHandle->nCRC = crc32( psHandle->nCRC, pabyOut + nOut,
+                                    (uInt) nProduced );
+        nOut += nProduced;
+
+        if( bFrameEnd )
+        {
+            /* gzip members and zstd frames may follow each other */
+            bFrameEnd = FALSE;
+            if( psHandle->nCodec != VSIGZIP_DEFLATE &&
+                (psHandle->nInPos < psHandle->nInSize ||
+                 psHandle->nInOffset < psHandle->nCompressedSize) )
+            {
+                if( psHandle->nCodec == VSIGZIP_GZIP )
+                    inflateReset( &(psHandle->sStream) );
+                continue;
+            }
+
+            bEnd = TRUE;
+            break;
+        }
+    }
+
+    psHandle->nOutOffset += nOut;
+
+    if( bEnd )
+    {
+        psHandle->bStreamEnd = TRUE;
+        if( psHandle->bCheckSize &&
+            psHandle->nOutOffset != psHandle->nUncompressedSize )
+            pszError = "of the wrong size";
+        else if( psHandle->bCheckCRC &&
+                 psHandle->nCRC != psHandle->nExpectedCRC )
+            pszError = "corrupt (bad CRC)";
+    }
+
+    if( pszError != NULL )
+    {
+        psHandle->bStreamEnd = TRUE;
+        psHandle->pszError = pszError;
+    }
+
+    return nOut;
+}
+
+/**********************************************************************
+ *                          VSIGZipReportError()
+ *
+ * Report the error found by VSIGZipInflate(), if any, once.
+ **********************************************************************/
+static void VSIGZipReportError( VSIGZipHandle *psHandle )
+{
+    const char  *pszError = psHandle->pszError;
+
+    if( pszError == NULL )
+        return;
+
+    psHandle->pszError = NULL;
+    CPLError( CE_Failure, CPLE_FileIO, "%s: compressed data %s.",
+              psHandle->pszFilename, pszError );
+}
+
+#ifdef CPL_MULTIPROC_PTHREAD
+
+/*---------------------------------------------------------------------
+ * Blocks decompressed by another thread ahead of the reader, in a ring
+ * guarded by hMutex.
+ *--------------------------------------------------------------------*/
+struct VSIGZipReadAhead_t
+{
+    pthread_t       hThread;
+    pthread_mutex_t hMutex;
+    pthread_cond_t  hCond;
+    VSIGZipHandle   *psHandle;
+    GByte           *apabyBlocks[VSIGZIP_NBLOCKS];
+    size_t          anBlockSizes[VSIGZIP_NBLOCKS];
+    int             iFirst;     /* The next block for the reader        */
+    int             nBlocks;    /* Decompressed and not yet read        */
+    int             bDone;      /* End of the stream, or broken         */
+    int             bStop;
+};
+
+/**********************************************************************
+ *                          VSIGZipReadAheadThread()
+ **********************************************************************/
+static void *VSIGZipReadAheadThread( void *pArg )
+{
+    VSIGZipReadAhead *psRA = (VSIGZipReadAhead *) pArg;
+    int         iBlock;
+    size_t      nOut;
+
+    CPLSetWorkerThread();
+
+    pthread_mutex_lock( &psRA->hMutex );
+    while( !psRA->bStop )
+    {
+        if( psRA->nBlocks == VSIGZIP_NBLOCKS )
+        {
+            pthread_cond_wait( &psRA->hCond, &psRA->hMutex );
+            continue;
+        }
+
+        iBlock = (psRA->iFirst + psRA->nBlocks) % VSIGZIP_NBLOCKS;
+        pthread_mutex_unlock( &psRA->hMutex );
+
+        nOut = VSIGZipInflate( psRA->psHandle, psRA->apabyBlocks[iBlock],
+                               VSIGZIP_BLOCKSIZE );
+
+        pthread_mutex_lock( &psRA->hMutex );
+        if( nOut > 0 )
+        {
+            psRA->anBlockSizes[iBlock] = nOut;
+            psRA->nBlocks++;
+        }
+        if( nOut < VSIGZIP_BLOCKSIZE )
+            psRA->bDone = TRUE;
+        pthread_cond_broadcast( &psRA->hCond );
+        if( psRA->bDone )
+            break;
+    }
+    pthread_mutex_unlock( &psRA->hMutex );
+
+    return NULL;
+}
+
+/**********************************************************************
+ *                          VSIGZipStartReadAhead()
+ *
+ * Start decompressing the stream from where it is on another thread.
+ * Nothing is done if the thread cannot be started.
+ **********************************************************************/
+static void VSIGZipStartReadAhead( VSIGZipHandle *psHandle )
+{
+    VSIGZipReadAhead *psRA;
+    int         i;
+
+    psRA = (VSIGZipReadAhead *) CPLCalloc( 1, sizeof(VSIGZipReadAhead) );
+    psRA->psHandle = psHandle;
+    for( i = 0; i < VSIGZIP_NBLOCKS; i++ )
+        psRA->apabyBlocks[i] = (GByte *) CPLMalloc( VSIGZIP_BLOCKSIZE );
+    pthread_mutex_init( &psRA->hMutex, NULL );
+    pthread_cond_init( &psRA->hCond, NULL );
+
+    if( pthread_create( &psRA->hThread, NULL, VSIGZipReadAheadThread,
+                        psRA ) != 0 )
+    {
+        pthread_mutex_destroy( &psRA->hMutex );
+        pthread_cond_destroy( &psRA->hCond );
+        for( i = 0; i < VSIGZIP_NBLOCKS; i++ )
+            CPLFree( psRA->apabyBlocks[i] );
+        CPLFree( psRA );
+        return;
+    }
+
+    psHandle->psReadAhead = psRA;
+}
+
+/**********************************************************************
+ *                          VSIGZipNextBlock()
+ *
+ * Copy the next block decompressed by the thread to pabyOut (which
+ * has room for VSIGZIP_BLOCKSIZE bytes).  Returns its size, 0 at the
+ * end of the stream.
+ **********************************************************************/
+static size_t VSIGZipNextBlock( VSIGZipReadAhead *psRA, GByte *pabyOut )
+{
+    size_t      nOut = 0;
+
+    int         nBlocks;
+
+    pthread_mutex_lock( &psRA->hMutex );
+    while( psRA->nBlocks == 0 && !psRA->bDone )
+        pthread_cond_wait( &psRA->hCond, &psRA->hMutex );
+    nBlocks = psRA->nBlocks;
+    pthread_mutex_unlock( &psRA->hMutex );
+
+    /* The thread does not touch the blocks that are ready */
+    if( nBlocks > 0 )
+    {
+        nOut = psRA->anBlockSizes[psRA->iFirst];
+        memcpy( pabyOut, psRA->apabyBlocks[psRA->iFirst], nOut );
+
+        pthread_mutex_lock( &psRA->hMutex );
+        psRA->iFirst = (psRA->iFirst + 1) % VSIGZIP_NBLOCKS;
+        psRA->nBlocks--;
+        pthread_cond_broadcast( &psRA->hCond );
+        pthread_mutex_unlock( &psRA->hMutex );
+    }
+
+    return nOut;
+}
+
+#endif /* def CPL_MULTIPROC_PTHREAD */
+
+/**********************************************************************
+ *                          VSIGZipStopReadAhead()
+ *
+ * Stop the thread that decompresses the stream, if any.  The blocks
+ * that it decompressed are lost: the stream is rewound afterwards.
+ **********************************************************************/
+static void VSIGZipStopReadAhead( VSIGZipHandle *psHandle )
+{
+#ifdef CPL_MULTIPROC_PTHREAD
+    VSIGZipReadAhead *psRA = psHandle->psReadAhead;
+    int         i;
+
+    if( psRA == NULL )
+        return;
+
+    pthread_mutex_lock( &psRA->hMutex );
+    psRA->bStop = TRUE;
+    pthread_cond_broadcast( &psRA->hCond );
+    pthread_mutex_unlock( &psRA->hMutex );
+
+    pthread_join( psRA->hThread, NULL );
+    pthread_mutex_destroy( &psRA->hMutex );
+    pthread_cond_destroy( &psRA->hCond );
+
+    for( i = 0; i < VSIGZIP_NBLOCKS; i++ )
+        CPLFree( psRA->apabyBlocks[i] );
+    CPLFree( psRA );
+
+    psHandle->psReadAhead = NULL;
+#endif
+}
+
+/**********************************************************************
+ *                          VSIGZipRewind()
+ *
+ * Go back to the start of the stream, which is decompressed again.
+ **********************************************************************/
+static void VSIGZipRewind( VSIGZipHandle *psHandle )
+{
+    VSIGZipStopReadAhead( psHandle );
+
+#ifdef HAVE_ZSTD
+    if( psHandle->nCodec == VSIGZIP_ZSTD )
+        ZSTD_initDStream( psHandle->psDStream );
+    else
+#endif
+        inflateReset( &(psHandle->sStream) );
+
+    psHandle->nInSize = psHandle->nInPos = 0;
+    psHandle->bStreamEnd = FALSE;
+    psHandle->pszError = NULL;
+    psHandle->nInOffset = 0;
+    psHandle->nOutOffset = 0;
+    psHandle->nCRC = crc32( 0L, Z_NULL, 0 );
+    psHandle->nWindowOffset = 0;
+    psHandle->nWindowSize = 0;
+
+    VSIFSeekL( psHandle->fpBase, psHandle->nStart, SEEK_SET );
+}
+
+/**********************************************************************
+ *                          VSIGZipFillWindow()
+ *
+ * Decompress the next part of the stream into the window, keeping the
+ * last VSIGZIP_HISTORY bytes of it.  Returns FALSE if nothing more
+ * could be decompressed: the size of the stream is then known.
+ **********************************************************************/
+static int VSIGZipFillWindow( VSIGZipHandle *psHandle )
+{
+    size_t      nDrop, nOut;
+
+    if( psHandle->nWindowSize > VSIGZIP_HISTORY )
+    {
+        nDrop = psHandle->nWindowSize - VSIGZIP_HISTORY;
+        memmove( psHandle->pabyWindow, psHandle->pabyWindow + nDrop,
+                 VSIGZIP_HISTORY );
+        psHandle->nWindowOffset += nDrop;
+        psHandle->nWindowSize = VSIGZIP_HISTORY;
+    }
+
+#ifdef CPL_MULTIPROC_PTHREAD
+    if( psHandle->psReadAhead == NULL && !psHandle->bStreamEnd )
+        VSIGZipStartReadAhead( psHandle );
+
+    if( psHandle->psReadAhead != NULL )
+        nOut = VSIGZipNextBlock( psHandle->psReadAhead,
+                                 psHandle->pabyWindow +
+                                 psHandle->nWindowSize );
+    else
+#endif
+        nOut = VSIGZipInflate( psHandle,
+                               psHandle->pabyWindow + psHandle->nWindowSize,
+                               VSIGZIP_BLOCKSIZE );
+    psHandle->nWindowSize += nOut;
+
+    if( nOut > 0 )
+        return TRUE;
+
+    if( !psHandle->bSizeKnown && psHandle->pszError == NULL )
+    {
+        psHandle->nUncompressedSize = psHandle->nWindowOffset +
+                                      psHandle->nWindowSize;
+        psHandle->bSizeKnown = TRUE;
+    }
+    VSIGZipReportError( psHandle );
+
+    return FALSE;
+}
+
+/**********************************************************************
+ *                          VSIGZipNewHandle()
+ *
+ * Make a handle for reading the stream of nCompressedSize bytes at
+ * nStart in fpBase, which now belongs to the handle.  Its size is not
+ * known.  Returns NULL, with fpBase closed, if the decompressor cannot
+ * be initialized.
+ **********************************************************************/
+static VSIGZipHandle *VSIGZipNewHandle( VSIFilesystemHandler *psFS,
+                                        const char *pszFilename,
+                                        VSILFILE *fpBase,
+                                        vsi_l_offset nStart,
+                                        vsi_l_offset nCompressedSize,
+                                        int nCodec )
+{
+    VSIGZipHandle *psHandle;
+    int         bInit = TRUE;
+
+    psHandle = (VSIGZipHandle *) CPLCalloc( 1, sizeof(VSIGZipHandle) );
+    psHandle->sBase.psFS = psFS;
+    psHandle->fpBase = fpBase;
+    psHandle->nStart = nStart;
+    psHandle->nCompressedSize = nCompressedSize;
+    psHandle->nCodec = nCodec;
+
+#ifdef HAVE_ZSTD
+    if( nCodec == VSIGZIP_ZSTD )
+        bInit = (psHandle->psDStream = ZSTD_createDStream()) != NULL;
+    else
+#endif
+    if( nCodec != VSIGZIP_STORED )
+        bInit = inflateInit2( &(psHandle->sStream),
+                              nCodec == VSIGZIP_GZIP ? 16 + MAX_WBITS
+                                                     : -MAX_WBITS ) == Z_OK;
+
+    if( !bInit )
+    {
+        VSIFCloseL( fpBase );
+        CPLFree( psHandle );
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if( nCodec != VSIGZIP_STORED )
+    {
+        psHandle->bStreamInit = TRUE;
+        psHandle->pabyIn = (GByte *) CPLMalloc( VSIGZIP_BUFSIZE );
+        psHandle->pabyWindow = (GByte *) CPLMalloc( VSIGZIP_WINDOW );
+        VSIGZipRewind( psHandle );
+    }
+
+    psHandle->pszFilename = CPLStrdup( pszFilename );
+
+    return psHandle;
+}
+
+/*---------------------------------------------------------------------
+ * The state of a file being compressed.  With a thread, the block
+ * being filled is pabyBlock, the one being compressed pabyPending and
+ * the free one pabySpare, and the thread is the only one that uses
+ * sStream, psCStream, pabyOut and the fpBase of the handle.
+ *--------------------------------------------------------------------*/
+struct VSIGZipWriter_t
+{
+    z_stream    sStream;
+#ifdef HAVE_ZSTD
+    ZSTD_CStream *psCStream;
+#endif
+    GByte       *pabyBlock;
+    size_t      nBlockSize;
+    GByte       *pabyOut;
+    int         bError;
+#ifdef CPL_MULTIPROC_PTHREAD
+    int         bThread;
+    pthread_t   hThread;
+    pthread_mutex_t hMutex;
+    pthread_cond_t hCond;
+    GByte       *pabyPending;
+    size_t      nPendingSize;
+    int         bFinish;        /* pabyPending is the last block        */
+    GByte       *pabySpare;
+#endif
+};
+
+/**********************************************************************
+ *                          VSIGZipDeflate()
+ *
+ * Compress nSize bytes, and the end of the stream if bFinish is TRUE,
+ * to the file.  Returns FALSE if it could not be written.
+ **********************************************************************/
+static int VSIGZipDeflate( VSIGZipHandle *psHandle, const GByte *pabyData,
+                           size_t nSize, int bFinish )
+{
+    VSIGZipWriter *psWriter = psHandle->psWriter;
+    size_t      nOut;
+
+#ifdef HAVE_ZSTD
+    if( psHandle->nCodec == VSIGZIP_ZSTD )
+    {
+        ZSTD_inBuffer   sIn;
+        ZSTD_outBuffer  sOut;
+        size_t          nRet;
+
+        sIn.src = pabyData;
+        sIn.size = nSize;
+        sIn.pos = 0;
+        do
+        {
+            sOut.dst = psWriter->pabyOut;
+            sOut.size = VSIGZIP_BUFSIZE;
+            sOut.pos = 0;
+            nRet = ZSTD_compressStream2( psWriter->psCStream, &sOut, &sIn,
+                                         bFinish ? ZSTD_e_end
+                                                 : ZSTD_e_continue );
+            if( ZSTD_isError( nRet ) ||
+                VSIFWriteL( psWriter->pabyOut, 1, sOut.pos,
+                            psHandle->fpBase ) != sOut.pos )
+                return FALSE;
+        } while( bFinish ? nRet != 0 : sIn.pos < sIn.size );
+
+        return TRUE;
+    }
+#endif
+
+    {
+        z_stream    *psStream = &(psWriter->sStream);
+        int         nRet;
+
+        psStream->next_in = (Bytef *) pabyData;
+        psStream->avail_in = (uInt) nSize;
+        do
+        {
+            psStream->next_out = psWriter->pabyOut;
+            psStream->avail_out = VSIGZIP_BUFSIZE;
+            nRet = deflate( psStream, bFinish ? Z_FINISH : Z_NO_FLUSH );
+            nOut = VSIGZIP_BUFSIZE - psStream->avail_out;
+            if( nRet == Z_STREAM_ERROR ||
+                VSIFWriteL( psWriter->pabyOut, 1, nOut,
+                            psHandle->fpBase ) != nOut )
+                return FALSE;
+        } while( bFinish ? nRet != Z_STREAM_END
+                         : psStream->avail_out == 0 );
+    }
+
+    return TRUE;
+}
+
+#ifdef CPL_MULTIPROC_PTHREAD
+
+/**********************************************************************
+ *                          VSIGZipWriterThread()
+ **********************************************************************/
+static void *VSIGZipWriterThread( void *pArg )
+{
+    VSIGZipHandle *psHandle = (VSIGZipHandle *) pArg;
+    VSIGZipWriter *psWriter = psHandle->psWriter;
+    int         bOK, bFinish = FALSE;
+
+    CPLSetWorkerThread();
+
+    pthread_mutex_lock( &psWriter->hMutex );
+    while( !bFinish )
+    {
+        if( psWriter->pabyPending == NULL )
+        {
+            pthread_cond_wait( &psWriter->hCond, &psWriter->hMutex );
+            continue;
+        }
+
+        bFinish = psWriter->bFinish;
+        pthread_mutex_unlock( &psWriter->hMutex );
+
+        bOK = VSIGZipDeflate( psHandle, psWriter->pabyPending,
+                              psWriter->nPendingSize, bFinish );
+
+        pthread_mutex_lock( &psWriter->hMutex );
+        if( !bOK )
+            psWriter->bError = TRUE;
+        psWriter->pabySpare = psWriter->pabyPending;
+        psWriter->pabyPending = NULL;
+        pthread_cond_broadcast( &psWriter->hCond );
+    }
+    pthread_mutex_unlock( &psWriter->hMutex );
+
+    return NULL;
+}
+
+#endif /* def CPL_MULTIPROC_PTHREAD */
+
+/**********************************************************************
+ *                          VSIGZipFlushBlock()
+ *
+ * Compress the block filled by VSIGZipWrite(), and finish the stream
+ * if bFinish is TRUE.  With a thread, the block is compressed while
+ * the next one is filled, unless bFinish is TRUE: the stream is then
+ * written when this returns.  Returns FALSE if something could not be
+ * written.
+ **********************************************************************/
+static int VSIGZipFlushBlock( VSIGZipHandle *psHandle, int bFinish )
+{
+    VSIGZipWriter *psWriter = psHandle->psWriter;
+    int         bOK;
+
+#ifdef CPL_MULTIPROC_PTHREAD
+    if( psWriter->bThread )
+    {
+        pthread_mutex_lock( &psWriter->hMutex );
+        while( psWriter->pabyPending != NULL )
+            pthread_cond_wait( &psWriter->hCond, &psWriter->hMutex );
+
+        psWriter->pabyPending = psWriter->pabyBlock;
+        psWriter->nPendingSize = psWriter->nBlockSize;
+        psWriter->bFinish = bFinish;
+        psWriter->pabyBlock = psWriter->pabySpare;
+        psWriter->pabySpare = NULL;
+        psWriter->nBlockSize = 0;
+        pthread_cond_broadcast( &psWriter->hCond );
+
+        while( bFinish && psWriter->pabyPending != NULL )
+            pthread_cond_wait( &psWriter->hCond, &psWriter->hMutex );
+
+        bOK = !psWriter->bError;
+        pthread_mutex_unlock( &psWriter->hMutex );
+
+        return bOK;
+    }
+#endif
+
+    bOK = !psWriter->bError &&
+          VSIGZipDeflate( psHandle, psWriter->pabyBlock,
+                          psWriter->nBlockSize, bFinish );
+    psWriter->nBlockSize = 0;
+    if( !bOK )
+        psWriter->bError = TRUE;
+
+    return bOK;
+}
+
+/**********************************************************************
+ *                          VSIGZipNewWriter()
+ *
+ * Make a handle that compresses what is written to fpBase, which now
+ * belongs to the handle.  Returns NULL, with fpBase closed, if the
+ * compressor cannot be initialized.
+ **********************************************************************/
+static VSIGZipHandle *VSIGZipNewWriter( VSIFilesystemHandler *psFS,
+                                        const char *pszFilename,
+                                        VSILFILE *fpBase, int nCodec )
+{
+    VSIGZipHandle *psHandle;
+    VSIGZipWriter *psWriter;
+    int         bInit;
+
+    psWriter = (VSIGZipWriter *) CPLCalloc( 1, sizeof(VSIGZipWriter) );
+
+#ifdef HAVE_ZSTD
+    if( nCodec == VSIGZIP_ZSTD )
+        bInit = (psWriter->psCStream = ZSTD_createCStream()) != NULL &&
+                !ZSTD_isError( ZSTD_initCStream( psWriter->psCStream,
+                                                 ZSTD_CLEVEL_DEFAULT ) );
+    else
+#endif
+        bInit = deflateInit2( &(psWriter->sStream), Z_DEFAULT_COMPRESSION,
+                              Z_DEFLATED, 16 + MAX_WBITS, 8,
+                              Z_DEFAULT_STRATEGY ) == Z_OK;
+
+    if( !bInit )
+    {
+#ifdef HAVE_ZSTD
+        ZSTD_freeCStream( psWriter->psCStream );
+#endif
+        VSIFCloseL( fpBase );
+        CPLFree( psWriter );
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    psWriter->pabyBlock = (GByte *) CPLMalloc( VSIGZIP_WRITESIZE );
+    psWriter->pabyOut = (GByte *) CPLMalloc( VSIGZIP_BUFSIZE );
+
+    psHandle = (VSIGZipHandle *) CPLCalloc( 1, sizeof(VSIGZipHandle) );
+    psHandle->sBase.psFS = psFS;
+    psHandle->pszFilename = CPLStrdup( pszFilename );
+    psHandle->fpBase = fpBase;
+    psHandle->nCodec = nCodec;
+    psHandle->psWriter = psWriter;
+
+#ifdef CPL_MULTIPROC_PTHREAD
+    psWriter->pabySpare = (GByte *) CPLMalloc( VSIGZIP_WRITESIZE );
+    pthread_mutex_init( &psWriter->hMutex, NULL );
+    pthread_cond_init( &psWriter->hCond, NULL );
+    psWriter->bThread = pthread_create( &psWriter->hThread, NULL,
+                                        VSIGZipWriterThread,
+                                        psHandle ) == 0;
+#endif
+
+    return psHandle;
+}
+
+/**********************************************************************
+ *                          VSIGZipCloseWriter()
+ *
+ * Finish the stream.  Returns FALSE if it could not be written.
+ **********************************************************************/
+static int VSIGZipCloseWriter( VSIGZipHandle *psHandle )
+{
+    VSIGZipWriter *psWriter = psHandle->psWriter;
+    int         bOK = VSIGZipFlushBlock( psHandle, TRUE );
+
+#ifdef CPL_MULTIPROC_PTHREAD
+    if( psWriter->bThread )
+        pthread_join( psWriter->hThread, NULL );
+    pthread_mutex_destroy( &psWriter->hMutex );
+    pthread_cond_destroy( &psWriter->hCond );
+    CPLFree( psWriter->pabySpare );
+#endif
+
+#ifdef HAVE_ZSTD
+    if( psHandle->nCodec == VSIGZIP_ZSTD )
+        ZSTD_freeCStream( psWriter->psCStream );
+    else
+#endif
+        deflateEnd( &(psWriter->sStream) );
+
+    CPLFree( psWriter->pabyBlock );
+    CPLFree( psWriter->pabyOut );
+    CPLFree( psWriter );
+    psHandle->psWriter = NULL;
+
+    return bOK;
+}
+
+/**********************************************************************
+ *                          VSIGZipClose()
+ **********************************************************************/
+static int VSIGZipClose( VSILFILE *fp )
+{
+    VSIGZipHandle *psHandle = (VSIGZipHandle *) fp;
+    int         bOK = TRUE;
+
+    if( psHandle->psWriter != NULL )
+        bOK = VSIGZipCloseWriter( psHandle );
+
+    VSIGZipStopReadAhead( psHandle );
+
+    if( psHandle->bStreamInit )
+    {
+#ifdef HAVE_ZSTD
+        if( psHandle->nCodec == VSIGZIP_ZSTD )
+            ZSTD_freeDStream( psHandle->psDStream );
+        else
+#endif
+            inflateEnd( &(psHandle->sStream) );
+    }
+
+    if( VSIFCloseL( psHandle->fpBase ) != 0 )
+        bOK = FALSE;
+
+    if( psHandle->psArchive != NULL )
+        VSIZipUnref( psHandle->psArchive );
+
+    if( !bOK )
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "%s: the compressed data could not be written.",
+                  psHandle->pszFilename );
+
+    CPLFree( psHandle->pabyIn );
+    CPLFree( psHandle->pabyWindow );
+    CPLFree( psHandle->pszFilename );
+    CPLFree( psHandle );
+
+    return bOK ? 0 : -1;
+}
+
+/**********************************************************************
+ *                          VSIGZipSeek()
+ *
+ * Only the position changes: the data is decompressed when it is read.
+ * A file being written cannot be seeked.
+ **********************************************************************/
+static int VSIGZipSeek( VSILFILE *fp, vsi_l_offset nOffset, int nWhence )
+{
+    VSIGZipHandle *psHandle = (VSIGZipHandle *) fp;
+
+    if( nWhence == SEEK_END && !psHandle->bSizeKnown &&
+        psHandle->psWriter == NULL )
+    {
+        /* Read the stream up to its end to know its size */
+        while( VSIGZipFillWindow( psHandle ) ) {}
+    }
+
+    if( nWhence == SEEK_CUR )
+        nOffset += psHandle->nOffset;
+    else if( nWhence == SEEK_END )
+        nOffset += psHandle->nUncompressedSize;
+
+    if( psHandle->psWriter != NULL && nOffset != psHandle->nOffset )
+    {
+        errno = ESPIPE;
+        return -1;
+    }
+
+    psHandle->nOffset = nOffset;
+    psHandle->bEOF = FALSE;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          VSIGZipTell()
+ **********************************************************************/
+static vsi_l_offset VSIGZipTell( VSILFILE *fp )
+{
+    return ((VSIGZipHandle *) fp)->nOffset;
+}
+
+/**********************************************************************
+ *                          VSIGZipRead()
+ **********************************************************************/
+static size_t VSIGZipRead( void *pBuffer, size_t nSize, size_t nCount,
+                           VSILFILE *fp )
+{
+    VSIGZipHandle *psHandle = (VSIGZipHandle *) fp;
+    GByte       *pabyBuffer = (GByte *) pBuffer;
+    size_t      nBytes = nSize * nCount, nDone = 0, nCopy;
+    vsi_l_offset nWindowEnd;
+
+    if( psHandle->psWriter != NULL )
+    {
+        errno = EBADF;
+        return 0;
+    }
+
+    if( nBytes == 0 )
+        return 0;
+
+    if( psHandle->bSizeKnown &&
+        psHandle->nOffset >= psHandle->nUncompressedSize )
+    {
+        psHandle->bEOF = TRUE;
+        return 0;
+    }
+
+    if( psHandle->bSizeKnown &&
+        nBytes > psHandle->nUncompressedSize - psHandle->nOffset )
+        nBytes = (size_t) (psHandle->nUncompressedSize - psHandle->nOffset);
+
+    if( psHandle->nCodec == VSIGZIP_STORED )
+    {
+        if( VSIFSeekL( psHandle->fpBase,
+                       psHandle->nStart + psHandle->nOffset,
+                       SEEK_SET ) == 0 )
+            nDone = VSIFReadL( pabyBuffer, 1, nBytes, psHandle->fpBase );
+        psHandle->nOffset += nDone;
+    }
+
+    while( psHandle->nCodec != VSIGZIP_STORED && nDone < nBytes )
+    {
+        if( psHandle->nOffset < psHandle->nWindowOffset )
+            VSIGZipRewind( psHandle );
+
+        nWindowEnd = psHandle->nWindowOffset + psHandle->nWindowSize;
+        if( psHandle->nOffset < nWindowEnd )
+        {
+            nCopy = (size_t) MIN( (vsi_l_offset) (nBytes - nDone),
+                                  nWindowEnd - psHandle->nOffset );
+            memcpy( pabyBuffer + nDone, psHandle->pabyWindow +
+                    (psHandle->nOffset - psHandle->nWindowOffset), nCopy );
+            nDone += nCopy;
+            psHandle->nOffset += nCopy;
+        }
+        else if( !VSIGZipFillWindow( psHandle ) )
+            break;
+    }
+
+    if( nDone < nSize * nCount )
+        psHandle->bEOF = TRUE;
+
+    return nDone / nSize;
+}
+
+/**********************************************************************
+ *                          VSIGZipWrite()
+ *
+ * The data is compressed by blocks of VSIGZIP_WRITESIZE bytes.
+ **********************************************************************/
+static size_t VSIGZipWrite( const void *pBuffer, size_t nSize,
+                            size_t nCount, VSILFILE *fp )
+{
+    VSIGZipHandle *psHandle = (VSIGZipHandle *) fp;
+    VSIGZipWriter *psWriter = psHandle->psWriter;
+    const GByte *pabyBuffer = (const GByte *) pBuffer;
+    size_t      nBytes = nSize * nCount, nDone = 0, nCopy;
+
+    if( psWriter == NULL )
+    {
+        errno = EBADF;
+        return 0;
+    }
+
+    while( nDone < nBytes )
+    {
+        nCopy = MIN( nBytes - nDone,
+                     (size_t) VSIGZIP_WRITESIZE - psWriter->nBlockSize );
+        memcpy( psWriter->pabyBlock + psWriter->nBlockSize,
+                pabyBuffer + nDone, nCopy );
+        psWriter->nBlockSize += nCopy;
+        nDone += nCopy;
+
+        if( psWriter->nBlockSize == VSIGZIP_WRITESIZE &&
+            !VSIGZipFlushBlock( psHandle, FALSE ) )
+        {
+            errno = EIO;
+            break;
+        }
+    }
+
+    psHandle->nOffset += nDone;
+
+    return nDone / nSize;
+}
+
+/**********************************************************************
+ *                          VSIGZipEof()
+ **********************************************************************/
+static int VSIGZipEof( VSILFILE *fp )
+{
+    return ((VSIGZipHandle *) fp)->bEOF;
+}
+
+/**********************************************************************
+ *                          VSIGZipMap()
+ *
+ * The whole stream decompressed in a new buffer, with the limits of
+ * VSIFMap().  Only for the streams whose size is known.
+ **********************************************************************/
+static void *VSIGZipMap( VSILFILE *fp, size_t *pnSize )
+{
+    VSIGZipHandle *psHandle = (VSIGZipHandle *) fp;
+    GByte       *pabyData;
+    size_t      nSize, nDone = 0;
+
+    if( psHandle->psWriter != NULL || !psHandle->bSizeKnown ||
+        psHandle->nUncompressedSize == 0 ||
+        psHandle->nUncompressedSize > INT_MAX )
+        return NULL;
+
+    nSize = (size_t) psHandle->nUncompressedSize;
+    if( (pabyData = (GByte *) VSIMalloc( nSize )) == NULL )
+        return NULL;
+
+    if( psHandle->nCodec == VSIGZIP_STORED )
+    {
+        if( VSIFSeekL( psHandle->fpBase, psHandle->nStart, SEEK_SET ) == 0 )
+            nDone = VSIFReadL( pabyData, 1, nSize, psHandle->fpBase );
+    }
+    else
+    {
+        GByte   abyExtra[1];
+
+        /* Up to the end of the stream, to check its size and CRC */
+        VSIGZipRewind( psHandle );
+        nDone = VSIGZipInflate( psHandle, pabyData, nSize );
+        if( nDone == nSize && !psHandle->bStreamEnd &&
+            VSIGZipInflate( psHandle, abyExtra, 1 ) != 0 )
+            psHandle->pszError = "of the wrong size";
+        if( psHandle->pszError != NULL )
+            nDone = 0;
+
+        VSIGZipReportError( psHandle );
+        VSIGZipRewind( psHandle );
+    }
+
+    if( nDone != nSize )
+    {
+        VSIFree( pabyData );
+        return NULL;
+    }
+
+    *pnSize = nSize;
+
+    return pabyData;
+}
+
+/**********************************************************************
+ *                          VSIGZipUnmap()
+ **********************************************************************/
+static void VSIGZipUnmap( VSILFILE *fp, void *pData, size_t nSize )
+{
+    VSIFree( pData );
+}
+
+/*=====================================================================
+                             ZIP archives
+ *====================================================================*/
+
+#define ZIP_GET16(p)    ((p)[0] | ((p)[1] << 8))
+#define ZIP_GET32(p)    ((GUInt32) ZIP_GET16(p) | \
+                         ((GUInt32) ZIP_GET16((p)+2) << 16))
+#define ZIP_GET64(p)    ((vsi_l_offset) ZIP_GET32(p) | \
+                         ((vsi_l_offset) ZIP_GET32((p)+4) << 32))
+
+/**********************************************************************
+ *                          VSIZipCompareNames()
+ **********************************************************************/
+static int VSIZipCompareNames( const void *p1, const void *p2 )
+{
+    return strcmp( ((const VSIZipEntry *) p1)->pszName,
+                   ((const VSIZipEntry *) p2)->pszName );
+}
+
+/**********************************************************************
+ *                          VSIZipCompareEntries()
+ *
+ * By name, and the entries of the archive before the directories added
+ * by VSIZipAddDirs() with the same name.
+ **********************************************************************/
+static int VSIZipCompareEntries( const void *p1, const void *p2 )
+{
+    const VSIZipEntry *psEntry1 = (const VSIZipEntry *) p1;
+    const VSIZipEntry *psEntry2 = (const VSIZipEntry *) p2;
+    int nCmp = VSIZipCompareNames( p1, p2 );
+
+    if( nCmp == 0 )
+        nCmp = (psEntry1->nMethod > psEntry2->nMethod) -
+               (psEntry1->nMethod < psEntry2->nMethod);
+
+    return nCmp;
+}
+
+/**********************************************************************
+ *                          VSIZipAddDirs()
+ *
+ * Add the directories of the members that have no entry, sort the
+ * entries and remove those that are repeated.
+ **********************************************************************/
+static void VSIZipAddDirs( VSIZipArchive *psArchive )
+{
+    int         i, nOut, nEntries = psArchive->nEntries;
+    char        *pszSlash;
+    VSIZipEntry *psEntry;
+
+    for( i = 0; i < nEntries; i++ )
+    {
+        pszSlash = psArchive->pasEntries[i].pszName;
+        while( (pszSlash = strchr( pszSlash, '/' )) != NULL )
+        {
+            psArchive->pasEntries = (VSIZipEntry *)
+                CPLRealloc( psArchive->pasEntries,
+                            (psArchive->nEntries+1) * sizeof(VSIZipEntry) );
+            psEntry = psArchive->pasEntries + psArchive->nEntries++;
+            memset( psEntry, 0, sizeof(VSIZipEntry) );
+            psEntry->bDir = TRUE;
+            psEntry->nMethod = INT_MAX;
+            psEntry->pszName = CPLStrdup( psArchive->pasEntries[i].pszName );
+            psEntry->pszName[pszSlash - psArchive->pasEntries[i].pszName]
+                = '\0';
+            pszSlash++;
+        }
+    }
+
+    qsort( psArchive->pasEntries, psArchive->nEntries, sizeof(VSIZipEntry),
+           VSIZipCompareEntries );
+
+    for( i = nOut = 0; i < psArchive->nEntries; i++ )
+    {
+        if( nOut > 0 && strcmp( psArchive->pasEntries[i].pszName,
+                        psArchive->pasEntries[nOut-1].pszName ) == 0 )
+        {
+            CPLFree( psArchive->pasEntries[i].pszName );
+            continue;
+        }
+        psArchive->pasEntries[nOut++] = psArchive->pasEntries[i];
+    }
+    psArchive->nEntries = nOut;
+}
+
+/**********************************************************************
+ *                          VSIZipParseDirectory()
+ *
+ * Read the entries of the central directory of an archive.  Returns
+ * FALSE if it is not valid.
+ **********************************************************************/
+static int VSIZipParseDirectory( VSIZipArchive *psArchive,
+                                 const GByte *pabyDir, size_t nDirSize )
+{
+    size_t      nPos = 0;
+    int         i, nNameLen, nExtraLen, nCommentLen, nFieldLen;
+    const GByte *pabyExtra, *pabyField;
+    VSIZipEntry *psEntry;
+
+    while( nPos + ZIP_CENTRAL_HEADER_SIZE <= nDirSize &&
+           memcmp( pabyDir + nPos, "PK\001\002", 4 ) == 0 )
+    {
+        const GByte *pabyHeader = pabyDir + nPos;
+
+        nNameLen = ZIP_GET16( pabyHeader + 28 );
+        nExtraLen = ZIP_GET16( pabyHeader + 30 );
+        nCommentLen = ZIP_GET16( pabyHeader + 32 );
+        if( nPos + ZIP_CENTRAL_HEADER_SIZE + nNameLen + nExtraLen +
+            nCommentLen > nDirSize )
+            return FALSE;
+
+        psArchive->pasEntries = (VSIZipEntry *)
+            CPLRealloc( psArchive->pasEntries,
+                        (psArchive->nEntries+1) * sizeof(VSIZipEntry) );
+        psEntry = psArchive->pasEntries + psArchive->nEntries++;
+        memset( psEntry, 0, sizeof(VSIZipEntry) );
+
+        psEntry->nFlags = ZIP_GET16( pabyHeader + 8 );
+        psEntry->nMethod = ZIP_GET16( pabyHeader + 10 );
+        psEntry->nCRC = ZIP_GET32( pabyHeader + 16 );
+        psEntry->nCompressedSize = ZIP_GET32( pabyHeader + 20 );
+        psEntry->nUncompressedSize = ZIP_GET32( pabyHeader + 24 );
+        psEntry->nLocalHeaderOffset = ZIP_GET32( pabyHeader + 42 );
+
+        /* The sizes and offsets that do not fit, in the ZIP64 extra field */
+        pabyExtra = pabyHeader + ZIP_CENTRAL_HEADER_SIZE + nNameLen;
+        for( i = 0; i + 4 <= nExtraLen; i += 4 + nFieldLen )
+        {
+            nFieldLen = ZIP_GET16( pabyExtra + i + 2 );
+            if( ZIP_GET16( pabyExtra + i ) != 0x0001 ||
+                i + 4 + nFieldLen > nExtraLen )
+                continue;
+
+            pabyField = pabyExtra + i + 4;
+            if( psEntry->nUncompressedSize == 0xFFFFFFFFU &&
+                pabyField + 8 <= pabyExtra + i + 4 + nFieldLen )
+            {
+                psEntry->nUncompressedSize = ZIP_GET64( pabyField );
+                pabyField += 8;
+            }
+            if( psEntry->nCompressedSize == 0xFFFFFFFFU &&
+                pabyField + 8 <= pabyExtra + i + 4 + nFieldLen )
+            {
+                psEntry->nCompressedSize = ZIP_GET64( pabyField );
+                pabyField += 8;
+            }
+            if( psEntry->nLocalHeaderOffset == 0xFFFFFFFFU &&
+                pabyField + 8 <= pabyExtra + i + 4 + nFieldLen )
+                psEntry->nLocalHeaderOffset = ZIP_GET64( pabyField );
+        }
+
+        /* Names with backslashes come from some Windows tools */
+        psEntry->pszName = (char *) CPLMalloc( nNameLen + 1 );
+        memcpy( psEntry->pszName, pabyHeader + ZIP_CENTRAL_HEADER_SIZE,
+                nNameLen );
+        psEntry->pszName[nNameLen] = '\0';
+        for( i = 0; i < nNameLen; i++ )
+        {
+            if( psEntry->pszName[i] == '\\' )
+                psEntry->pszName[i] = '/';
+        }
+        if( nNameLen > 0 && psEntry->pszName[nNameLen-1] == '/' )
+        {
+            psEntry->pszName[nNameLen-1] = '\0';
+            psEntry->bDir = TRUE;
+            psEntry->nMethod = -1;
+        }
+        if( psEntry->pszName[0] == '\0' || psEntry->pszName[0] == '/' )
+        {
+            CPLFree( psEntry->pszName );
+            psArchive->nEntries--;
+        }
+
+        nPos += ZIP_CENTRAL_HEADER_SIZE + nNameLen + nExtraLen + nCommentLen;
+    }
+
+    return TRUE;
+}
+
+/**********************************************************************
+ *                          VSIZipReadArchive()
+ *
+ * Read the central directory of an archive, which is found from the
+ * end of the archive (the ZIP64 one for the large archives).
+ **********************************************************************/
+static VSIZipArchive *VSIZipReadArchive( const char *pszArchive,
+                                         VSIStatBufL *psStatBuf )
+{
+    VSILFILE    *fp;
+    VSIZipArchive *psArchive;
+    GByte       *pabyTail, *pabyDir = NULL, abyEOCD64[ZIP_EOCD64_SIZE];
+    vsi_l_offset nFileSize = psStatBuf->st_size, nDirOffset, nDirSize;
+    size_t      nTail;
+    int         i, bValid = FALSE;
+
+    if( (fp = VSIFOpenL( pszArchive, "rb" )) == NULL )
+        return NULL;
+
+    nTail = (size_t) MIN( nFileSize,
+                          (vsi_l_offset) (ZIP_EOCD_SIZE + 65535 +
+                                          ZIP_EOCD64_LOCATOR_SIZE) );
+    pabyTail = (GByte *) CPLMalloc( MAX( nTail, 1 ) );
+    if( VSIFSeekL( fp, nFileSize - nTail, SEEK_SET ) != 0 ||
+        VSIFReadL( pabyTail, 1, nTail, fp ) != nTail )
+        nTail = 0;
+
+    /* The end of central directory record, before the archive comment */
+    for( i = (int) nTail - ZIP_EOCD_SIZE; i >= 0; i-- )
+    {
+        if( memcmp( pabyTail + i, "PK\005\006", 4 ) == 0 )
+            break;
+    }
+
+    if( i >= 0 )
+    {
+        nDirSize = ZIP_GET32( pabyTail + i + 12 );
+        nDirOffset = ZIP_GET32( pabyTail + i + 16 );
+        bValid = TRUE;
+
+        if( (nDirSize == 0xFFFFFFFFU || nDirOffset == 0xFFFFFFFFU ||
+             ZIP_GET16( pabyTail + i + 10 ) == 0xFFFF) &&
+            i >= ZIP_EOCD64_LOCATOR_SIZE &&
+            memcmp( pabyTail + i - ZIP_EOCD64_LOCATOR_SIZE,
+                    "PK\006\007", 4 ) == 0 )
+        {
+            bValid =
+                VSIFSeekL( fp, ZIP_GET64( pabyTail + i -
+                                          ZIP_EOCD64_LOCATOR_SIZE + 8 ),
+                           SEEK_SET ) == 0 &&
+                VSIFReadL( abyEOCD64, 1, ZIP_EOCD64_SIZE, fp ) ==
+                    ZIP_EOCD64_SIZE &&
+                memcmp( abyEOCD64, "PK\006\006", 4 ) == 0;
+            nDirSize = ZIP_GET64( abyEOCD64 + 40 );
+            nDirOffset = ZIP_GET64( abyEOCD64 + 48 );
+        }
+
+        bValid = bValid && nDirOffset <= nFileSize &&
+                 nDirSize <= nFileSize - nDirOffset &&
+                 nDirSize == (size_t) nDirSize &&
+                 (pabyDir = (GByte *) VSIMalloc( MAX( (size_t) nDirSize,
+                                                      1 ) )) != NULL &&
+                 VSIFSeekL( fp, nDirOffset, SEEK_SET ) == 0 &&
+                 VSIFReadL( pabyDir, 1, (size_t) nDirSize, fp ) == nDirSize;
+    }
+
+    VSIFCloseL( fp );
+    CPLFree( pabyTail );
+
+    psArchive = (VSIZipArchive *) CPLCalloc( 1, sizeof(VSIZipArchive) );
+    psArchive->pszFilename = CPLStrdup( pszArchive );
+    psArchive->nFileSize = nFileSize;
+    psArchive->nMTime = psStatBuf->st_mtime;
+    psArchive->nRefCount = 1;
+
+    if( bValid )
+        bValid = VSIZipParseDirectory( psArchive, pabyDir,
+                                       (size_t) nDirSize );
+    VSIFree( pabyDir );
+
+    if( !bValid )
+    {
+        VSIZipRelease( psArchive );
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "%s is not a valid ZIP archive.", pszArchive );
+        return NULL;
+    }
+
+    VSIZipAddDirs( psArchive );
+
+    return psArchive;
+}
+
+/**********************************************************************
+ *                          VSIZipRelease()
+ *
+ * Drop a reference to an archive, and free it with the last one.  The
+ * caller holds hZipArchivesMutex, unless nobody else knows the archive.
+ **********************************************************************/
+static void VSIZipRelease( VSIZipArchive *psArchive )
+{
+    int i;
+
+    if( --psArchive->nRefCount > 0 )
+        return;
+
+    for( i = 0; i < psArchive->nEntries; i++ )
+        CPLFree( psArchive->pasEntries[i].pszName );
+    CPLFree( psArchive->pasEntries );
+    CPLFree( psArchive->pszFilename );
+    CPLFree( psArchive );
+}
+
+/**********************************************************************
+ *                          VSIZipUnref()
+ *
+ * VSIZipRelease() under hZipArchivesMutex.  If the mutex cannot be
+ * taken, the archive is left in memory.
+ **********************************************************************/
+static void VSIZipUnref( VSIZipArchive *psArchive )
+{
+    if( !CPLCreateOrAcquireMutex( &hZipArchivesMutex ) )
+        return;
+
+    VSIZipRelease( psArchive );
+    CPLReleaseMutex( hZipArchivesMutex );
+}
+
+/**********************************************************************
+ *                          VSIZipGetArchive()
+ *
+ * Return a new reference to the directory of an archive, which is
+ * read if it is not in the cache or if the archive has changed.
+ * Returns NULL if the archive cannot be read.
+ **********************************************************************/
+static VSIZipArchive *VSIZipGetArchive( const char *pszArchive )
+{
+    VSIZipArchive *psArchive, *psNew, **ppsLink;
+    VSIStatBufL sStatBuf;
+
+    if( VSIStatL( pszArchive, &sStatBuf ) != 0 ||
+        VSI_ISDIR( sStatBuf.st_mode ) )
+        return NULL;
+
+    if( !CPLCreateOrAcquireMutex( &hZipArchivesMutex ) )
+        return NULL;
+    for( psArchive = psZipArchives; psArchive != NULL;
+         psArchive = psArchive->psNext )
+    {
+        if( strcmp( psArchive->pszFilename, pszArchive ) == 0 &&
+            psArchive->nFileSize == (vsi_l_offset) sStatBuf.st_size &&
+            psArchive->nMTime == sStatBuf.st_mtime )
+        {
+            psArchive->nRefCount++;
+            break;
+        }
+    }
+    CPLReleaseMutex( hZipArchivesMutex );
+
+    if( psArchive != NULL )
+        return psArchive;
+
+    /* Read without the mutex: it takes time and errors are reported */
+    if( (psNew = VSIZipReadArchive( pszArchive, &sStatBuf )) == NULL )
+        return NULL;
+
+    /* The archive cannot be cached without the mutex */
+    if( !CPLCreateOrAcquireMutex( &hZipArchivesMutex ) )
+    {
+        VSIZipRelease( psNew );
+        return NULL;
+    }
+    for( ppsLink = &psZipArchives; *ppsLink != NULL;
+         ppsLink = &((*ppsLink)->psNext) )
+    {
+        if( strcmp( (*ppsLink)->pszFilename, pszArchive ) == 0 )
+        {
+            psArchive = *ppsLink;
+            *ppsLink = psArchive->psNext;
+            VSIZipRelease( psArchive );
+            break;
+        }
+    }
+    psNew->nRefCount++;
+    psNew->psNext = psZipArchives;
+    psZipArchives = psNew;
+    CPLReleaseMutex( hZipArchivesMutex );
+
+    return psNew;
+}
+
+/**********************************************************************
+ *                          VSIZipFindEntry()
+ *
+ * The entry of a member or directory, or NULL.
+ **********************************************************************/
+static VSIZipEntry *VSIZipFindEntry( VSIZipArchive *psArchive,
+                                     const char *pszName )
+{
+    VSIZipEntry sKey;
+
+    sKey.pszName = (char *) pszName;
+
+    return (VSIZipEntry *) bsearch( &sKey, psArchive->pasEntries,
+                                    psArchive->nEntries,
+                                    sizeof(VSIZipEntry),
+                                    VSIZipCompareNames );
+}
+
+/**********************************************************************
+ *                          VSIZipSplitPath()
+ *
+ * Split a name under /vsizip/ into the name of the archive, which is
+ * returned, and the normalized name of the member in *ppszMember (""
+ * for the archive itself).  Both are freed with CPLFree().  Returns
+ * NULL if there is no ".zip" in the name.
+ **********************************************************************/
+static char *VSIZipSplitPath( const char *pszFilename, char **ppszMember )
+{
+    int         i, nPrefix = strlen( VSIZIP_PREFIX );
+    char        *pszPath = CPLStrdup( pszFilename ), *pszArchive;
+    char        *pszNormalized;
+
+    for( i = 0; pszPath[i] != '\0'; i++ )
+    {
+        if( pszPath[i] == '\\' )
+            pszPath[i] = '/';
+    }
+
+    for( i = nPrefix; pszPath[i] != '\0'; i++ )
+    {
+        if( EQUALN( pszPath + i, ".zip", 4 ) &&
+            (pszPath[i+4] == '/' || pszPath[i+4] == '\0') )
+            break;
+    }
+
+    if( pszPath[i] == '\0' )
+    {
+        CPLFree( pszPath );
+        return NULL;
+    }
+
+    i += 4;
+    pszNormalized = VSINormalizePath( pszPath, i );
+    *ppszMember = CPLStrdup( pszNormalized + i +
+                             (pszNormalized[i] == '/' ? 1 : 0) );
+
+    pszPath[i] = '\0';
+    pszArchive = CPLStrdup( pszPath + nPrefix );
+
+    CPLFree( pszNormalized );
+    CPLFree( pszPath );
+
+    return pszArchive;
+}
+
+/**********************************************************************
+ *                          VSIZipOpen()
+ *
+ * Only for reading.
+ **********************************************************************/
+static VSILFILE *VSIZipOpen( VSIFilesystemHandler *psFS,
+                             const char *pszFilename, const char *pszAccess )
+{
+    VSIZipArchive *psArchive;
+    VSIZipEntry *psEntry;
+    VSIGZipHandle *psHandle;
+    VSILFILE    *fp;
+    GByte       abyHeader[ZIP_LOCAL_HEADER_SIZE];
+    char        *pszArchive, *pszMember;
+    int         nMethod = 0, nFlags = 0, bUnsupported = FALSE;
+    int         bOpenFailed = FALSE;
+
+    if( strchr( pszAccess, 'w' ) != NULL || strchr( pszAccess, 'a' ) != NULL
+        || strchr( pszAccess, '+' ) != NULL )
+    {
+        errno = EACCES;
+        return NULL;
+    }
+
+    if( (pszArchive = VSIZipSplitPath( pszFilename, &pszMember )) == NULL )
+    {
+        errno = ENOENT;
+        return NULL;
+    }
+
+    errno = 0;
+    psArchive = VSIZipGetArchive( pszArchive );
+    psEntry = psArchive ? VSIZipFindEntry( psArchive, pszMember ) : NULL;
+    CPLFree( pszMember );
+
+    if( psEntry != NULL && !psEntry->bDir )
+    {
+        nMethod = psEntry->nMethod;
+        nFlags = psEntry->nFlags;
+    }
+
+    /* When the archive cannot be read or opened, errno is left as the
+     * failure set it
+     */
+    fp = NULL;
+    if( psArchive == NULL )
+    {
+        if( errno == 0 )
+            errno = ENOENT;
+    }
+    else if( psEntry == NULL )
+        errno = ENOENT;
+    else if( psEntry->bDir )
+        errno = EISDIR;
+    else if( (nFlags & 1) == 0 && (nMethod == 0 || nMethod == 8) )
+        bOpenFailed = ((fp = VSIFOpenL( pszArchive, "rb" )) == NULL);
+    else
+    {
+        bUnsupported = TRUE;
+        errno = EACCES;
+    }
+
+    if( fp == NULL )
+    {
+        if( psArchive != NULL )
+            VSIZipUnref( psArchive );
+        CPLFree( pszArchive );
+
+        if( bUnsupported )
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "%s: encrypted members and compression method %d "
+                      "are not supported.", pszFilename, nMethod );
+        else if( bOpenFailed )
+            CPLError( CE_Failure, CPLE_OpenFailed,
+                      "%s: cannot open the archive.", pszFilename );
+        return NULL;
+    }
+    CPLFree( pszArchive );
+
+    /* The data follows the local header, whose extra field may differ */
+    if( VSIFSeekL( fp, psEntry->nLocalHeaderOffset, SEEK_SET ) != 0 ||
+        VSIFReadL( abyHeader, 1, ZIP_LOCAL_HEADER_SIZE, fp ) !=
+            ZIP_LOCAL_HEADER_SIZE ||
+        memcmp( abyHeader, "PK\003\004", 4 ) != 0 )
+    {
+        VSIFCloseL( fp );
+        VSIZipUnref( psArchive );
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "%s: invalid local header.", pszFilename );
+        errno = EIO;
+        return NULL;
+    }
+
+    psHandle = VSIGZipNewHandle( psFS, pszFilename, fp,
+                                 psEntry->nLocalHeaderOffset +
+                                 ZIP_LOCAL_HEADER_SIZE +
+                                 ZIP_GET16( abyHeader + 26 ) +
+                                 ZIP_GET16( abyHeader + 28 ),
+                                 psEntry->nCompressedSize,
+                                 nMethod == 0 ? VSIGZIP_STORED
+                                              : VSIGZIP_DEFLATE );
+    if( psHandle == NULL )
+    {
+        VSIZipUnref( psArchive );
+        return NULL;
+    }
+
+    psHandle->nUncompressedSize = psEntry->nUncompressedSize;
+    psHandle->bSizeKnown = TRUE;
+    psHandle->bCheckSize = TRUE;
+    psHandle->bCheckCRC = TRUE;
+    psHandle->nExpectedCRC = psEntry->nCRC;
+    psHandle->psArchive = psArchive;
+
+    return (VSILFILE *) psHandle;
+}
+
+/**********************************************************************
+ *                          VSIZipStat()
+ **********************************************************************/
+static int VSIZipStat( VSIFilesystemHandler *psFS, const char *pszFilename,
+                       VSIStatBufL *psStatBuf )
+{
+    VSIZipArchive *psArchive = NULL;
+    VSIZipEntry *psEntry = NULL;
+    char        *pszArchive, *pszMember = NULL;
+    int         nRet = -1;
+
+    memset( psStatBuf, 0, sizeof(VSIStatBufL) );
+
+    if( (pszArchive = VSIZipSplitPath( pszFilename, &pszMember )) != NULL &&
+        (psArchive = VSIZipGetArchive( pszArchive )) != NULL )
+    {
+        psStatBuf->st_mtime = psArchive->nMTime;
+        if( pszMember[0] == '\0' )
+        {
+            psStatBuf->st_mode = S_IFDIR;
+            nRet = 0;
+        }
+        else if( (psEntry = VSIZipFindEntry( psArchive, pszMember )) != NULL )
+        {
+            psStatBuf->st_mode = psEntry->bDir ? S_IFDIR : S_IFREG;
+            psStatBuf->st_size = psEntry->nUncompressedSize;
+            nRet = 0;
+        }
+
+        VSIZipUnref( psArchive );
+    }
+
+    CPLFree( pszArchive );
+    CPLFree( pszMember );
+
+    if( nRet != 0 )
+        errno = ENOENT;
+
+    return nRet;
+}
+
+/**********************************************************************
+ *                          VSIZipReadDir()
+ *
+ * The names of the members and directories right under a directory.
+ * They follow it in the sorted entries.
+ **********************************************************************/
+static char **VSIZipReadDir( VSIFilesystemHandler *psFS,
+                             const char *pszPath )
+{
+    VSIZipArchive *psArchive;
+    VSIZipEntry *psEntry;
+    char        *pszArchive, *pszMember, **papszDir = NULL;
+    const char  *pszChild;
+    int         i, nLen;
+
+    if( (pszArchive = VSIZipSplitPath( pszPath, &pszMember )) == NULL )
+        return NULL;
+
+    if( (psArchive = VSIZipGetArchive( pszArchive )) != NULL )
+    {
+        nLen = strlen( pszMember );
+        psEntry = nLen > 0 ? VSIZipFindEntry( psArchive, pszMember ) : NULL;
+        i = psEntry != NULL ? (int) (psEntry - psArchive->pasEntries) + 1 : 0;
+
+        for( ; (nLen == 0 || psEntry != NULL) && i < psArchive->nEntries;
+             i++ )
+        {
+            pszChild = psArchive->pasEntries[i].pszName;
+            if( nLen > 0 )
+            {
+                /* "dir-x" sorts before "dir/x": skip the names like it */
+                if( strncmp( pszChild, pszMember, nLen ) != 0 ||
+                    pszChild[nLen] > '/' )
+                    break;
+                if( pszChild[nLen] != '/' )
+                    continue;
+                pszChild += nLen + 1;
+            }
+
+            if( strchr( pszChild, '/' ) == NULL )
+                papszDir = CSLAddString( papszDir, pszChild );
+        }
+
+        VSIZipUnref( psArchive );
+    }
+
+    CPLFree( pszArchive );
+    CPLFree( pszMember );
+
+    return papszDir;
+}
+
+VSIFilesystemHandler sVSIZipFilesystemHandler =
+{
+    VSIZipOpen, VSIZipStat, NULL, VSIZipReadDir,
+    VSIGZipClose, VSIGZipSeek, VSIGZipTell, VSIGZipRead, VSIGZipWrite,
+    VSIGZipEof,
+    VSIGZipMap, VSIGZipUnmap, NULL
+};
+
+/*=====================================================================
+                          gzip and zstd files
+ *====================================================================*/
+
+/**********************************************************************
+ *                          VSIGZipOpen()
+ *
+ * Open /vsigzip/file.gz or /vsizstd/file.zst for reading ("r" or
+ * "rb") or for writing a new file ("w" or "wb").
+ **********************************************************************/
+static VSILFILE *VSIGZipOpen( VSIFilesystemHandler *psFS,
+                              const char *pszFilename,
+                              const char *pszAccess )
+{
+    const char  *pszBase;
+    int         nCodec;
+    VSILFILE    *fpBase;
+    VSIStatBufL sStatBuf;
+    VSIGZipHandle *psHandle;
+
+    if( psFS == &sVSIZstdFilesystemHandler )
+    {
+        pszBase = pszFilename + strlen( VSIZSTD_PREFIX );
+        nCodec = VSIGZIP_ZSTD;
+#ifndef HAVE_ZSTD
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "%s: zstd is not supported by this build.", pszFilename );
+        errno = ENOSYS;
+        return NULL;
+#endif
+    }
+    else
+    {
+        pszBase = pszFilename + strlen( VSIGZIP_PREFIX );
+        nCodec = VSIGZIP_GZIP;
+    }
+
+    if( strchr( pszAccess, 'a' ) != NULL || strchr( pszAccess, '+' ) != NULL )
+    {
+        errno = EACCES;
+        return NULL;
+    }
+
+    if( strchr( pszAccess, 'w' ) != NULL )
+    {
+        if( (fpBase = VSIFOpenL( pszBase, "wb" )) == NULL )
+            return NULL;
+
+        return (VSILFILE *) VSIGZipNewWriter( psFS, pszFilename, fpBase,
+                                              nCodec );
+    }
+
+    if( VSIStatL( pszBase, &sStatBuf ) != 0 ||
+        (fpBase = VSIFOpenL( pszBase, "rb" )) == NULL )
+        return NULL;
+
+    psHandle = VSIGZipNewHandle( psFS, pszFilename, fpBase, 0,
+                                 sStatBuf.st_size, nCodec );
+
+    return (VSILFILE *) psHandle;
+}
+
+/**********************************************************************
+ *                          VSIGZipStat()
+ *
+ * That of the compressed file: the size of its contents is not known
+ * without decompressing it.
+ **********************************************************************/
+static int VSIGZipStat( VSIFilesystemHandler *psFS, const char *pszFilename,
+                        VSIStatBufL *psStatBuf )
+{
+    if( psFS == &sVSIZstdFilesystemHandler )
+        return VSIStatL( pszFilename + strlen( VSIZSTD_PREFIX ), psStatBuf );
+
+    return VSIStatL( pszFilename + strlen( VSIGZIP_PREFIX ), psStatBuf );
+}
+
+VSIFilesystemHandler sVSIGZipFilesystemHandler =
+{
+    VSIGZipOpen, VSIGZipStat, NULL, NULL,
+    VSIGZipClose, VSIGZipSeek, VSIGZipTell, VSIGZipRead, VSIGZipWrite,
+    VSIGZipEof,
+    VSIGZipMap, VSIGZipUnmap, NULL
+};
+
+VSIFilesystemHandler sVSIZstdFilesystemHandler =
+{
+    VSIGZipOpen, VSIGZipStat, NULL, NULL,
+    VSIGZipClose, VSIGZipSeek, VSIGZipTell, VSIGZipRead, VSIGZipWrite,
+    VSIGZipEof,
+    VSIGZipMap, VSIGZipUnmap, NULL
+};
@@ -50,14 +50,21 @@
  *
  */
 
-#include "cpl_vsi.h"
+#include "cpl_vsi_virtual.h"
+#include "cpl_conv.h"
 
 /* for stat() */
 
 #ifndef WIN32
 #  include <unistd.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#else
+#  include <io.h>       /* unlink() */
 #endif
 #include <sys/stat.h>
+#include <limits.h>
+#include <errno.h>
 
 /************************************************************************/
 /*                              VSIFOpen()                              */
@@ -190,6 +197,71 @@ int VSIFEof( FILE * fp )
     return( feof( fp ) );
 }
 
+/************************************************************************/
+/*                              VSIFMap()                               */
+/*                                                                      */
+/*      Map the whole file read-only in memory.  Returns NULL (and      */
+/*      the caller should fall back on VSIFRead()) if the platform      */
+/*      or the file does not support it, or if the file is empty or     */
+/*      too large to be addressed with an int offset.                   */
+/************************************************************************/
+
+void *VSIFMap( FILE * fp, size_t * pnSize )
+
+{
+#ifndef WIN32
+    struct stat sStat;
+    void        *pData;
+
+    if( fstat( fileno( fp ), &sStat ) != 0 || sStat.st_size <= 0
+        || sStat.st_size > INT_MAX )
+        return NULL;
+
+    pData = mmap( NULL, (size_t) sStat.st_size, PROT_READ, MAP_SHARED,
+                  fileno( fp ), 0 );
+    if( pData == MAP_FAILED )
+        return NULL;
+
+    *pnSize = (size_t) sStat.st_size;
+    return pData;
+#else
+    return NULL;
+#endif
+}
+
+/************************************************************************/
+/*                        VSIFAdviseSequential()                        */
+/*                                                                      */
+/*      Tell the system that the file (and its mapping, if pData is     */
+/*      not NULL) will be read sequentially, so that it reads ahead     */
+/*      more of it.  It does nothing where this is not supported.       */
+/************************************************************************/
+
+void VSIFAdviseSequential( FILE * fp, void * pData, size_t nSize )
+
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise( fileno( fp ), 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+#ifdef POSIX_MADV_SEQUENTIAL
+    if( pData != NULL )
+        posix_madvise( pData, nSize, POSIX_MADV_SEQUENTIAL );
+#endif
+}
+
+/************************************************************************/
+/*                             VSIFUnmap()                              */
+/************************************************************************/
+
+void VSIFUnmap( void * pData, size_t nSize )
+
+{
+#ifndef WIN32
+    if( pData != NULL )
+        munmap( pData, nSize );
+#endif
+}
+
 /************************************************************************/
 /*                              VSIFPuts()                              */
 /************************************************************************/
@@ -270,3 +342,185 @@ int VSIStat( const char * pszFilename, VSIStatBuf * pStatBuf )
 {
     return( stat( pszFilename, pStatBuf ) );
 }
+
+/* ==================================================================== */
+/*      The stdio file system, for the large file functions of the      */
+/*      files that are not in a virtual file system (see cpl_vsil.c).   */
+/* ==================================================================== */
+
+typedef struct
+{
+    VSILFILE    sBase;
+    FILE        *fp;
+} VSIStdioHandle;
+
+#define VSI_STDIO_FP(fp)    (((VSIStdioHandle *) (fp))->fp)
+
+/************************************************************************/
+/*                          VSIStdioOpen()                              */
+/************************************************************************/
+
+static VSILFILE *VSIStdioOpen( VSIFilesystemHandler * psFS,
+                               const char * pszFilename,
+                               const char * pszAccess )
+
+{
+    VSIStdioHandle *psHandle;
+    FILE        *fp;
+
+    if( (fp = VSIFOpen( pszFilename, pszAccess )) == NULL )
+        return NULL;
+
+    psHandle = (VSIStdioHandle *) CPLCalloc( 1, sizeof(VSIStdioHandle) );
+    psHandle->sBase.psFS = psFS;
+    psHandle->fp = fp;
+
+    return (VSILFILE *) psHandle;
+}
+
+/************************************************************************/
+/*                          VSIStdioStat()                              */
+/************************************************************************/
+
+static int VSIStdioStat( VSIFilesystemHandler * psFS,
+                         const char * pszFilename, VSIStatBufL * pStatBuf )
+
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    return( _stati64( pszFilename, pStatBuf ) );
+#else
+    return( stat( pszFilename, pStatBuf ) );
+#endif
+}
+
+/************************************************************************/
+/*                         VSIStdioUnlink()                             */
+/************************************************************************/
+
+static int VSIStdioUnlink( VSIFilesystemHandler * psFS,
+                           const char * pszFilename )
+
+{
+    return( unlink( pszFilename ) );
+}
+
+/************************************************************************/
+/*                         VSIStdioReadDir()                            */
+/************************************************************************/
+
+static char **VSIStdioReadDir( VSIFilesystemHandler * psFS,
+                               const char * pszPath )
+
+{
+    return( CPLReadDir( pszPath ) );
+}
+
+/************************************************************************/
+/*                          VSIStdioClose()                             */
+/************************************************************************/
+
+static int VSIStdioClose( VSILFILE * fp )
+
+{
+    int nRet = VSIFClose( VSI_STDIO_FP(fp) );
+
+    CPLFree( fp );
+
+    return nRet;
+}
+
+/************************************************************************/
+/*                          VSIStdioSeek()                              */
+/*                                                                      */
+/*      It fails, instead of moving to a wrong position, if the         */
+/*      offset does not fit in the off_t of the platform (see           */
+/*      _FILE_OFFSET_BITS).                                             */
+/************************************************************************/
+
+static int VSIStdioSeek( VSILFILE * fp, vsi_l_offset nOffset, int nWhence )
+
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    return( _fseeki64( VSI_STDIO_FP(fp), (__int64) nOffset, nWhence ) );
+#else
+    if( (vsi_l_offset) (off_t) nOffset != nOffset )
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+
+    return( fseeko( VSI_STDIO_FP(fp), (off_t) nOffset, nWhence ) );
+#endif
+}
+
+/************************************************************************/
+/*                          VSIStdioTell()                              */
+/************************************************************************/
+
+static vsi_l_offset VSIStdioTell( VSILFILE * fp )
+
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    return( (vsi_l_offset) _ftelli64( VSI_STDIO_FP(fp) ) );
+#else
+    return( (vsi_l_offset) ftello( VSI_STDIO_FP(fp) ) );
+#endif
+}
+
+/************************************************************************/
+/*                     VSIStdioRead() / VSIStdioWrite()                 */
+/************************************************************************/
+
+static size_t VSIStdioRead( void * pBuffer, size_t nSize, size_t nCount,
+                            VSILFILE * fp )
+
+{
+    return( fread( pBuffer, nSize, nCount, VSI_STDIO_FP(fp) ) );
+}
+
+static size_t VSIStdioWrite( const void * pBuffer, size_t nSize,
+                             size_t nCount, VSILFILE * fp )
+
+{
+    return( fwrite( pBuffer, nSize, nCount, VSI_STDIO_FP(fp) ) );
+}
+
+/************************************************************************/
+/*                           VSIStdioEof()                              */
+/************************************************************************/
+
+static int VSIStdioEof( VSILFILE * fp )
+
+{
+    return( feof( VSI_STDIO_FP(fp) ) );
+}
+
+/************************************************************************/
+/*            VSIStdioMap(), VSIStdioUnmap(), VSIStdioAdvise()          */
+/************************************************************************/
+
+static void *VSIStdioMap( VSILFILE * fp, size_t * pnSize )
+
+{
+    return( VSIFMap( VSI_STDIO_FP(fp), pnSize ) );
+}
+
+static void VSIStdioUnmap( VSILFILE * fp, void * pData, size_t nSize )
+
+{
+    VSIFUnmap( pData, nSize );
+}
+
+static void VSIStdioAdvise( VSILFILE * fp, void * pData, size_t nSize )
+
+{
+    VSIFAdviseSequential( VSI_STDIO_FP(fp), pData, nSize );
+}
+
+VSIFilesystemHandler sVSIStdioFilesystemHandler =
+{
+    VSIStdioOpen, VSIStdioStat, VSIStdioUnlink, VSIStdioReadDir,
+    VSIStdioClose, VSIStdioSeek, VSIStdioTell, VSIStdioRead, 
+    VSIStdioWrite, VSIStdioEof,
+    VSIStdioMap, VSIStdioUnmap, VSIStdioAdvise
+};
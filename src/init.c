@@ -8,16 +8,24 @@ static R_CallMethodDef CallEntries[] = {
 //    {"get_names_of_coverages", (DL_FUNC) &get_names_of_coverages, 1},
     {"get_table_names", (DL_FUNC) &get_table_names, 1},
     {"get_table_fields", (DL_FUNC) &get_table_fields, 2},
-    {"get_arc_data", (DL_FUNC) &get_arc_data, 3},
+    {"get_arc_data", (DL_FUNC) &get_arc_data, 7},
     {"get_bnd_data", (DL_FUNC) &get_bnd_data, 2},
-    {"get_pal_data", (DL_FUNC) &get_pal_data, 3},
+    {"get_pal_data", (DL_FUNC) &get_pal_data, 7},
     {"get_lab_data", (DL_FUNC) &get_lab_data, 3},
-    {"get_cnt_data", (DL_FUNC) &get_cnt_data, 3},
+    {"get_cnt_data", (DL_FUNC) &get_cnt_data, 4},
     {"get_tol_data", (DL_FUNC) &get_tol_data, 3},
-    {"get_table_data", (DL_FUNC) &get_table_data, 2},
-    {"get_txt_data", (DL_FUNC) &get_txt_data, 3},
+    {"get_table_data", (DL_FUNC) &get_table_data, 7},
+    {"get_txt_data", (DL_FUNC) &get_txt_data, 4},
+    {"open_coverage", (DL_FUNC) &open_coverage, 2},
+    {"close_coverage", (DL_FUNC) &close_coverage, 1},
+    {"coverage_info", (DL_FUNC) &coverage_info, 1},
+    {"coverage_iter", (DL_FUNC) &coverage_iter, 4},
+    {"next_chunk", (DL_FUNC) &next_chunk, 1},
+    {"vsimem_write", (DL_FUNC) &vsimem_write, 2},
+    {"vsimem_read", (DL_FUNC) &vsimem_read, 1},
+    {"vsimem_unlink", (DL_FUNC) &vsimem_unlink, 1},
     {"e00toavc", (DL_FUNC) &e00toavc, 2},
-    {"avctoe00", (DL_FUNC) &avctoe00, 2},
+    {"avctoe00", (DL_FUNC) &avctoe00, 3},
     {NULL, NULL, 0}
 };
 
@@ -26,10 +34,14 @@ void
 #ifdef HAVE_VISIBILITY_ATTRIBUTE
 __attribute__ ((visibility ("default")))
 #endif
-R_init_sp(DllInfo *dll)
+R_init_RArcInfo(DllInfo *dll)
 {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
 
+#ifdef HAVE_ALTREP
+    init_lazy_classes(dll);
+#endif
+
 }
 
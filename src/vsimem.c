@@ -0,0 +1,86 @@
+#include<string.h>
+#include"RArcInfo.h"
+#include"avc.h"
+
+#include<R.h>
+#include<Rinternals.h>
+
+/*
+Files in memory, under /vsimem/ (see cpl_vsi_mem.c). They can be used as
+any other file by the functions of the package, so that a coverage can be
+read from raw vectors without writing it to disk.
+*/
+
+/*It makes a file in memory with a copy of the raw vector data, in place of
+the file with the same name if there is one*/
+SEXP vsimem_write(SEXP filename, SEXP data)
+{
+	const char *pszName=CHAR(STRING_ELT(filename,0));
+	GByte *pabyData;
+	VSILFILE *fp;
+
+	if(strncmp(pszName, "/vsimem/", 8)!=0)
+		error("The name of the file must start with /vsimem/");
+
+	/*The file frees the copy when it is unlinked*/
+	pabyData=(GByte *)CPLMalloc(MAX(XLENGTH(data), 1));
+	memcpy(pabyData, RAW(data), XLENGTH(data));
+
+	if(!(fp=VSIFileFromMemBuffer(pszName, pabyData, XLENGTH(data), TRUE)))
+	{
+		CPLFree(pabyData);
+		error("Couldn't make the file in memory");
+	}
+	VSIFCloseL(fp);
+
+	return R_NilValue;
+}
+
+/*It returns a copy of the contents of a file in memory, or NULL if there
+is no such file*/
+SEXP vsimem_read(SEXP filename)
+{
+	const char *pszName=CHAR(STRING_ELT(filename,0));
+	VSIStatBufL sStatBuf;
+	VSILFILE *fp;
+	SEXP aux;
+
+	if(strncmp(pszName, "/vsimem/", 8)!=0 ||
+		VSIStatL(pszName, &sStatBuf)!=0 || !VSI_ISREG(sStatBuf.st_mode))
+		return R_NilValue;
+
+	PROTECT(aux=allocVector(RAWSXP, (R_xlen_t)sStatBuf.st_size));
+
+	if(!(fp=VSIFOpenL(pszName, "rb")))
+	{
+		UNPROTECT(1);
+		return R_NilValue;
+	}
+	VSIFReadL(RAW(aux), 1, XLENGTH(aux), fp);
+	VSIFCloseL(fp);
+
+	UNPROTECT(1);
+
+	return aux;
+}
+
+/*It removes files from memory. It returns TRUE for each file that
+existed*/
+SEXP vsimem_unlink(SEXP filename)
+{
+	int i;
+	SEXP aux;
+
+	PROTECT(aux=NEW_LOGICAL(LENGTH(filename)));
+
+	for(i=0;i<LENGTH(filename);i++)
+	{
+		LOGICAL(aux)[i]=
+			(strncmp(CHAR(STRING_ELT(filename,i)), "/vsimem/", 8)==0 &&
+			VSIUnlink(CHAR(STRING_ELT(filename,i)))==0);
+	}
+
+	UNPROTECT(1);
+
+	return aux;
+}
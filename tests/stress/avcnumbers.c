@@ -0,0 +1,285 @@
+/**********************************************************************
+ * avcnumbers.c
+ *
+ * Test of the conversion of the numbers of the E00 lines by
+ * AVCE00Str2Dbl() and AVCE00Str2Int().  Their results must be the same,
+ * bit for bit, as those of strtod() and atoi() on a '\0'-terminated
+ * copy of the field in the "C" locale, and the lines must not be
+ * modified.
+ *
+ * The values are random:
+ *  - real values written as avc_e00gen.c does ("%10.7E", "%17.14E" and
+ *    "%20.17E" after the sign), alone or followed by the next value,
+ *  - random strings of the characters of numbers (and of "inf", "nan"
+ *    or "0x"), for the cases that are left to strtod(),
+ *  - integers with spaces and signs around them.
+ * The real values are checked again with a decimal comma, if a locale
+ * that has one is installed.
+ *
+ * The test is not run by R CMD check.  Build it from the top directory of
+ * the package with something like:
+ *
+ *   cc -O2 -pthread $(R CMD config --cppflags) -Isrc -o avcnumbers \
+ *      tests/stress/avcnumbers.c src/avc_*.c src/cpl_*.c \
+ *      -L$(R RHOME)/lib -lR -lm -lz
+ *
+ * and run it without arguments.  The program returns 0 if all the
+ * values were the same.
+ **********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <math.h>
+
+#include "avc.h"
+
+#define NUM_FIELDS      1000000
+#define NUM_STRINGS     1000000
+#define NUM_INTS        1000000
+#define NUM_LOCALE      100000
+
+static GUIntBig nRandom = 0;
+
+/**********************************************************************
+ *                          Random64()
+ *
+ * xorshift64: the same values on every platform.
+ **********************************************************************/
+static GUIntBig Random64(void)
+{
+    if (nRandom == 0)
+        nRandom = ((GUIntBig)0x2545F491 << 32) | 0x4F6CDD1D;
+
+    nRandom ^= nRandom << 13;
+    nRandom ^= nRandom >> 7;
+    nRandom ^= nRandom << 17;
+
+    return nRandom;
+}
+
+/**********************************************************************
+ *                          RandomValue()
+ *
+ * A value of any magnitude (random bits), a coordinate, an integer, or
+ * a value with few significant bits.
+ **********************************************************************/
+static double RandomValue(void)
+{
+    GUIntBig    nBits = Random64();
+    double      dValue;
+
+    switch (Random64() % 4)
+    {
+      case 0:
+        memcpy(&dValue, &nBits, sizeof(double));
+        if (dValue != dValue || dValue - dValue != 0.0)
+            dValue = 0.0;
+        break;
+      case 1:
+        dValue = (double)(nBits >> 11) / 9007199254740992.0 * 1e7;
+        break;
+      case 2:
+        dValue = (double)(int)(nBits % 200001) - 100000.0;
+        break;
+      default:
+        dValue = ldexp((double)(nBits >> 40), (int)(Random64() % 121) - 60);
+        break;
+    }
+
+    return (Random64() % 2) ? -dValue : dValue;
+}
+
+/**********************************************************************
+ *                          FormatField()
+ *
+ * Append a value to pszBuf as _PrintRealValue() does in an E00 line of
+ * nWidth chars fields.  Values with 3 digits exponents are longer.
+ **********************************************************************/
+static void FormatField(char *pszBuf, double dValue, int nWidth)
+{
+    int     nDecimals = (nWidth == 14 ? 7 : nWidth == 21 ? 14 : 17);
+
+    pszBuf += strlen(pszBuf);
+    *pszBuf = (dValue < 0.0 ? '-' : ' ');
+    sprintf(pszBuf+1, "%.*E", nDecimals, fabs(dValue));
+}
+
+/**********************************************************************
+ *                          Strtod()
+ *
+ * The expected value of a field: strtod() on a copy of its numChars
+ * first characters.
+ **********************************************************************/
+static double Strtod(const char *pszStr, int numChars)
+{
+    char    szField[100];
+
+    strncpy(szField, pszStr, numChars);
+    szField[numChars] = '\0';
+
+    return strtod(szField, NULL);
+}
+
+/**********************************************************************
+ *                          CheckDbl()
+ *
+ * Returns 1 (and prints the field) if AVCE00Str2Dbl() does not return
+ * dExpected, or modifies the string.
+ **********************************************************************/
+static int CheckDbl(const char *pszStr, int numChars, double dExpected)
+{
+    char    szCopy[200];
+    double  dValue;
+
+    strcpy(szCopy, pszStr);
+    dValue = AVCE00Str2Dbl(szCopy, numChars);
+
+    if (memcmp(&dValue, &dExpected, sizeof(double)) != 0 ||
+        strcmp(szCopy, pszStr) != 0)
+    {
+        fprintf(stderr, "AVCE00Str2Dbl(\"%s\", %d) = %.17g instead of "
+                "%.17g\n", pszStr, numChars, dValue, dExpected);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          CheckInt()
+ *
+ * The same for AVCE00Str2Int() and atoi().
+ **********************************************************************/
+static int CheckInt(const char *pszStr, int numChars)
+{
+    char    szCopy[200], szField[100];
+    int     nValue, nExpected;
+
+    strncpy(szField, pszStr, numChars);
+    szField[numChars] = '\0';
+    nExpected = atoi(szField);
+
+    strcpy(szCopy, pszStr);
+    nValue = AVCE00Str2Int(szCopy, numChars);
+
+    if (nValue != nExpected || strcmp(szCopy, pszStr) != 0)
+    {
+        fprintf(stderr, "AVCE00Str2Int(\"%s\", %d) = %d instead of %d\n",
+                pszStr, numChars, nValue, nExpected);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                          RandomString()
+ *
+ * Up to nMaxLen random characters from pszChars.
+ **********************************************************************/
+static void RandomString(char *pszBuf, const char *pszChars, int nMaxLen)
+{
+    int     i, nLen = (int)(Random64() % (nMaxLen+1));
+    int     numChars = (int)strlen(pszChars);
+
+    for(i=0; i<nLen; i++)
+        pszBuf[i] = pszChars[Random64() % numChars];
+    pszBuf[nLen] = '\0';
+}
+
+int main(void)
+{
+    static const int anWidths[] = {14, 21, 24};
+    static const char * const apszLocales[] = {"de_DE.UTF-8", "fr_FR.UTF-8",
+                                               "de_DE", "fr_FR", "German"};
+    char        szLine[200], (*paszFields)[40];
+    double      *padfExpected;
+    int         i, nWidth, numErrors = 0;
+
+    setlocale(LC_NUMERIC, "C");
+
+/*---------------------------------------------------------------------
+ *      Real values of E00 lines, alone or followed by the next one.
+ *--------------------------------------------------------------------*/
+    for(i=0; i<NUM_FIELDS; i++)
+    {
+        nWidth = anWidths[Random64() % 3];
+
+        szLine[0] = '\0';
+        FormatField(szLine, RandomValue(), nWidth);
+        if (Random64() % 2)
+            FormatField(szLine, RandomValue(), nWidth);
+
+        numErrors += CheckDbl(szLine, nWidth, Strtod(szLine, nWidth));
+        if ((int)strlen(szLine) > nWidth)
+            numErrors += CheckDbl(szLine+nWidth, nWidth,
+                                  Strtod(szLine+nWidth, nWidth));
+    }
+
+/*---------------------------------------------------------------------
+ *      Anything else, shorter or longer than the field.
+ *--------------------------------------------------------------------*/
+    for(i=0; i<NUM_STRINGS; i++)
+    {
+        RandomString(szLine, (i % 10 == 0) ? " +-.0123456789Eeinfaxp"
+                                           : " +-.00123456789E", 40);
+        nWidth = 1 + (int)(Random64() % 30);
+
+        numErrors += CheckDbl(szLine, nWidth, Strtod(szLine, nWidth));
+    }
+
+/*---------------------------------------------------------------------
+ *      Integers: at most 9 digits, then something else, for atoi() not
+ *      to overflow.
+ *--------------------------------------------------------------------*/
+    for(i=0; i<NUM_INTS; i++)
+    {
+        RandomString(szLine, " ", 3);
+        RandomString(szLine+strlen(szLine), "+-", 1);
+        RandomString(szLine+strlen(szLine), "0123456789", 9);
+        RandomString(szLine+strlen(szLine), " +-", 1);
+        RandomString(szLine+strlen(szLine), " +-0123456789", 12);
+        nWidth = 1 + (int)(Random64() % 16);
+
+        numErrors += CheckInt(szLine, nWidth);
+    }
+
+/*---------------------------------------------------------------------
+ *      Real values again, with a decimal comma.
+ *--------------------------------------------------------------------*/
+    paszFields = (char (*)[40])CPLMalloc(NUM_LOCALE*sizeof(*paszFields));
+    padfExpected = (double*)CPLMalloc(NUM_LOCALE*sizeof(double));
+
+    for(i=0; i<NUM_LOCALE; i++)
+    {
+        paszFields[i][0] = '\0';
+        FormatField(paszFields[i], RandomValue(), anWidths[i % 3]);
+        padfExpected[i] = Strtod(paszFields[i], anWidths[i % 3]);
+    }
+
+    for(i=0; i<(int)(sizeof(apszLocales)/sizeof(apszLocales[0])); i++)
+    {
+        if (setlocale(LC_NUMERIC, apszLocales[i]) != NULL &&
+            localeconv()->decimal_point[0] == ',')
+            break;
+    }
+
+    if (i < (int)(sizeof(apszLocales)/sizeof(apszLocales[0])))
+    {
+        for(i=0; i<NUM_LOCALE; i++)
+            numErrors += CheckDbl(paszFields[i], anWidths[i % 3],
+                                  padfExpected[i]);
+        setlocale(LC_NUMERIC, "C");
+    }
+    else
+        printf("No locale with a decimal comma: not tested.\n");
+
+    CPLFree(paszFields);
+    CPLFree(padfExpected);
+
+    printf("%d real values, %d strings, %d integers: %d errors.\n",
+           NUM_FIELDS, NUM_STRINGS, NUM_INTS, numErrors);
+
+    return (numErrors == 0 ? 0 : 1);
+}
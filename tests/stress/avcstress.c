@@ -0,0 +1,338 @@
+/**********************************************************************
+ * avcstress.c
+ *
+ * Stress test of the AVC library used from several threads at once.
+ *
+ * Each thread, several times:
+ *  - exports every coverage to E00 (in memory) and compares the result
+ *    with the one of the main thread,
+ *  - imports the E00 of every coverage into a coverage of its own, and
+ *    compares the export of that coverage with the one of the main thread,
+ *  - opens a coverage that does not exist, and checks that the error is
+ *    seen by this thread only.
+ *
+ * The test is not run by R CMD check.  Build it from the top directory of
+ * the package with something like:
+ *
+ *   cc -O2 -pthread $(R CMD config --cppflags) -Isrc -o avcstress \
+ *      tests/stress/avcstress.c src/avc_*.c src/cpl_*.c \
+ *      -L$(R RHOME)/lib -lR -lm -lz
+ *
+ * and run it with the paths of the coverages to use, for instance the
+ * wetlands example and the valencia one (from valencia.zip):
+ *
+ *   ./avcstress inst/exampleData/wetlands /tmp/valencia/valencia
+ *
+ * The program returns 0 if all the threads got the same results as the
+ * main thread.
+ **********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "avc.h"
+
+#define STRESS_THREADS  8
+#define STRESS_ROUNDS   5
+
+typedef struct StressCover_t
+{
+    const char  *pszPath;
+    char        *pszE00File;    /* Export of the coverage, on disk      */
+    char        **papszE00;     /* Same, in memory                      */
+    char        **papszE00Again;/* Export after an import of papszE00   */
+}StressCover;
+
+typedef struct StressThread_t
+{
+    pthread_t   hThread;
+    int         iThread;
+    StressCover *pasCovers;
+    int         numCovers;
+    int         numErrors;
+}StressThread;
+
+/**********************************************************************
+ *                          ExportCover()
+ *
+ * Export a coverage to E00.  Returns a StringList with the lines, or
+ * NULL if the coverage could not be opened.
+ **********************************************************************/
+static char **ExportCover(const char *pszCoverPath)
+{
+    AVCE00ReadPtr   hReadInfo;
+    const char      *pszLine;
+    char            **papszLines = NULL;
+    int             numLines = 0, nMaxLines = 0;
+
+    if ((hReadInfo = AVCE00ReadOpen(pszCoverPath)) == NULL)
+        return NULL;
+
+    /* CSLAddString() would be quadratic on large coverages */
+    while ((pszLine = AVCE00ReadNextLine(hReadInfo)) != NULL)
+    {
+        if (numLines+1 >= nMaxLines)
+        {
+            nMaxLines = 2*nMaxLines + 1024;
+            papszLines = (char**)CPLRealloc(papszLines,
+                                            nMaxLines*sizeof(char*));
+        }
+        papszLines[numLines++] = CPLStrdup(pszLine);
+        papszLines[numLines] = NULL;
+    }
+
+    AVCE00ReadClose(hReadInfo);
+
+    if (papszLines == NULL)
+        papszLines = (char**)CPLCalloc(1, sizeof(char*));
+
+    return papszLines;
+}
+
+/**********************************************************************
+ *                          ImportCover()
+ *
+ * Import an E00 file into a new coverage.  The lines are read with
+ * CPLReadLine(), so that its buffer is used by all the threads.
+ *
+ * Returns TRUE on success.
+ **********************************************************************/
+static GBool ImportCover(const char *pszE00File, const char *pszCoverPath)
+{
+    AVCE00WritePtr  hWriteInfo;
+    const char      *pszLine;
+    FILE            *fpIn;
+
+    if ((fpIn = VSIFOpen(pszE00File, "rt")) == NULL)
+        return FALSE;
+
+    if ((hWriteInfo = AVCE00WriteOpen(pszCoverPath,
+                                      AVC_DEFAULT_PREC)) == NULL)
+    {
+        VSIFClose(fpIn);
+        return FALSE;
+    }
+
+    while (CPLGetLastErrorNo() == 0 &&
+           (pszLine = CPLReadLine(fpIn)) != NULL)
+        AVCE00WriteNextLine(hWriteInfo, pszLine, (int)strlen(pszLine));
+
+    AVCE00WriteClose(hWriteInfo);
+    VSIFClose(fpIn);
+
+    return (CPLGetLastErrorNo() == 0);
+}
+
+/**********************************************************************
+ *                          CompareLines()
+ *
+ * Returns TRUE if both exports are the same.  The first line (EXP) has
+ * the path of the coverage, so it is skipped if bSkipFirst is TRUE.
+ **********************************************************************/
+static GBool CompareLines(char **papszA, char **papszB, GBool bSkipFirst)
+{
+    int i;
+
+    if (papszA == NULL || papszB == NULL ||
+        CSLCount(papszA) != CSLCount(papszB))
+        return FALSE;
+
+    for(i = (bSkipFirst ? 1 : 0); papszA[i] != NULL; i++)
+    {
+        if (strcmp(papszA[i], papszB[i]) != 0)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**********************************************************************
+ *                          ConvertAgain()
+ *
+ * Import the E00 file of a coverage into a temporary directory, and
+ * export the new coverage.  Returns the lines exported, or NULL on error.
+ **********************************************************************/
+static char **ConvertAgain(StressCover *psCover)
+{
+    char    szDir[] = "/tmp/avcstressXXXXXX";
+    char    *pszCoverPath, **papszLines = NULL;
+    const char *pszName;
+
+    if (mkdtemp(szDir) == NULL)
+        return NULL;
+
+    /* The coverage keeps its name, which appears in the names of the
+     * tables that are exported
+     */
+    pszName = strrchr(psCover->pszPath, '/');
+    pszName = (pszName ? pszName+1 : psCover->pszPath);
+    pszCoverPath = CPLStrdup(CPLSPrintf("%s/%s", szDir, pszName));
+
+    if (ImportCover(psCover->pszE00File, pszCoverPath))
+        papszLines = ExportCover(pszCoverPath);
+
+    /* The info directory was made for this coverage only */
+    AVCE00DeleteCoverage(pszCoverPath);
+    unlink(CPLSPrintf("%s/info/arc.dir", szDir));
+    rmdir(CPLSPrintf("%s/info", szDir));
+    rmdir(szDir);
+    CPLFree(pszCoverPath);
+
+    return papszLines;
+}
+
+/**********************************************************************
+ *                          StressWorker()
+ **********************************************************************/
+static void *StressWorker(void *pArg)
+{
+    StressThread *psThread = (StressThread *)pArg;
+    char    **papszLines;
+    int     iRound, iCover;
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+
+    for(iRound=0; iRound < STRESS_ROUNDS; iRound++)
+    {
+        for(iCover=0; iCover < psThread->numCovers; iCover++)
+        {
+            StressCover *psCover = psThread->pasCovers + iCover;
+
+            papszLines = ExportCover(psCover->pszPath);
+            if (!CompareLines(papszLines, psCover->papszE00, FALSE))
+            {
+                fprintf(stderr, "Thread %d: export of %s differs.\n",
+                        psThread->iThread, psCover->pszPath);
+                psThread->numErrors++;
+            }
+            CSLDestroy(papszLines);
+
+            papszLines = ConvertAgain(psCover);
+            if (!CompareLines(papszLines, psCover->papszE00Again, TRUE))
+            {
+                fprintf(stderr, "Thread %d: import of %s differs.\n",
+                        psThread->iThread, psCover->pszE00File);
+                psThread->numErrors++;
+            }
+            CSLDestroy(papszLines);
+
+            /* Errors of this thread must not be seen by the others,
+             * which reset the error state only when they fail
+             */
+            if (CPLGetLastErrorNo() != 0)
+            {
+                fprintf(stderr, "Thread %d: unexpected error: %s\n",
+                        psThread->iThread, CPLGetLastErrorMsg());
+                psThread->numErrors++;
+            }
+
+            if (AVCE00ReadOpen(CPLSPrintf("%s/nonexistent%d",
+                                          psCover->pszPath,
+                                          psThread->iThread)) != NULL ||
+                CPLGetLastErrorNo() == 0)
+            {
+                fprintf(stderr, "Thread %d: missing error.\n",
+                        psThread->iThread);
+                psThread->numErrors++;
+            }
+            CPLErrorReset();
+        }
+    }
+
+    CPLPopErrorHandler();
+    CPLReadLine(NULL);
+
+    return NULL;
+}
+
+/**********************************************************************
+ *                          main()
+ **********************************************************************/
+int main(int argc, char *argv[])
+{
+    StressCover     *pasCovers;
+    StressThread    asThreads[STRESS_THREADS];
+    int             i, numCovers, numErrors = 0;
+    FILE            *fpOut;
+
+    if (argc < 2)
+    {
+        printf("Usage: avcstress <coverage_path> ...\n");
+        return 1;
+    }
+
+    /* The default error handler reports to R, which is not running */
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+
+/*---------------------------------------------------------------------
+ *      Reference results, from the main thread only.
+ *--------------------------------------------------------------------*/
+    numCovers = argc-1;
+    pasCovers = (StressCover*)CPLCalloc(numCovers, sizeof(StressCover));
+
+    for(i=0; i<numCovers; i++)
+    {
+        StressCover *psCover = pasCovers + i;
+
+        psCover->pszPath = argv[i+1];
+        psCover->pszE00File = CPLStrdup(CPLSPrintf("/tmp/avcstress%d_%d.e00",
+                                                   (int)getpid(), i));
+
+        if ((psCover->papszE00 = ExportCover(psCover->pszPath)) == NULL ||
+            (fpOut = VSIFOpen(psCover->pszE00File, "wt")) == NULL)
+        {
+            fprintf(stderr, "Cannot export %s: %s\n", psCover->pszPath,
+                    CPLGetLastErrorMsg());
+            return 1;
+        }
+        CSLPrint(psCover->papszE00, fpOut);
+        VSIFClose(fpOut);
+
+        if ((psCover->papszE00Again = ConvertAgain(psCover)) == NULL)
+        {
+            fprintf(stderr, "Cannot import %s: %s\n", psCover->pszE00File,
+                    CPLGetLastErrorMsg());
+            return 1;
+        }
+    }
+
+/*---------------------------------------------------------------------
+ *      The same, from all the threads at once.
+ *--------------------------------------------------------------------*/
+    for(i=0; i<STRESS_THREADS; i++)
+    {
+        asThreads[i].iThread = i;
+        asThreads[i].pasCovers = pasCovers;
+        asThreads[i].numCovers = numCovers;
+        asThreads[i].numErrors = 0;
+
+        if (pthread_create(&asThreads[i].hThread, NULL, StressWorker,
+                           asThreads+i) != 0)
+        {
+            fprintf(stderr, "Cannot create thread %d.\n", i);
+            return 1;
+        }
+    }
+
+    for(i=0; i<STRESS_THREADS; i++)
+    {
+        pthread_join(asThreads[i].hThread, NULL);
+        numErrors += asThreads[i].numErrors;
+    }
+
+    for(i=0; i<numCovers; i++)
+    {
+        unlink(pasCovers[i].pszE00File);
+        CPLFree(pasCovers[i].pszE00File);
+        CSLDestroy(pasCovers[i].papszE00);
+        CSLDestroy(pasCovers[i].papszE00Again);
+    }
+    CPLFree(pasCovers);
+
+    printf("%d threads, %d rounds, %d coverages: %d errors.\n",
+           STRESS_THREADS, STRESS_ROUNDS, numCovers, numErrors);
+
+    return (numErrors == 0 ? 0 : 1);
+}